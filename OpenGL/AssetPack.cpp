@@ -0,0 +1,272 @@
+#include "AssetPack.h"
+#include "LZ4Block.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+static const char PACK_MAGIC[4] = { 'A', 'P', 'A', 'K' };
+static const uint32_t PACK_VERSION = 1;
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t alignment;
+    uint64_t indexOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+enum PackEntryFlags
+{
+    PACK_ENTRY_LZ4 = 1
+};
+
+struct PackRecord
+{
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t storedSize;    // bytes in the pack
+    uint64_t size;          // bytes after decompression
+    uint32_t flags;
+    uint32_t nameOffset;
+};
+
+static_assert(sizeof(PackHeader) == 40, "pack header layout changed");
+static_assert(sizeof(PackRecord) == 40, "pack record layout changed");
+
+uint64_t HashAssetName(const std::string& name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    size_t start = 0;
+    while (start < name.size() && (name[start] == '\\' || name[start] == '/'))
+        start++;
+    for (size_t i = start; i < name.size(); i++)
+    {
+        char c = name[i];
+        if (c == '\\')
+            c = '/';
+        else if (c >= 'A' && c <= 'Z')
+            c = c - 'A' + 'a';
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool AssetPack::open(const std::string& path)
+{
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(PackHeader))
+    {
+        close();
+        return false;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    size_t indexBytes = (size_t)header.count * sizeof(PackRecord);
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(header.magic)) != 0 || header.version != PACK_VERSION
+        || header.indexOffset + indexBytes > file_.size() || header.namesOffset + header.namesSize > file_.size())
+    {
+        std::cout << "ERROR::ASSETPACK::INVALID_PACK " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // the index is 8 byte aligned by the builder, so the records can be read in place
+    index_ = file_.data() + header.indexOffset;
+    names_ = (const char*)file_.data() + header.namesOffset;
+    namesSize_ = (size_t)header.namesSize;
+    count_ = header.count;
+    return true;
+}
+
+void AssetPack::close()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    cache_.clear();
+    file_.close();
+    index_ = nullptr;
+    names_ = nullptr;
+    namesSize_ = 0;
+    count_ = 0;
+}
+
+static const PackRecord* FindRecord(const unsigned char* index, size_t count, uint64_t hash)
+{
+    const PackRecord* records = (const PackRecord*)index;
+    const PackRecord* end = records + count;
+    const PackRecord* record = std::lower_bound(records, end, hash, [](const PackRecord& r, uint64_t h) { return r.hash < h; });
+    return record != end && record->hash == hash ? record : nullptr;
+}
+
+AssetView AssetPack::get(const std::string& name)
+{
+    AssetView view;
+    uint64_t hash = HashAssetName(name);
+    const PackRecord* record = FindRecord(index_, count_, hash);
+    if (record == nullptr || record->offset + record->storedSize > file_.size())
+        return view;
+
+    const unsigned char* stored = file_.data() + record->offset;
+    if (!(record->flags & PACK_ENTRY_LZ4))
+    {
+        view.data = stored;
+        view.size = (size_t)record->size;
+        return view;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    std::unique_ptr<std::vector<unsigned char>>& cached = cache_[hash];
+    if (!cached)
+    {
+        std::unique_ptr<std::vector<unsigned char>> data(new std::vector<unsigned char>((size_t)record->size));
+        if (!LZ4DecompressBlock(stored, (size_t)record->storedSize, data->data(), data->size()))
+        {
+            std::cout << "ERROR::ASSETPACK::CORRUPT_ENTRY " << name << std::endl;
+            cache_.erase(hash);
+            return view;
+        }
+        cached = std::move(data);
+    }
+    view.data = cached->data();
+    view.size = cached->size();
+    return view;
+}
+
+std::string AssetPack::name(size_t index) const
+{
+    if (index >= count_)
+        return std::string();
+    const PackRecord& record = ((const PackRecord*)index_)[index];
+    if (record.nameOffset >= namesSize_)
+        return std::string();
+    return std::string(names_ + record.nameOffset, strnlen(names_ + record.nameOffset, namesSize_ - record.nameOffset));
+}
+
+static void PadTo(std::ofstream& out, size_t& position, size_t alignment)
+{
+    static const char zeros[64] = {};
+    size_t padding = (alignment - position % alignment) % alignment;
+    while (padding > 0)
+    {
+        size_t chunk = padding < sizeof(zeros) ? padding : sizeof(zeros);
+        out.write(zeros, chunk);
+        position += chunk;
+        padding -= chunk;
+    }
+}
+
+bool BuildAssetPack(const std::string& packPath, const std::vector<AssetPackSource>& sources, size_t alignment, AssetPackBuildStats* stats)
+{
+    if (alignment < 8)
+        alignment = 8;
+
+    // the index is looked up by hash, so two names with the same hash can't both be packed.
+    // checked before anything is written, a failed build leaves no pack behind
+    std::vector<std::pair<uint64_t, const std::string*>> hashes;
+    for (const AssetPackSource& source : sources)
+        hashes.push_back(std::make_pair(HashAssetName(source.name), &source.name));
+    std::sort(hashes.begin(), hashes.end());
+    for (size_t i = 1; i < hashes.size(); i++)
+    {
+        if (hashes[i].first == hashes[i - 1].first)
+        {
+            std::cout << "ERROR::ASSETPACK::NAME_HASH_COLLISION " << *hashes[i].second << " and " << *hashes[i - 1].second << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream out(packPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    // a source that can't be read or a failed write leaves a truncated pack, which is removed
+    auto fail = [&]()
+    {
+        out.close();
+        std::remove(packPath.c_str());
+        return false;
+    };
+
+    // the header is written again at the end, when the offsets are known
+    PackHeader header = {};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    header.version = PACK_VERSION;
+    header.count = (uint32_t)sources.size();
+    header.alignment = (uint32_t)alignment;
+    out.write((const char*)&header, sizeof(header));
+    size_t position = sizeof(header);
+
+    AssetPackBuildStats buildStats = {};
+    std::vector<PackRecord> records;
+    std::string names;
+    for (const AssetPackSource& source : sources)
+    {
+        std::ifstream in(source.path, std::ios::binary);
+        if (!in)
+        {
+            std::cout << "ERROR::ASSETPACK::FILE_NOT_SUCCESFULLY_READ " << source.path << std::endl;
+            return fail();
+        }
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        PackRecord record = {};
+        record.hash = HashAssetName(source.name);
+        record.size = data.size();
+        record.nameOffset = (uint32_t)names.size();
+        names.append(source.name.c_str(), source.name.size() + 1);
+
+        std::vector<unsigned char> compressed;
+        if (source.compress && !data.empty())
+        {
+            compressed.resize(LZ4CompressBound(data.size()));
+            compressed.resize(LZ4CompressBlock(data.data(), data.size(), compressed.data(), compressed.size()));
+            // already compressed formats (jpg, png) barely shrink, a few saved bytes aren't
+            // worth a decompressed copy, so those stay directly mappable
+            if (compressed.size() > data.size() - data.size() / 8)
+                compressed.clear();
+        }
+        const std::vector<unsigned char>& payload = compressed.empty() ? data : compressed;
+        record.flags = compressed.empty() ? 0 : PACK_ENTRY_LZ4;
+        record.storedSize = payload.size();
+
+        PadTo(out, position, alignment);
+        record.offset = position;
+        out.write((const char*)payload.data(), payload.size());
+        position += payload.size();
+        records.push_back(record);
+
+        buildStats.inputBytes += data.size();
+        buildStats.compressedEntries += compressed.empty() ? 0 : 1;
+    }
+
+    std::sort(records.begin(), records.end(), [](const PackRecord& a, const PackRecord& b) { return a.hash < b.hash; });
+
+    PadTo(out, position, 8);
+    header.indexOffset = position;
+    out.write((const char*)records.data(), records.size() * sizeof(PackRecord));
+    position += records.size() * sizeof(PackRecord);
+
+    header.namesOffset = position;
+    header.namesSize = names.size();
+    out.write(names.data(), names.size());
+    position += names.size();
+
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    if (!out.good())
+        return fail();
+
+    buildStats.entries = records.size();
+    buildStats.packBytes = position;
+    if (stats != nullptr)
+        *stats = buildStats;
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+// read-only view of an asset inside a pack. for stored entries it points straight into
+// the file mapping, for LZ4 entries into the pack's decompression cache. valid as long as the pack is open.
+struct AssetView
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    bool valid() const { return data != nullptr; }
+};
+
+// 64 bit FNV-1a of the normalized name: lower case, '/' as separator, no leading separator.
+// "Textures\\container.jpg" and "textures/container.jpg" hash the same.
+uint64_t HashAssetName(const std::string& name);
+
+// single file asset archive
+//
+//     header      magic "APAK", version, entry count, payload alignment, offset of the index
+//     payloads    each entry starts at a multiple of the alignment
+//     index       one record per entry, sorted by name hash for binary search
+//     names       zero terminated original names, for collision checks and listing
+//
+// the whole pack is memory mapped once, so opening an asset is a binary search and
+// no file system call at all.
+class AssetPack
+{
+public:
+    AssetPack() {}
+    explicit AssetPack(const std::string& path) { open(path); }
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    // an invalid view if the pack has no entry with that name
+    AssetView get(const std::string& name);
+
+    size_t size() const { return count_; }
+    std::string name(size_t index) const;
+
+private:
+    MappedFile file_;
+    const unsigned char* index_ = nullptr;
+    const char* names_ = nullptr;
+    size_t namesSize_ = 0;
+    size_t count_ = 0;
+
+    // decompressed LZ4 entries, filled on first access
+    std::mutex cacheMutex_;
+    std::unordered_map<uint64_t, std::unique_ptr<std::vector<unsigned char>>> cache_;
+};
+
+// one file to put into a pack
+struct AssetPackSource
+{
+    std::string name;       // name inside the pack, e.g. "Textures/container.jpg"
+    std::string path;       // file on disk
+    bool compress;          // store LZ4 compressed (kept uncompressed if that does not save anything)
+};
+
+struct AssetPackBuildStats
+{
+    size_t entries;
+    size_t inputBytes;
+    size_t packBytes;
+    size_t compressedEntries;
+};
+
+// builds a pack from loose files, returns false on read/write errors or name hash collisions
+bool BuildAssetPack(const std::string& packPath, const std::vector<AssetPackSource>& sources, size_t alignment, AssetPackBuildStats* stats = nullptr);
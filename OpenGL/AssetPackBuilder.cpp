@@ -0,0 +1,44 @@
+#include <iostream>
+#include "AssetPack.h"
+#include "Utility.h"
+
+// offline tool: packs every file of Shader\ and Textures\ into one asset pack.
+// the names inside the pack are "Shader/<file>" and "Textures/<file>".
+// usage: AssetPackBuilder [root directory] [pack file] [alignment]
+// defaults: <working dir>, <root>\assets.pack, 4096 (page aligned, so mapped payloads start on their own page)
+
+int main(int argc, char** argv)
+{
+    std::string root = argc > 1 ? std::string(argv[1]) + "\\" : GetWorkingDir();
+    std::string packPath = argc > 2 ? argv[2] : root + "assets.pack";
+    size_t alignment = argc > 3 ? (size_t)std::stoul(argv[3]) : 4096;
+
+    std::vector<AssetPackSource> sources;
+    const char* directories[] = { "Shader", "Textures" };
+    for (const char* directory : directories)
+    {
+        for (const std::string& file : ListDirectoryFiles(root + directory))
+        {
+            // generated at runtime, not an asset
+            if (file.size() >= 9 && file.compare(file.size() - 9, 9, ".manifest") == 0)
+                continue;
+
+            AssetPackSource source;
+            source.name = std::string(directory) + "/" + file;
+            source.path = root + directory + "\\" + file;
+            // LZ4 is tried for everything, entries that don't shrink (jpg, png) are stored as they are
+            source.compress = true;
+            sources.push_back(source);
+        }
+    }
+
+    AssetPackBuildStats stats;
+    if (!BuildAssetPack(packPath, sources, alignment, &stats))
+    {
+        std::cout << "Failed to build " << packPath << std::endl;
+        return -1;
+    }
+    std::cout << packPath << ": " << stats.entries << " entries (" << stats.compressedEntries << " LZ4), "
+        << stats.inputBytes << " bytes of input, " << stats.packBytes << " bytes packed" << std::endl;
+    return 0;
+}
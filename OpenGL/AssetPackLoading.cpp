@@ -0,0 +1,105 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "GLExtensions.h"
+#include "AssetPack.h"
+#include "TextureLoad.h"
+
+// cold start benchmark: loads the shaders and textures of the camera sample either from the
+// loose files (GetWorkingDir() + "\\Shader\\..." etc.) or from assets.pack built by AssetPackBuilder.
+//
+// usage: AssetPackLoading loose|pack
+//
+// run every mode in a fresh process and with a cold file cache (after a reboot, or after
+// reading a file larger than the RAM), once with the assets on a spinning disk and once on
+// an NVMe drive. a warm cache measures memcpy speed, not the disk.
+
+int main(int argc, char** argv)
+{
+    bool usePack = argc > 1 && std::string(argv[1]) == "pack";
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    stbi_set_flip_vertically_on_load(true);
+
+    const char* textureNames[] = { "container.jpg", "awesomeface.png", "wall.jpg" };
+    unsigned int textures[3];
+    glGenTextures(3, textures);
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int program;
+    if (usePack)
+    {
+        // one mapping for everything, every asset is a binary search in the index
+        AssetPack pack(GetWorkingDir() + "assets.pack");
+        if (!pack.isOpen())
+        {
+            std::cout << "assets.pack not found, build it with AssetPackBuilder first" << std::endl;
+            return -1;
+        }
+        Shader shader(pack.get("Shader/vertexCoordianteSystem.shader"), pack.get("Shader/fragmentCoordianteSystem.shader"));
+        program = shader.ID;
+        for (int i = 0; i < 3; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            LoadTexture2D(pack.get(std::string("Textures/") + textureNames[i]));
+        }
+    }
+    else
+    {
+        // one open/read per file, like the other samples
+        std::string vertexshaderPath = GetWorkingDir() + "\\Shader\\vertexCoordianteSystem.shader";
+        std::string fragmentshaderPath = GetWorkingDir() + "\\Shader\\fragmentCoordianteSystem.shader";
+        Shader shader(vertexshaderPath.c_str(), fragmentshaderPath.c_str());
+        program = shader.ID;
+        for (int i = 0; i < 3; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            LoadTexture2D(GetWorkingDir() + "\\Textures\\" + textureNames[i]);
+        }
+    }
+    // make sure the driver is done with the uploads before the clock stops
+    glFinish();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << (usePack ? "pack" : "loose files") << ": "
+        << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+    glDeleteProgram(program);
+    glDeleteTextures(3, textures);
+    glfwTerminate();
+    return 0;
+}
@@ -10,6 +10,13 @@
 #include "shaderLoad.h"
 #include "stb_image.h"
 #include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "RadixSort.h"
+#include "GLQueries.h"
+#include "GLStateCache.h"
+#include "ShaderHotReload.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -33,6 +40,14 @@ float fov = 45.0f;
 float deltaTime = 0.0f;	// Time between current frame and last frame
 float lastFrame = 0.0f; // Time of last frame
 
+// M cycles through the render modes
+// ARRAY_ORDER    - draws the cubes in the order of cubePositions
+// FRONT_TO_BACK  - sorts the draws by view depth, so the depth test rejects more hidden fragments early
+// DEPTH_PREPASS  - sorted depth-only pass first, then the shading pass with GL_EQUAL: every pixel is shaded once
+enum RenderMode { RENDER_ARRAY_ORDER, RENDER_FRONT_TO_BACK, RENDER_DEPTH_PREPASS, RENDER_MODE_COUNT };
+const char* renderModeNames[RENDER_MODE_COUNT] = { "array order", "front to back", "depth pre-pass" };
+RenderMode renderMode = RENDER_ARRAY_ORDER;
+
 int main()
 {
 
@@ -72,280 +87,359 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // entry points newer than what glad was generated for, see GLExtensions.h
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // configure global opengl state
     // -----------------------------
-    glEnable(GL_DEPTH_TEST);
-
-    // build and compile our shader program
-    // ------------------------------------
-    std::string vertexshaderPath = GetWorkingDir() + "\\Shader\\vertexCoordianteSystem.shader";
-    std::string fragmentshaderPath = GetWorkingDir() + "\\Shader\\fragmentCoordianteSystem.shader";
-    Shader ourShader(vertexshaderPath.c_str(), fragmentshaderPath.c_str());
-
-
+    // state that is set through GLState() is only sent to GL when it changes, see GLStateCache.h
+    GLState().enable(GL_DEPTH_TEST);
 
-    // set up vertex data (and buffer(s)) and configure vertex attributes
-    // ------------------------------------------------------------------
-    float vertices[] = {
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
-    // world space positions of our cubes
-    glm::vec3 cubePositions[] = {
-        glm::vec3(0.0f,  0.0f,  0.0f),
-        glm::vec3(2.0f,  5.0f, -15.0f),
-        glm::vec3(-1.5f, -2.2f, -2.5f),
-        glm::vec3(-3.8f, -2.0f, -12.3f),
-        glm::vec3(2.4f, -0.4f, -3.5f),
-        glm::vec3(-1.7f,  3.0f, -7.5f),
-        glm::vec3(1.3f, -2.0f, -2.5f),
-        glm::vec3(1.5f,  2.0f, -2.5f),
-        glm::vec3(1.5f,  0.2f, -1.5f),
-        glm::vec3(-1.3f,  1.0f, -1.5f)
-    };
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-
-    // load and create a texture 
-    // -------------------------
-    unsigned int texture1, texture2;
-    // texture 1
-    // ---------
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-
-    std::string texturePath = GetWorkingDir() + "\\Textures\\container.jpg";
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
+    // the GL objects of the sample live in this scope, so they are deleted while the context still exists
     {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
+        // build and compile our shader program
+        // ------------------------------------
+        std::string vertexshaderPath = GetWorkingDir() + "\\Shader\\vertexCoordianteSystem.shader";
+        std::string fragmentshaderPath = GetWorkingDir() + "\\Shader\\fragmentCoordianteSystem.shader";
+        Shader ourShader(vertexshaderPath.c_str(), fragmentshaderPath.c_str());
+        // same vertex shader for the depth pre-pass, so both passes produce the same depths
+        std::string depthOnlyShaderPath = GetWorkingDir() + "\\Shader\\fragmentDepthOnly.shader";
+        Shader depthShader(vertexshaderPath.c_str(), depthOnlyShaderPath.c_str());
+        // saving a shader file recompiles it in the background, see ShaderHotReload.h
+        ShaderReloader shaderReloader(window);
+        shaderReloader.watch(ourShader);
+        shaderReloader.watch(depthShader);
+        // set every draw, so resolved once; a reload resolves them against the new program
+        UniformHandle modelUniform = ourShader.uniform("model"_u);
+        UniformHandle viewUniform = ourShader.uniform("view"_u);
+        UniformHandle projectionUniform = ourShader.uniform("projection"_u);
+        UniformHandle depthModelUniform = depthShader.uniform("model"_u);
+        UniformHandle depthViewUniform = depthShader.uniform("view"_u);
+        UniformHandle depthProjectionUniform = depthShader.uniform("projection"_u);
+
+
+
+        // set up vertex data (and buffer(s)) and configure vertex attributes
+        // ------------------------------------------------------------------
+        float vertices[] = {
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        };
+        // world space positions of our cubes
+        glm::vec3 cubePositions[] = {
+            glm::vec3(0.0f,  0.0f,  0.0f),
+            glm::vec3(2.0f,  5.0f, -15.0f),
+            glm::vec3(-1.5f, -2.2f, -2.5f),
+            glm::vec3(-3.8f, -2.0f, -12.3f),
+            glm::vec3(2.4f, -0.4f, -3.5f),
+            glm::vec3(-1.7f,  3.0f, -7.5f),
+            glm::vec3(1.3f, -2.0f, -2.5f),
+            glm::vec3(1.5f,  2.0f, -2.5f),
+            glm::vec3(1.5f,  0.2f, -1.5f),
+            glm::vec3(-1.3f,  1.0f, -1.5f)
+        };
+
+        unsigned int VBO, VAO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        GLState().bindVertexArray(VAO);
+
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coord attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+
+        // load and create a texture 
+        // -------------------------
+        // sizes and channel counts of all textures come from the manifest (built from the file headers
+        // on the first start), so the storage can be allocated before any image is decoded
+        std::vector<TextureInfo> textureInfos = LoadOrBuildTextureManifest(GetWorkingDir() + "\\Textures\\textures.manifest", GetWorkingDir() + "\\Textures");
+
+        unsigned int texture1, texture2;
+        // texture 1
+        // ---------
+        texture1 = CreateTextureStorage(FindTextureInfo(textureInfos, "container.jpg"));
+        // load image, create texture and generate mipmaps
+        // the image is decoded straight into a pixel buffer object, see TextureLoad.cpp
+        std::string texturePath = GetWorkingDir() + "\\Textures\\container.jpg";
+        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+        LoadTexture2D(texturePath);
+
+
+
+        // texture 2
+        // ---------
+        texture2 = CreateTextureStorage(FindTextureInfo(textureInfos, "awesomeface.png"));
+        // load image, create texture and generate mipmaps
+        std::string texturePath2 = GetWorkingDir() + "\\Textures\\awesomeface.png";
+        // awesomeface.png has transparency and thus an alpha channel, LoadTexture2D picks GL_RGBA from the file
+        LoadTexture2D(texturePath2);
+
+        // wrapping and filtering are not set per texture, one sampler object does it for both units
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+
+        // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+        // -------------------------------------------------------------------------------------------
+        ourShader.use();
+        ourShader.setInt("texture1", 0);
+        ourShader.setInt("texture2", 1);
 
 
+        /*
+            openGL does all the work for us
+            so we dont need this vetorcs
+            it is just an example to create
+            a lookAt matrix by hand
+        */
 
-    // texture 2
-    // ---------
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    std::string texturePath2 = GetWorkingDir() + "\\Textures\\awesomeface.png";
+        //// camera with positive z-axis is going through the screen
+        //// -------------------------------------------------------
+        //glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
 
-    data = stbi_load(texturePath2.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
+        //// camera direction - first we let point thhe camera to the center of the scene
+        ////--------------------------------------------------------
+        //glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
+        //glm::vec3 cameraDirection = glm::normalize(cameraPos - cameraTarget);
 
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-    // -------------------------------------------------------------------------------------------
-    ourShader.use();
-    ourShader.setInt("texture1", 0);
-    ourShader.setInt("texture2", 1);
 
+        //glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+        //glm::vec3 cameraRight = glm::normalize(glm::cross(up, cameraDirection));
 
-    /*
-        openGL does all the work for us
-        so we dont need this vetorcs
-        it is just an example to create
-        a lookAt matrix by hand
-    */
+        //glm::vec3 cameraUp = glm::cross(cameraDirection, cameraRight);
 
-    //// camera with positive z-axis is going through the screen
-    //// -------------------------------------------------------
-    //glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
 
-    //// camera direction - first we let point thhe camera to the center of the scene
-    ////--------------------------------------------------------
-    //glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-    //glm::vec3 cameraDirection = glm::normalize(cameraPos - cameraTarget);
+        // with camera vector we now able to create an LookAt matrix
+        // the LookAt matrix as our viewmatrix transform all world coordinates
+        // to the view space we defined -> so the lookMatrix creates a
+        // viewmatrix that looks at a given target
+        // --------------------------------------------------------
 
+        // openGL does this work for us. We only need to create a
+        // camera position
+        // target position
+        // and a up-vector
 
-    //glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
-    //glm::vec3 cameraRight = glm::normalize(glm::cross(up, cameraDirection));
+        //glm::mat4 viewMatrix;
+        //viewMatrix = glm::lookAt(
+        //    glm::vec3(0.0f, 0.0f, 3.0f),
+        //    glm::vec3(0.0f, 0.0f, 0.0f),
+        //    glm::vec3(0.0f, 1.0f, 0.0f));
 
-    //glm::vec3 cameraUp = glm::cross(cameraDirection, cameraRight);
+        // we implemented this matrix in our render loop
 
 
-    // with camera vector we now able to create an LookAt matrix
-    // the LookAt matrix as our viewmatrix transform all world coordinates
-    // to the view space we defined -> so the lookMatrix creates a
-    // viewmatrix that looks at a given target
-    // --------------------------------------------------------
+        // draw order and the shaded fragments counter
+        // -------------------------------------------
+        RadixSorter<uint32_t> drawSorter;
+        std::vector<uint32_t> drawKeys;
+        std::vector<uint32_t> drawOrder;
+        SamplesPassedCounter shadedSamples;
+        GLuint64 shadedSamplesSum = 0;
+        int shadedSamplesFrames = 0;
+        RenderMode reportedMode = renderMode;
+        int stateStatsFrames = 0;
 
-    // openGL does this work for us. We only need to create a
-    // camera position
-    // target position
-    // and a up-vector
 
-    //glm::mat4 viewMatrix;
-    //viewMatrix = glm::lookAt(
-    //    glm::vec3(0.0f, 0.0f, 3.0f),
-    //    glm::vec3(0.0f, 0.0f, 0.0f),
-    //    glm::vec3(0.0f, 1.0f, 0.0f));
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
 
-    // we implemented this matrix in our render loop
+            // shaders that finished recompiling take over between two frames
+            shaderReloader.update();
 
+            // input
+            // -----
+            processInput(window);
 
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            //glClear(GL_COLOR_BUFFER_BIT);
 
+            // bind textures on corresponding texture units
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture1);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, texture2);
 
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
-    {
-        // per-frame time logic
-        // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        //glClear(GL_COLOR_BUFFER_BIT);
-
-        // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
-        // activate shader
-        ourShader.use();
+            // activate shader
+            ourShader.use();
 
-        //// camera/view transformation
-        glm::mat4 viewMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        //float radius = 10.0f;
-        //float camX = sin(glfwGetTime()) * radius;
-        //float camZ = cos(glfwGetTime()) * radius;
-        //viewMatrix = glm::lookAt(glm::vec3(camX, 0.0f, camZ), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            //// camera/view transformation
+            glm::mat4 viewMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
+            //float radius = 10.0f;
+            //float camX = sin(glfwGetTime()) * radius;
+            //float camZ = cos(glfwGetTime()) * radius;
+            //viewMatrix = glm::lookAt(glm::vec3(camX, 0.0f, camZ), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
-        viewMatrix = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+            viewMatrix = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 
         
-        ourShader.setMat4("view", viewMatrix);
-
-        // make sure to initialize matrix to identity matrix first
-        glm::mat4 projection = glm::mat4(1.0f);
-        projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        ourShader.setMat4("projection", projection);
-
-        // render boxes
-        glBindVertexArray(VAO);
-        // we draw 10 times one cube with different model matrix 
-        for (unsigned int i = 0; i < 10; i++)
-        {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            float angle = 20.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            ourShader.setMat4("model", model);
-
-            //render container
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            ourShader.set(viewUniform, viewMatrix);
+
+            // make sure to initialize matrix to identity matrix first
+            glm::mat4 projection = glm::mat4(1.0f);
+            projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            ourShader.set(projectionUniform, projection);
+
+            // draw order: array order, or front to back by the view depth of the cube centers
+            drawKeys.clear();
+            drawOrder.clear();
+            for (unsigned int i = 0; i < 10; i++)
+            {
+                float viewDepth = -(viewMatrix * glm::vec4(cubePositions[i], 1.0f)).z;
+                drawKeys.push_back(FloatToRadixKey(viewDepth));
+                drawOrder.push_back(i);
+            }
+            if (renderMode != RENDER_ARRAY_ORDER)
+                drawSorter.sort(drawKeys, drawOrder);
+
+            // render boxes
+            GLState().bindVertexArray(VAO);
+            if (renderMode == RENDER_DEPTH_PREPASS)
+            {
+                // depth only: no color writes and a fragment shader that does nothing
+                GLState().colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                depthShader.use();
+                depthShader.set(depthViewUniform, viewMatrix);
+                depthShader.set(depthProjectionUniform, projection);
+                for (unsigned int i : drawOrder)
+                {
+                    glm::mat4 model = glm::mat4(1.0f);
+                    model = glm::translate(model, cubePositions[i]);
+                    float angle = 20.0f * i;
+                    model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                    depthShader.set(depthModelUniform, model);
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                }
+                GLState().colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                // the depth buffer is final now, only the nearest fragment of every pixel passes
+                GLState().depthFunc(GL_EQUAL);
+                GLState().depthMask(GL_FALSE);
+                ourShader.use();
+            }
+
+            // a mode switch restarts the average, the queries still in flight measured the old mode
+            if (renderMode != reportedMode)
+            {
+                shadedSamples.discard();
+                shadedSamplesSum = 0;
+                shadedSamplesFrames = 0;
+                reportedMode = renderMode;
+            }
+            shadedSamples.begin();
+            // we draw 10 times one cube with different model matrix 
+            for (unsigned int i : drawOrder)
+            {
+                // calculate the model matrix for each object and pass it to shader before drawing
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::translate(model, cubePositions[i]);
+                float angle = 20.0f * i;
+                model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                ourShader.set(modelUniform, model);
+
+                //render container
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            shadedSamples.end();
+
+            // the default depth state for the next frame, elided if it never changed
+            GLState().depthFunc(GL_LESS);
+            GLState().depthMask(GL_TRUE);
+
+            // fragments shaded by the textured shader, averaged over 100 frames. the results arrive
+            // a few frames late and sometimes several at once, every one is counted once
+            GLuint64 samples;
+            while (shadedSamples.next(samples))
+            {
+                shadedSamplesSum += samples;
+                if (++shadedSamplesFrames == 100)
+                {
+                    std::cout << renderModeNames[renderMode] << ": " << shadedSamplesSum / shadedSamplesFrames
+                        << " fragments shaded per frame" << std::endl;
+                    shadedSamplesSum = 0;
+                    shadedSamplesFrames = 0;
+                }
+            }
+
+            // issued and elided state calls, every 100 frames while the statistics are on (T)
+            GLState().endFrame();
+            if (GLState().statistics() && ++stateStatsFrames >= 100)
+            {
+                const GLStateStats& stats = GLState().lastFrame();
+                std::cout << "state calls per frame: " << stats.issued << " issued, "
+                    << stats.elided << " elided" << std::endl;
+                stateStatsFrames = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteBuffers(1, &EBO);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -361,6 +455,25 @@ void processInput(GLFWwindow* window)
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    // switch on the key press only, not every frame the key is down
+    static bool mWasPressed = false;
+    bool mPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+    if (mPressed && !mWasPressed)
+    {
+        renderMode = (RenderMode)((renderMode + 1) % RENDER_MODE_COUNT);
+        std::cout << "render mode: " << renderModeNames[renderMode] << std::endl;
+    }
+    mWasPressed = mPressed;
+
+    static bool tWasPressed = false;
+    bool tPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+    if (tPressed && !tWasPressed)
+    {
+        GLState().setStatistics(!GLState().statistics());
+        std::cout << "state statistics: " << (GLState().statistics() ? "on" : "off") << std::endl;
+    }
+    tWasPressed = tPressed;
+
     float cameraSpeed = 2.5f * deltaTime;
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -380,7 +493,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    GLState().viewport(0, 0, width, height);
 }
 
 
@@ -10,6 +10,7 @@
 #include "shaderLoad.h"
 #include "stb_image.h"
 #include "Utility.h"
+#include "GLStateCache.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -181,10 +182,8 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT);
 
         // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture1);
+        GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, texture2);
 
         // activate shader
         ourShader.use();
@@ -230,7 +229,7 @@ int main()
         ourShader.setMat4("projection", projection);
 
         // render container
-        glBindVertexArray(VAO);
+        GLState().bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -0,0 +1,52 @@
+#include "CpuFeatures.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+static bool OsSavesYmmRegisters()
+{
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    return osxsave && avx && (_xgetbv(0) & 6) == 6;
+}
+#endif
+
+bool CpuHasAVX2()
+{
+    static const bool hasAVX2 = [] {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7 || !OsSavesYmmRegisters())
+            return false;
+        __cpuid(info, 1);
+        bool fma = (info[2] & (1 << 12)) != 0;
+        __cpuidex(info, 7, 0);
+        return fma && (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }();
+    return hasAVX2;
+}
+
+bool CpuHasF16C()
+{
+    static const bool hasF16C = [] {
+#if defined(_MSC_VER)
+        if (!OsSavesYmmRegisters())
+            return false;
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 29)) != 0;
+#else
+        return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+    }();
+    return hasF16C;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// runtime checks for the instruction set extensions used by the SIMD paths, every such path
+// has a plain C++ fallback. functions using the extensions are marked with the matching
+// *_TARGET macro: GCC/Clang only emit those instructions in functions marked that way,
+// MSVC accepts the intrinsics anywhere.
+#if defined(_MSC_VER)
+#define AVX2_TARGET
+#define F16C_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#define F16C_TARGET __attribute__((target("avx,f16c")))
+#endif
+
+// AVX2 and FMA, with the OS saving the ymm registers
+bool CpuHasAVX2();
+
+// the float/half conversion instructions (vcvtps2ph), which work on ymm registers as well
+bool CpuHasF16C();
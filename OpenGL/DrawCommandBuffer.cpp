@@ -0,0 +1,125 @@
+#include "DrawCommandBuffer.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+
+void DrawCommandRecorder::draw(uint64_t key, const DrawCommand& command)
+{
+    keys_.push_back(key);
+    commands_.push_back(command);
+}
+
+void DrawCommandRecorder::draw(uint64_t key, const DrawCommand& command, const glm::mat4& model)
+{
+    keys_.push_back(key);
+    commands_.push_back(command);
+    commands_.back().model = (uint32_t)models_.size();
+    models_.push_back(model);
+}
+
+void DrawCommandRecorder::clear()
+{
+    keys_.clear();
+    commands_.clear();
+    models_.clear();
+}
+
+DrawCommandBuffer::DrawCommandBuffer(int recorders)
+    : recorders_(recorders)
+{
+}
+
+static void ApplyPassState(const DrawPassState& state)
+{
+    GLStateCache& gl = GLState();
+    gl.depthFunc(state.depthFunc);
+    gl.depthMask(state.depthMask);
+    gl.colorMask(state.colorMask, state.colorMask, state.colorMask, state.colorMask);
+    if (state.blend)
+    {
+        gl.enable(GL_BLEND);
+        gl.blendFunc(state.blendSrc, state.blendDst);
+    }
+    else
+    {
+        gl.disable(GL_BLEND);
+    }
+}
+
+void DrawCommandBuffer::submit()
+{
+    auto sortStart = std::chrono::steady_clock::now();
+    stats_ = DrawSubmitStats();
+
+    // gather the keys of all recorders, the value remembers where the command lives
+    keys_.clear();
+    order_.clear();
+    for (size_t r = 0; r < recorders_.size(); r++)
+    {
+        const DrawCommandRecorder& recorder = recorders_[r];
+        keys_.insert(keys_.end(), recorder.keys_.begin(), recorder.keys_.end());
+        for (size_t i = 0; i < recorder.keys_.size(); i++)
+            order_.push_back((uint32_t)(r << 24) | (uint32_t)i);
+    }
+    sorter_.sort(keys_, order_);
+
+    auto executeStart = std::chrono::steady_clock::now();
+    stats_.sortMs = std::chrono::duration<double, std::milli>(executeStart - sortStart).count();
+
+    // the previous command, to count the state switches. the GL calls themselves go through
+    // the state cache, which drops the ones that don't change anything
+    GLStateCache& gl = GLState();
+    const DrawCommand* previous = nullptr;
+    unsigned int pass = DRAW_PASS_COUNT;
+    for (size_t i = 0; i < order_.size(); i++)
+    {
+        const DrawCommandRecorder& recorder = recorders_[order_[i] >> 24];
+        const DrawCommand& command = recorder.commands_[order_[i] & 0xFFFFFF];
+
+        unsigned int commandPass = DrawKeyPass(keys_[i]);
+        if (commandPass != pass)
+        {
+            pass = commandPass;
+            ApplyPassState(passes_[pass]);
+            stats_.passChanges++;
+        }
+        if (!previous || previous->program != command.program)
+        {
+            gl.useProgram(command.program);
+            stats_.programChanges++;
+        }
+        if (!previous || previous->vertexArray != command.vertexArray)
+        {
+            gl.bindVertexArray(command.vertexArray);
+            stats_.vertexArrayChanges++;
+        }
+        for (int unit = 0; unit < DRAW_TEXTURE_UNITS; unit++)
+        {
+            GLuint texture = command.textures[unit];
+            if (texture != 0 && (!previous || previous->textures[unit] != texture))
+            {
+                gl.bindTexture(GL_TEXTURE0 + unit, GL_TEXTURE_2D, texture);
+                stats_.textureChanges++;
+            }
+        }
+
+        if (command.modelLocation >= 0)
+            glUniformMatrix4fv(command.modelLocation, 1, GL_FALSE, glm::value_ptr(recorder.models_[command.model]));
+        if (command.indexType == 0)
+            glDrawArrays(command.mode, command.first, command.count);
+        else
+            glDrawElements(command.mode, command.count, command.indexType, (void*)(intptr_t)command.first);
+
+        previous = &command;
+    }
+    stats_.commands = (unsigned int)order_.size();
+
+    if (pass != DRAW_PASS_COUNT)
+        ApplyPassState(DrawPassState());
+    for (DrawCommandRecorder& recorder : recorders_)
+        recorder.clear();
+
+    stats_.executeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - executeStart).count();
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "RadixSort.h"
+
+// deferred draw calls: game code records small POD commands with a 64 bit sort key instead of
+// calling GL, one DrawCommandRecorder per recording thread or job, so recording needs no locks.
+// the thread that owns the context submits the buffer: the keys of all recorders are radix sorted
+// and the commands executed in key order, which puts draws with the same state next to each other.
+//
+// key layout, most significant bits first:
+//   MakeDrawKey             pass 4 | program 12 | material 16 | depth 32   (opaque, front to back)
+//   MakeDrawKeyBackToFront  pass 4 | depth 32 | program 12 | material 16   (blended, back to front)
+// program and material are small ids picked by the caller, only their order matters.
+
+const int DRAW_PASS_COUNT = 16;
+const int DRAW_TEXTURE_UNITS = 2;
+
+inline uint64_t MakeDrawKey(unsigned int pass, unsigned int program, unsigned int material, float viewDepth)
+{
+    return ((uint64_t)(pass & 0xF) << 60) | ((uint64_t)(program & 0xFFF) << 48)
+        | ((uint64_t)(material & 0xFFFF) << 32) | FloatToRadixKey(viewDepth);
+}
+
+inline uint64_t MakeDrawKeyBackToFront(unsigned int pass, unsigned int program, unsigned int material, float viewDepth)
+{
+    return ((uint64_t)(pass & 0xF) << 60) | ((uint64_t)(~FloatToRadixKey(viewDepth)) << 28)
+        | ((uint64_t)(program & 0xFFF) << 16) | (material & 0xFFFF);
+}
+
+inline unsigned int DrawKeyPass(uint64_t key)
+{
+    return (unsigned int)(key >> 60);
+}
+
+// one draw call with everything it needs bound. the GL names are used as they are,
+// a zero texture leaves the unit alone.
+struct DrawCommand
+{
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    GLuint textures[DRAW_TEXTURE_UNITS] = {};  // bound to GL_TEXTURE0 + i as GL_TEXTURE_2D
+    GLenum mode = GL_TRIANGLES;
+    GLenum indexType = 0;       // 0 draws with glDrawArrays, otherwise the type of the element buffer
+    GLint first = 0;            // first vertex, or the byte offset into the element buffer
+    GLsizei count = 0;
+    GLint modelLocation = -1;   // location of the mat4 model uniform, -1 if the draw doesn't set one
+    uint32_t model = 0;         // index of the model matrix in the recorder, set by draw()
+};
+
+// render state of a pass, applied when the first command of the pass is executed
+struct DrawPassState
+{
+    GLenum depthFunc = GL_LESS;
+    GLboolean depthMask = GL_TRUE;
+    GLboolean colorMask = GL_TRUE;
+    bool blend = false;
+    GLenum blendSrc = GL_SRC_ALPHA;
+    GLenum blendDst = GL_ONE_MINUS_SRC_ALPHA;
+};
+
+// what the last submit did, the changes count the state switches between consecutive commands
+struct DrawSubmitStats
+{
+    unsigned int commands = 0;
+    unsigned int passChanges = 0;
+    unsigned int programChanges = 0;
+    unsigned int vertexArrayChanges = 0;
+    unsigned int textureChanges = 0;
+    double sortMs = 0.0;
+    double executeMs = 0.0;
+};
+
+// linear command storage of one recording thread. the vectors keep their capacity,
+// after the first frames recording doesn't allocate anymore.
+class DrawCommandRecorder
+{
+public:
+    void draw(uint64_t key, const DrawCommand& command);
+    // the model matrix is copied into the recorder, command.model is set to its index
+    void draw(uint64_t key, const DrawCommand& command, const glm::mat4& model);
+
+    void clear();
+    size_t size() const { return commands_.size(); }
+
+private:
+    friend class DrawCommandBuffer;
+
+    std::vector<uint64_t> keys_;
+    std::vector<DrawCommand> commands_;
+    std::vector<glm::mat4> models_;
+};
+
+class DrawCommandBuffer
+{
+public:
+    // up to 256 recorders with up to 2^24 commands each
+    explicit DrawCommandBuffer(int recorders = 1);
+
+    int recorderCount() const { return (int)recorders_.size(); }
+    DrawCommandRecorder& recorder(int index) { return recorders_[index]; }
+
+    void setPassState(unsigned int pass, const DrawPassState& state) { passes_[pass] = state; }
+
+    // sorts and executes the commands of all recorders through GLState() and clears the recorders.
+    // must be called on the thread that owns the context, with no recorder in use.
+    // afterwards depth, color and blend state are back at their DrawPassState defaults.
+    void submit();
+
+    const DrawSubmitStats& stats() const { return stats_; }
+
+private:
+    std::vector<DrawCommandRecorder> recorders_;
+    DrawPassState passes_[DRAW_PASS_COUNT];
+
+    RadixSorter<uint64_t> sorter_;
+    std::vector<uint64_t> keys_;
+    std::vector<uint32_t> order_;   // recorder << 24 | command index
+    DrawSubmitStats stats_;
+};
@@ -0,0 +1,374 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "JobPool.h"
+#include "DrawCommandBuffer.h"
+
+// many cubes with two programs and three materials, assigned so that consecutive cubes never share
+// their state. immediate mode issues the GL calls in array order, the command buffer records the
+// cubes on all threads of a job pool, sorts them by program, material and depth and submits them.
+// B toggles the mode, the timings and state changes are printed every 100 frames.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int GRID_SIZE = 20;
+const float GRID_SPACING = 2.5f;
+const int PROGRAM_COUNT = 2;
+const int MATERIAL_COUNT = 3;
+
+glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, GRID_SIZE * GRID_SPACING * 0.5f + 5.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = SCR_WIDTH / 2.0;
+float lastY = SCR_HEIGHT / 2.0;
+float fov = 45.0f;
+
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+bool useCommandBuffer = true;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // configure global opengl state
+    // -----------------------------
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        // the cube of the camera sample, with two programs that only differ in their fragment shader file
+        // -----------------------------------------------------------------------------------------------
+        Scene scene = CreateCubeScene();
+        std::string otherFragmentShaderPath = GetWorkingDir() + "\\Shader\\fragmentTexture.shader";
+        Shader shaders[PROGRAM_COUNT] = {
+            Shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str()),
+            Shader(scene.vertexShaderPath.c_str(), otherFragmentShaderPath.c_str())
+        };
+        GLint modelLocations[PROGRAM_COUNT];
+        for (int p = 0; p < PROGRAM_COUNT; p++)
+        {
+            shaders[p].use();
+            shaders[p].setInt("ourTexture", 0);
+            shaders[p].setInt("texture2", 1);
+            modelLocations[p] = glGetUniformLocation(shaders[p].ID, "model");
+        }
+
+        unsigned int VBO, VAO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        GLState().bindVertexArray(VAO);
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, scene.vertices.size() * sizeof(float), scene.vertices.data(), GL_STATIC_DRAW);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coord attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // three textures, each material is a pair of them
+        stbi_set_flip_vertically_on_load(true);
+        std::string texturePaths[3] = {
+            scene.texturePaths[0], scene.texturePaths[1], GetWorkingDir() + "\\Textures\\wall.jpg"
+        };
+        unsigned int textures[3];
+        for (int i = 0; i < 3; i++)
+            textures[i] = LoadImmutableTexture2D(texturePaths[i]);
+        // the materials only switch textures, all of them are filtered by the same sampler object
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        const unsigned int materials[MATERIAL_COUNT][2] = {
+            { textures[0], textures[1] }, { textures[2], textures[1] }, { textures[0], textures[2] }
+        };
+
+        // the cubes, program and material change from one cube to the next
+        // -----------------------------------------------------------------
+        std::vector<glm::mat4> cubeModels;
+        std::vector<glm::vec3> cubePositions;
+        for (int x = 0; x < GRID_SIZE; x++)
+            for (int y = 0; y < GRID_SIZE; y++)
+                for (int z = 0; z < GRID_SIZE; z++)
+                {
+                    glm::vec3 position = (glm::vec3((float)x, (float)y, (float)z) - glm::vec3(GRID_SIZE * 0.5f)) * GRID_SPACING;
+                    cubePositions.push_back(position);
+                    cubeModels.push_back(glm::translate(glm::mat4(1.0f), position));
+                }
+        const int cubeCount = (int)cubeModels.size();
+        auto cubeProgram = [](int i) { return i % PROGRAM_COUNT; };
+        auto cubeMaterial = [](int i) { return (i / PROGRAM_COUNT) % MATERIAL_COUNT; };
+
+        // one recorder per thread of the pool, every thread records one slice of the cubes
+        JobPool pool;
+        DrawCommandBuffer commands(pool.threadCount());
+        std::cout << "recording on " << pool.threadCount() << " threads" << std::endl;
+
+        double frameTimeSum = 0.0;
+        double recordTimeSum = 0.0;
+        double sortTimeSum = 0.0;
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            processInput(window);
+
+            glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+            glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            for (int p = 0; p < PROGRAM_COUNT; p++)
+            {
+                shaders[p].use();
+                shaders[p].setMat4("view", view);
+                shaders[p].setMat4("projection", projection);
+            }
+
+            if (useCommandBuffer)
+            {
+                auto recordStart = std::chrono::steady_clock::now();
+                int slices = commands.recorderCount();
+                pool.parallelFor(slices, [&](int slice) {
+                    DrawCommandRecorder& recorder = commands.recorder(slice);
+                    int begin = cubeCount * slice / slices;
+                    int end = cubeCount * (slice + 1) / slices;
+                    for (int i = begin; i < end; i++)
+                    {
+                        int program = cubeProgram(i);
+                        int material = cubeMaterial(i);
+                        DrawCommand command;
+                        command.program = shaders[program].ID;
+                        command.vertexArray = VAO;
+                        command.textures[0] = materials[material][0];
+                        command.textures[1] = materials[material][1];
+                        command.count = 36;
+                        command.modelLocation = modelLocations[program];
+                        float viewDepth = -(view * glm::vec4(cubePositions[i], 1.0f)).z;
+                        recorder.draw(MakeDrawKey(0, program, material, viewDepth), command, cubeModels[i]);
+                    }
+                });
+                recordTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+                commands.submit();
+                sortTimeSum += commands.stats().sortMs;
+            }
+            else
+            {
+                // what the other samples do: every draw binds everything it needs right away
+                for (int i = 0; i < cubeCount; i++)
+                {
+                    int program = cubeProgram(i);
+                    const unsigned int* material = materials[cubeMaterial(i)];
+                    glUseProgram(shaders[program].ID);
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, material[0]);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, material[1]);
+                    glBindVertexArray(VAO);
+                    glUniformMatrix4fv(modelLocations[program], 1, GL_FALSE, glm::value_ptr(cubeModels[i]));
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                }
+                // the raw calls above bypassed the state cache
+                GLState().invalidate();
+            }
+            glFinish();
+
+            frameTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (++framesMeasured == 100)
+            {
+                std::cout << (useCommandBuffer ? "command buffer" : "immediate") << ": " << frameTimeSum / framesMeasured
+                    << " ms per frame for " << cubeCount << " cubes" << std::endl;
+                if (useCommandBuffer)
+                {
+                    const DrawSubmitStats& stats = commands.stats();
+                    std::cout << "  record " << recordTimeSum / framesMeasured << " ms, sort " << sortTimeSum / framesMeasured
+                        << " ms, last submit: " << stats.programChanges << " program, " << stats.vertexArrayChanges
+                        << " vertex array and " << stats.textureChanges << " texture changes" << std::endl;
+                }
+                frameTimeSum = 0.0;
+                recordTimeSum = 0.0;
+                sortTimeSum = 0.0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(3, textures);
+        for (int p = 0; p < PROGRAM_COUNT; p++)
+            GLState().deleteProgram(shaders[p].ID);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool bWasPressed = false;
+    bool bPressed = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+    if (bPressed && !bWasPressed)
+        useCommandBuffer = !useCommandBuffer;
+    bWasPressed = bPressed;
+
+    float cameraSpeed = 5.0f * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // to avoid a camera jump causing by mouse focus on game start
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+    lastX = xpos;
+    lastY = ypos;
+
+    const float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
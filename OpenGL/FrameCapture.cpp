@@ -0,0 +1,173 @@
+#include "FrameCapture.h"
+#include "PngWriter.h"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(_MSC_VER)
+static FILE* OpenPipe(const std::string& command) { return _popen(command.c_str(), "wb"); }
+static void ClosePipe(FILE* pipe) { _pclose(pipe); }
+#else
+static FILE* OpenPipe(const std::string& command) { return popen(command.c_str(), "w"); }
+static void ClosePipe(FILE* pipe) { pclose(pipe); }
+#endif
+
+static unsigned char ClampByte(float value)
+{
+    return (unsigned char)(value < 0.0f ? 0.0f : value > 255.0f ? 255.0f : value + 0.5f);
+}
+
+// bottom up RGBA to top down I420: the full size Y plane, then U and V at half the size in both
+// directions, every chroma sample made from the average of its 2x2 pixels
+static void RgbaToI420(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& out)
+{
+    int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    out.resize((size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight);
+    unsigned char* yPlane = out.data();
+    unsigned char* uPlane = yPlane + (size_t)width * height;
+    unsigned char* vPlane = uPlane + (size_t)chromaWidth * chromaHeight;
+
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = pixels + (size_t)(height - 1 - y) * width * 4;
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned char* p = row + x * 4;
+            yPlane[(size_t)y * width + x] = ClampByte(16.0f + 0.1826f * p[0] + 0.6142f * p[1] + 0.0620f * p[2]);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; cy++)
+    {
+        for (int cx = 0; cx < chromaWidth; cx++)
+        {
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            int count = 0;
+            for (int y = cy * 2; y < cy * 2 + 2 && y < height; y++)
+            {
+                for (int x = cx * 2; x < cx * 2 + 2 && x < width; x++)
+                {
+                    const unsigned char* p = pixels + ((size_t)(height - 1 - y) * width + x) * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            uPlane[(size_t)cy * chromaWidth + cx] = ClampByte(128.0f - 0.1006f * r - 0.3386f * g + 0.4392f * b);
+            vPlane[(size_t)cy * chromaWidth + cx] = ClampByte(128.0f + 0.4392f * r - 0.3989f * g - 0.0403f * b);
+        }
+    }
+}
+
+FrameCapture::FrameCapture(CaptureFormat format, const std::string& target, int width, int height, size_t maxQueued)
+    : format_(format), target_(target), width_(width), height_(height), maxQueued_(maxQueued < 1 ? 1 : maxQueued),
+      ok_(true), written_(0)
+{
+    if (format_ == CAPTURE_YUV)
+    {
+        pipe_ = OpenPipe(target_);
+        if (pipe_ == nullptr)
+        {
+            std::cout << "ERROR::CAPTURE::PIPE_FAILED " << target_ << std::endl;
+            ok_ = false;
+        }
+    }
+    writer_ = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeWriter_.notify_one();
+    writer_.join();
+    if (pipe_ != nullptr)
+        ClosePipe(pipe_);
+}
+
+void FrameCapture::submit(const unsigned char* pixels)
+{
+    size_t size = (size_t)width_ * height_ * 4;
+    std::vector<unsigned char> frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.size() >= maxQueued_)
+        {
+            waits_++;
+            spaceAvailable_.wait(lock, [this] { return queue_.size() < maxQueued_; });
+        }
+        if (!unused_.empty())
+        {
+            frame.swap(unused_.back());
+            unused_.pop_back();
+        }
+    }
+    // the copy happens outside the lock, the writer keeps going meanwhile
+    frame.resize(size);
+    memcpy(frame.data(), pixels, size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(frame));
+    }
+    wakeWriter_.notify_one();
+}
+
+void FrameCapture::writerLoop()
+{
+    unsigned long long index = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        wakeWriter_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        // the queue is written out before stopping
+        if (queue_.empty())
+            return;
+        std::vector<unsigned char> frame = std::move(queue_.front());
+        queue_.pop_front();
+        spaceAvailable_.notify_one();
+
+        lock.unlock();
+        if (ok_ && write(frame, index))
+            written_++;
+        index++;
+        lock.lock();
+        unused_.push_back(std::move(frame));
+    }
+}
+
+bool FrameCapture::write(const std::vector<unsigned char>& frame, unsigned long long index)
+{
+    if (format_ == CAPTURE_PNG)
+    {
+        // the alpha of the framebuffer is whatever the shaders wrote, the files are RGB
+        size_t pixelCount = (size_t)width_ * height_;
+        converted_.resize(pixelCount * 3);
+        for (size_t i = 0; i < pixelCount; i++)
+            memcpy(&converted_[i * 3], &frame[i * 4], 3);
+
+        char name[32];
+        snprintf(name, sizeof(name), "/frame_%05llu.png", index);
+        std::string path = target_ + name;
+        if (!WritePng(path, converted_.data(), width_, height_, (size_t)width_ * 3, 3, true))
+        {
+            std::cout << "ERROR::CAPTURE::WRITE_FAILED " << path << std::endl;
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    RgbaToI420(frame.data(), width_, height_, converted_);
+    if (fwrite(converted_.data(), 1, converted_.size(), pipe_) != converted_.size())
+    {
+        std::cout << "ERROR::CAPTURE::WRITE_FAILED " << target_ << std::endl;
+        ok_ = false;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureFormat
+{
+    CAPTURE_PNG,    // one file per frame, <directory>/frame_00000.png, ... (see PngWriter.h)
+    CAPTURE_YUV     // raw I420 frames (BT.709, limited range) into the standard input of a command
+};
+
+// writes a sequence of frames on a worker thread, so encoding and the disk or the pipe never
+// hold up rendering. fed by FrameReadback, for example:
+//
+//     FrameCapture capture(CAPTURE_YUV, "ffmpeg -f rawvideo -pix_fmt yuv420p -s 800x600 -r 60 -i - out.mp4", 800, 600);
+//     FrameReadback readback(800, 600, [&](const unsigned char* pixels, unsigned long long) { capture.submit(pixels); });
+//
+// the queue holds at most maxQueued frames; when the writer falls that far behind submit()
+// waits for it instead of dropping frames, those waits are counted.
+class FrameCapture
+{
+public:
+    // target is the directory for CAPTURE_PNG, it has to exist, and the command for CAPTURE_YUV
+    FrameCapture(CaptureFormat format, const std::string& target, int width, int height, size_t maxQueued = 8);
+
+    // writes the frames still queued, then closes the pipe
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // false once the pipe could not be started or writing failed, the error is printed
+    bool ok() const { return ok_; }
+
+    // queues a copy of a frame: width x height RGBA8 pixels, rows bottom up as glReadPixels returns them
+    void submit(const unsigned char* pixels);
+
+    unsigned long long written() const { return written_; }
+    unsigned long long waits() const { return waits_; }
+
+private:
+    void writerLoop();
+    bool write(const std::vector<unsigned char>& frame, unsigned long long index);
+
+    CaptureFormat format_;
+    std::string target_;
+    int width_;
+    int height_;
+    size_t maxQueued_;
+    FILE* pipe_ = nullptr;
+    std::atomic<bool> ok_;
+    std::atomic<unsigned long long> written_;
+    unsigned long long waits_ = 0;
+
+    // the writer's scratch buffer for the converted frame
+    std::vector<unsigned char> converted_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeWriter_;
+    std::condition_variable spaceAvailable_;
+    std::deque<std::vector<unsigned char>> queue_;
+    std::vector<std::vector<unsigned char>> unused_;    // written frames, reused by submit()
+    bool stopping_ = false;
+    std::thread writer_;
+};
@@ -0,0 +1,95 @@
+#include "FrameReadback.h"
+#include "GLStateCache.h"
+
+#include <cstddef>
+
+FrameReadback::FrameReadback(int width, int height, const Consumer& consume)
+    : width_(width), height_(height), consume_(consume)
+{
+    glGenBuffers(RING_SIZE, buffers_);
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[i]);
+        // written by the GPU, read by the CPU
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+        fences_[i] = 0;
+        frames_[i] = 0;
+    }
+    GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FrameReadback::~FrameReadback()
+{
+    // frames still in flight are dropped, finish() hands them out
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        if (fences_[i] != 0)
+            glDeleteSync(fences_[i]);
+    }
+    GLState().deleteBuffers(RING_SIZE, buffers_);
+}
+
+void FrameReadback::read()
+{
+    if (pending_ == RING_SIZE)
+    {
+        stalls_++;
+        collect(true);
+    }
+
+    GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[next_]);
+    // rows of RGBA8 are 4 byte aligned, the default GL_PACK_ALIGNMENT. the last parameter is an
+    // offset into the bound pixel pack buffer, so the call returns without waiting for the frame
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences_[next_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frames_[next_] = frame_++;
+    next_ = (next_ + 1) % RING_SIZE;
+    pending_++;
+}
+
+void FrameReadback::poll()
+{
+    while (collect(false))
+    {
+    }
+}
+
+void FrameReadback::finish()
+{
+    while (collect(true))
+    {
+    }
+}
+
+bool FrameReadback::collect(bool wait)
+{
+    if (pending_ == 0)
+        return false;
+    int oldest = (next_ - pending_ + RING_SIZE) % RING_SIZE;
+
+    // the flush bit makes sure the fence gets to the GPU at all, otherwise the wait could last forever
+    GLuint64 timeout = wait ? 1000000000ull : 0;
+    GLenum status = glClientWaitSync(fences_[oldest], GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    while (wait && status == GL_TIMEOUT_EXPIRED)
+        status = glClientWaitSync(fences_[oldest], 0, timeout);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    glDeleteSync(fences_[oldest]);
+    fences_[oldest] = 0;
+    pending_--;
+    // a failed wait (e.g. a lost context) drops the frame
+    if (status == GL_WAIT_FAILED)
+        return true;
+
+    GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[oldest]);
+    GLsizeiptr size = (GLsizeiptr)width_ * height_ * 4;
+    const unsigned char* pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (pixels != NULL)
+    {
+        consume_(pixels, frames_[oldest]);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    GLState().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <functional>
+
+// asynchronous readback of rendered frames as RGBA8.
+//
+// read() starts glReadPixels into the next pixel pack buffer of a ring and puts a fence behind
+// it, poll() hands the frames whose fence has signaled to the consumer, a frame or two later.
+// so reading back never waits for the GPU to catch up. only when every buffer of the ring is
+// still in flight read() waits for the oldest one, those waits are counted in stalls().
+class FrameReadback
+{
+public:
+    // pixels are the rows of the frame bottom up, width * 4 bytes each, and only valid during
+    // the call: the buffer is unmapped and reused right after. frame counts the read() calls.
+    typedef std::function<void(const unsigned char* pixels, unsigned long long frame)> Consumer;
+
+    FrameReadback(int width, int height, const Consumer& consume);
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    // reads the lower left width x height pixels of the bound GL_READ_FRAMEBUFFER, which is not
+    // bound here: RenderTarget::resolve and blitToDefault leave the resolved color bound for it.
+    // binds the pixel pack buffers through GLState() and leaves 0 bound.
+    void read();
+
+    // hands out the finished frames in the order they were read
+    void poll();
+
+    // waits for and hands out all frames still in flight, e.g. at the end of a capture
+    void finish();
+
+    int pending() const { return pending_; }
+    unsigned long long stalls() const { return stalls_; }
+
+private:
+    static const int RING_SIZE = 3;
+
+    // hands out the oldest frame in flight, with wait it blocks until its fence has signaled
+    bool collect(bool wait);
+
+    int width_;
+    int height_;
+    Consumer consume_;
+    unsigned int buffers_[RING_SIZE];
+    GLsync fences_[RING_SIZE];
+    unsigned long long frames_[RING_SIZE];
+    int next_ = 0;
+    int pending_ = 0;
+    unsigned long long frame_ = 0;
+    unsigned long long stalls_ = 0;
+};
@@ -0,0 +1,150 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+static int contextMajor = 0;
+static int contextMinor = 0;
+
+#ifndef GL_VERSION_4_2
+PFNGLTEXSTORAGE2DPROC glad_glTexStorage2D = NULL;
+#endif
+#ifndef GL_VERSION_4_3
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+#endif
+#ifndef GL_VERSION_4_5
+PFNGLCREATEBUFFERSPROC glad_glCreateBuffers = NULL;
+PFNGLNAMEDBUFFERSTORAGEPROC glad_glNamedBufferStorage = NULL;
+PFNGLNAMEDBUFFERSUBDATAPROC glad_glNamedBufferSubData = NULL;
+PFNGLCREATETEXTURESPROC glad_glCreateTextures = NULL;
+PFNGLTEXTURESTORAGE2DPROC glad_glTextureStorage2D = NULL;
+PFNGLTEXTURESUBIMAGE2DPROC glad_glTextureSubImage2D = NULL;
+PFNGLTEXTUREPARAMETERIPROC glad_glTextureParameteri = NULL;
+PFNGLGENERATETEXTUREMIPMAPPROC glad_glGenerateTextureMipmap = NULL;
+PFNGLCREATEVERTEXARRAYSPROC glad_glCreateVertexArrays = NULL;
+PFNGLVERTEXARRAYVERTEXBUFFERPROC glad_glVertexArrayVertexBuffer = NULL;
+PFNGLVERTEXARRAYELEMENTBUFFERPROC glad_glVertexArrayElementBuffer = NULL;
+PFNGLENABLEVERTEXARRAYATTRIBPROC glad_glEnableVertexArrayAttrib = NULL;
+PFNGLVERTEXARRAYATTRIBFORMATPROC glad_glVertexArrayAttribFormat = NULL;
+PFNGLVERTEXARRAYATTRIBIFORMATPROC glad_glVertexArrayAttribIFormat = NULL;
+PFNGLVERTEXARRAYATTRIBBINDINGPROC glad_glVertexArrayAttribBinding = NULL;
+#endif
+#ifndef GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
+#endif
+static bool multiDrawIndirect = false;
+static bool pipelineStatistics = false;
+static bool directStateAccess = false;
+static float maxAnisotropy = 1.0f;
+
+void LoadGLExtensions(GLADloadproc load)
+{
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+
+#ifndef GL_VERSION_4_2
+    // the extension exports the same entry point name as core 4.2
+    if (HasGLVersion(4, 2) || HasGLExtension("GL_ARB_texture_storage"))
+        glad_glTexStorage2D = (PFNGLTEXSTORAGE2DPROC)load("glTexStorage2D");
+#endif
+
+    // a non-zero baseInstance in the indirect commands needs 4.2 or GL_ARB_base_instance
+    multiDrawIndirect = HasGLVersion(4, 3) || (HasGLExtension("GL_ARB_multi_draw_indirect")
+        && (HasGLVersion(4, 2) || HasGLExtension("GL_ARB_base_instance")));
+#ifndef GL_VERSION_4_3
+    if (multiDrawIndirect)
+        glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+#endif
+
+    pipelineStatistics = HasGLVersion(4, 6) || HasGLExtension("GL_ARB_pipeline_statistics_query");
+
+    // the extension only brings the named versions of what the context already has, the storage
+    // and vertex attrib binding calls need 4.4 behind them
+    directStateAccess = HasGLVersion(4, 5) || (HasGLVersion(4, 4) && HasGLExtension("GL_ARB_direct_state_access"));
+#ifndef GL_VERSION_4_5
+    if (directStateAccess)
+    {
+        glad_glCreateBuffers = (PFNGLCREATEBUFFERSPROC)load("glCreateBuffers");
+        glad_glNamedBufferStorage = (PFNGLNAMEDBUFFERSTORAGEPROC)load("glNamedBufferStorage");
+        glad_glNamedBufferSubData = (PFNGLNAMEDBUFFERSUBDATAPROC)load("glNamedBufferSubData");
+        glad_glCreateTextures = (PFNGLCREATETEXTURESPROC)load("glCreateTextures");
+        glad_glTextureStorage2D = (PFNGLTEXTURESTORAGE2DPROC)load("glTextureStorage2D");
+        glad_glTextureSubImage2D = (PFNGLTEXTURESUBIMAGE2DPROC)load("glTextureSubImage2D");
+        glad_glTextureParameteri = (PFNGLTEXTUREPARAMETERIPROC)load("glTextureParameteri");
+        glad_glGenerateTextureMipmap = (PFNGLGENERATETEXTUREMIPMAPPROC)load("glGenerateTextureMipmap");
+        glad_glCreateVertexArrays = (PFNGLCREATEVERTEXARRAYSPROC)load("glCreateVertexArrays");
+        glad_glVertexArrayVertexBuffer = (PFNGLVERTEXARRAYVERTEXBUFFERPROC)load("glVertexArrayVertexBuffer");
+        glad_glVertexArrayElementBuffer = (PFNGLVERTEXARRAYELEMENTBUFFERPROC)load("glVertexArrayElementBuffer");
+        glad_glEnableVertexArrayAttrib = (PFNGLENABLEVERTEXARRAYATTRIBPROC)load("glEnableVertexArrayAttrib");
+        glad_glVertexArrayAttribFormat = (PFNGLVERTEXARRAYATTRIBFORMATPROC)load("glVertexArrayAttribFormat");
+        glad_glVertexArrayAttribIFormat = (PFNGLVERTEXARRAYATTRIBIFORMATPROC)load("glVertexArrayAttribIFormat");
+        glad_glVertexArrayAttribBinding = (PFNGLVERTEXARRAYATTRIBBINDINGPROC)load("glVertexArrayAttribBinding");
+    }
+#endif
+
+    // checked once here, GLResources asks for every object it creates
+    directStateAccess = directStateAccess && glCreateBuffers != NULL && glNamedBufferStorage != NULL && glNamedBufferSubData != NULL
+        && glCreateTextures != NULL && glTextureStorage2D != NULL && glTextureSubImage2D != NULL
+        && glTextureParameteri != NULL && glGenerateTextureMipmap != NULL && glCreateVertexArrays != NULL
+        && glVertexArrayVertexBuffer != NULL && glVertexArrayElementBuffer != NULL && glEnableVertexArrayAttrib != NULL
+        && glVertexArrayAttribFormat != NULL && glVertexArrayAttribIFormat != NULL && glVertexArrayAttribBinding != NULL;
+
+    maxAnisotropy = 1.0f;
+    if (HasGLVersion(4, 6) || HasGLExtension("GL_ARB_texture_filter_anisotropic") || HasGLExtension("GL_EXT_texture_filter_anisotropic"))
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+
+#ifndef GL_KHR_parallel_shader_compile
+    // the ARB version names its entry point glMaxShaderCompilerThreadsARB
+    if (HasGLExtension("GL_KHR_parallel_shader_compile"))
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    else if (HasGLExtension("GL_ARB_parallel_shader_compile"))
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+#endif
+}
+
+bool HasGLVersion(int major, int minor)
+{
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+bool HasGLExtension(const char* name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension != NULL && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool HasTextureStorage()
+{
+    return glTexStorage2D != NULL;
+}
+
+bool HasMultiDrawIndirect()
+{
+    return multiDrawIndirect && glMultiDrawElementsIndirect != NULL;
+}
+
+bool HasDirectStateAccess()
+{
+    return directStateAccess;
+}
+
+float MaxTextureAnisotropy()
+{
+    return maxAnisotropy;
+}
+
+bool HasPipelineStatistics()
+{
+    return pipelineStatistics;
+}
+
+bool HasParallelShaderCompile()
+{
+    return glMaxShaderCompilerThreadsKHR != NULL;
+}
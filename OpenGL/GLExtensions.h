@@ -0,0 +1,140 @@
+#pragma once
+#include <glad/glad.h>
+
+// glad in this project is generated for OpenGL 4.0 core without any extensions,
+// but the samples only ask for a 3.3 context. entry points of newer versions are
+// loaded here at runtime, and are only valid if the context actually supports them.
+// if glad ever gets regenerated for a newer version, the glad declarations win and
+// the blocks below switch themselves off.
+
+// call once after gladLoadGLLoader, e.g. LoadGLExtensions((GLADloadproc)glfwGetProcAddress)
+void LoadGLExtensions(GLADloadproc load);
+
+// version of the current context, valid after LoadGLExtensions
+bool HasGLVersion(int major, int minor);
+// true if the current context lists the extension, e.g. "GL_ARB_texture_storage"
+bool HasGLExtension(const char* name);
+
+// OpenGL 4.2 / GL_ARB_texture_storage
+// -----------------------------------
+#ifndef GL_VERSION_4_2
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+extern PFNGLTEXSTORAGE2DPROC glad_glTexStorage2D;
+#define glTexStorage2D glad_glTexStorage2D
+#endif
+
+// true if glTexStorage2D can be called
+bool HasTextureStorage();
+
+// OpenGL 4.3 / GL_ARB_multi_draw_indirect
+// ---------------------------------------
+#ifndef GL_VERSION_4_3
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+#endif
+
+// true if glMultiDrawElementsIndirect can be called and honors the baseInstance of the commands
+bool HasMultiDrawIndirect();
+
+// OpenGL 4.4 / GL_ARB_buffer_storage
+// ----------------------------------
+// only the flags, glNamedBufferStorage below is the only storage call used
+#ifndef GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// OpenGL 4.5 / GL_ARB_direct_state_access
+// ---------------------------------------
+// the part GLResources uses: objects are created and edited by name, without binding them
+#ifndef GL_VERSION_4_5
+typedef void (APIENTRYP PFNGLCREATEBUFFERSPROC)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP PFNGLNAMEDBUFFERSTORAGEPROC)(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLNAMEDBUFFERSUBDATAPROC)(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+typedef void (APIENTRYP PFNGLCREATETEXTURESPROC)(GLenum target, GLsizei n, GLuint* textures);
+typedef void (APIENTRYP PFNGLTEXTURESTORAGE2DPROC)(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP PFNGLTEXTURESUBIMAGE2DPROC)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+typedef void (APIENTRYP PFNGLTEXTUREPARAMETERIPROC)(GLuint texture, GLenum pname, GLint param);
+typedef void (APIENTRYP PFNGLGENERATETEXTUREMIPMAPPROC)(GLuint texture);
+typedef void (APIENTRYP PFNGLCREATEVERTEXARRAYSPROC)(GLsizei n, GLuint* arrays);
+typedef void (APIENTRYP PFNGLVERTEXARRAYVERTEXBUFFERPROC)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP PFNGLVERTEXARRAYELEMENTBUFFERPROC)(GLuint vaobj, GLuint buffer);
+typedef void (APIENTRYP PFNGLENABLEVERTEXARRAYATTRIBPROC)(GLuint vaobj, GLuint index);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBFORMATPROC)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBIFORMATPROC)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBBINDINGPROC)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+extern PFNGLCREATEBUFFERSPROC glad_glCreateBuffers;
+extern PFNGLNAMEDBUFFERSTORAGEPROC glad_glNamedBufferStorage;
+extern PFNGLNAMEDBUFFERSUBDATAPROC glad_glNamedBufferSubData;
+extern PFNGLCREATETEXTURESPROC glad_glCreateTextures;
+extern PFNGLTEXTURESTORAGE2DPROC glad_glTextureStorage2D;
+extern PFNGLTEXTURESUBIMAGE2DPROC glad_glTextureSubImage2D;
+extern PFNGLTEXTUREPARAMETERIPROC glad_glTextureParameteri;
+extern PFNGLGENERATETEXTUREMIPMAPPROC glad_glGenerateTextureMipmap;
+extern PFNGLCREATEVERTEXARRAYSPROC glad_glCreateVertexArrays;
+extern PFNGLVERTEXARRAYVERTEXBUFFERPROC glad_glVertexArrayVertexBuffer;
+extern PFNGLVERTEXARRAYELEMENTBUFFERPROC glad_glVertexArrayElementBuffer;
+extern PFNGLENABLEVERTEXARRAYATTRIBPROC glad_glEnableVertexArrayAttrib;
+extern PFNGLVERTEXARRAYATTRIBFORMATPROC glad_glVertexArrayAttribFormat;
+extern PFNGLVERTEXARRAYATTRIBIFORMATPROC glad_glVertexArrayAttribIFormat;
+extern PFNGLVERTEXARRAYATTRIBBINDINGPROC glad_glVertexArrayAttribBinding;
+#define glCreateBuffers glad_glCreateBuffers
+#define glNamedBufferStorage glad_glNamedBufferStorage
+#define glNamedBufferSubData glad_glNamedBufferSubData
+#define glCreateTextures glad_glCreateTextures
+#define glTextureStorage2D glad_glTextureStorage2D
+#define glTextureSubImage2D glad_glTextureSubImage2D
+#define glTextureParameteri glad_glTextureParameteri
+#define glGenerateTextureMipmap glad_glGenerateTextureMipmap
+#define glCreateVertexArrays glad_glCreateVertexArrays
+#define glVertexArrayVertexBuffer glad_glVertexArrayVertexBuffer
+#define glVertexArrayElementBuffer glad_glVertexArrayElementBuffer
+#define glEnableVertexArrayAttrib glad_glEnableVertexArrayAttrib
+#define glVertexArrayAttribFormat glad_glVertexArrayAttribFormat
+#define glVertexArrayAttribIFormat glad_glVertexArrayAttribIFormat
+#define glVertexArrayAttribBinding glad_glVertexArrayAttribBinding
+#endif
+
+// true if all of the entry points above can be called
+bool HasDirectStateAccess();
+
+// OpenGL 4.6 / GL_ARB_pipeline_statistics_query
+// ---------------------------------------------
+// no new entry points, only query targets for glBeginQuery
+#ifndef GL_VERSION_4_6
+#define GL_VERTICES_SUBMITTED 0x82EE
+#define GL_PRIMITIVES_SUBMITTED 0x82EF
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#endif
+
+// true if the pipeline statistics targets above can be used with glBeginQuery
+bool HasPipelineStatistics();
+
+// OpenGL 4.6 / GL_ARB_texture_filter_anisotropic / GL_EXT_texture_filter_anisotropic
+// ---------------------------------------------------------------------------------
+// no entry points, a texture and sampler parameter. the EXT enums have the same values
+#ifndef GL_VERSION_4_6
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+// largest GL_TEXTURE_MAX_ANISOTROPY the context takes, 1 if it can't filter anisotropically
+float MaxTextureAnisotropy();
+
+// GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile
+// ---------------------------------------------------------------
+// not part of any core version yet, both extensions share the enums
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR glad_glMaxShaderCompilerThreadsKHR
+#endif
+
+// true if GL_COMPLETION_STATUS_KHR can be queried and glMaxShaderCompilerThreadsKHR called
+bool HasParallelShaderCompile();
@@ -0,0 +1,79 @@
+#include "GLQueries.h"
+
+QueryCounter::QueryCounter(GLenum target)
+    : target_(target)
+{
+    glGenQueries(QUERY_COUNT, queries_);
+}
+
+QueryCounter::~QueryCounter()
+{
+    glDeleteQueries(QUERY_COUNT, queries_);
+}
+
+void QueryCounter::begin()
+{
+    collect(pending_ == QUERY_COUNT);
+    // the query slot is reused, so its unread result goes
+    if (pending_ + unread_ == QUERY_COUNT)
+        unread_--;
+    glBeginQuery(target_, queries_[next_]);
+}
+
+void QueryCounter::end()
+{
+    glEndQuery(target_);
+    next_ = (next_ + 1) % QUERY_COUNT;
+    pending_++;
+}
+
+bool QueryCounter::latest(GLuint64& count)
+{
+    collect(false);
+    count = latest_;
+    return hasLatest_;
+}
+
+bool QueryCounter::next(GLuint64& count)
+{
+    collect(false);
+    if (unread_ == 0)
+        return false;
+    count = results_[(next_ - pending_ - unread_ + 2 * QUERY_COUNT) % QUERY_COUNT];
+    unread_--;
+    return true;
+}
+
+void QueryCounter::discard()
+{
+    discarded_ = pending_;
+    unread_ = 0;
+}
+
+void QueryCounter::collect(bool wait)
+{
+    while (pending_ > 0)
+    {
+        int index = (next_ - pending_ + QUERY_COUNT) % QUERY_COUNT;
+        unsigned int query = queries_[index];
+        if (!wait)
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                return;
+        }
+        // with wait only the oldest query is waited for, the rest is picked up if it is there
+        wait = false;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &results_[index]);
+        pending_--;
+        if (discarded_ > 0)
+        {
+            discarded_--;
+            continue;
+        }
+        latest_ = results_[index];
+        hasLatest_ = true;
+        unread_++;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <glad/glad.h>
+
+// counts with a query of the given target between begin() and end(), e.g. GL_PRIMITIVES_GENERATED.
+// the results are picked up when the GPU has them, a few frames later, so reading the counter
+// never stalls the pipeline. only when all QUERY_COUNT queries are still in flight begin() waits
+// for the oldest one.
+class QueryCounter
+{
+public:
+    explicit QueryCounter(GLenum target);
+    ~QueryCounter();
+
+    QueryCounter(const QueryCounter&) = delete;
+    QueryCounter& operator=(const QueryCounter&) = delete;
+
+    void begin();
+    void end();
+
+    // the newest result available, false as long as there is none yet
+    bool latest(GLuint64& count);
+    // the oldest result that next() didn't return yet, so every result is seen exactly once.
+    // false if no new result arrived. only the last QUERY_COUNT results are kept.
+    bool next(GLuint64& count);
+    // the queries in flight and the results not taken yet are dropped, e.g. after the
+    // measured setup changed
+    void discard();
+
+private:
+    static const int QUERY_COUNT = 4;
+
+    // reads the finished queries in the order they were issued, wait blocks for the oldest one
+    void collect(bool wait);
+
+    GLenum target_;
+    unsigned int queries_[QUERY_COUNT];
+    GLuint64 results_[QUERY_COUNT];     // of the query with the same index
+    int next_ = 0;
+    int pending_ = 0;                   // issued, the result is not read back yet
+    int unread_ = 0;                    // read back, not taken by next() yet; right before the pending ones
+    int discarded_ = 0;                 // of the pending queries, the oldest ones that are thrown away
+    GLuint64 latest_ = 0;
+    bool hasLatest_ = false;
+};
+
+// counts the samples passing the depth test with GL_SAMPLES_PASSED.
+// without multisampling that is the number of fragments that got shaded.
+class SamplesPassedCounter : public QueryCounter
+{
+public:
+    SamplesPassedCounter() : QueryCounter(GL_SAMPLES_PASSED) {}
+};
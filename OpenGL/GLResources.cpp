@@ -0,0 +1,239 @@
+#include "GLResources.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+
+#include <cstddef>
+
+static GLResourceStats stats;
+static bool directStateAccessEnabled = true;
+
+// pixel format and type glTexImage2D accepts for an empty level of the internal format
+static void TransferFormat(GLenum internalFormat, GLenum& format, GLenum& type)
+{
+    type = GL_UNSIGNED_BYTE;
+    switch (internalFormat)
+    {
+    case GL_R8: case GL_R16: case GL_R16F: case GL_R32F:
+        format = GL_RED; break;
+    case GL_RG8: case GL_RG16: case GL_RG16F: case GL_RG32F:
+        format = GL_RG; break;
+    case GL_RGB8: case GL_RGB16: case GL_RGB16F: case GL_RGB32F: case GL_SRGB8: case GL_R11F_G11F_B10F: case GL_RGB9_E5:
+        format = GL_RGB; break;
+    case GL_R8UI: case GL_R16UI: case GL_R32UI:
+        format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+    case GL_R8I: case GL_R16I: case GL_R32I:
+        format = GL_RED_INTEGER; type = GL_INT; break;
+    case GL_DEPTH_COMPONENT16: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32: case GL_DEPTH_COMPONENT32F:
+        format = GL_DEPTH_COMPONENT; type = GL_FLOAT; break;
+    case GL_DEPTH24_STENCIL8: case GL_DEPTH32F_STENCIL8:
+        format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+    default:
+        format = GL_RGBA; break;
+    }
+}
+
+// 3.3 path: textures are edited on unit 0, a known unit keeps the state cache exact
+static void BindForEditing(GLuint texture)
+{
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture);
+}
+
+// the binds of the 3.3 path go through the state cache, only the ones it let through are counted
+static unsigned int CacheCallsSince(unsigned int issued)
+{
+    return GLState().issuedCalls() - issued;
+}
+
+const GLResourceStats& ResourceStats()
+{
+    return stats;
+}
+
+void ResetResourceStats()
+{
+    stats = GLResourceStats();
+}
+
+bool UsesDirectStateAccess()
+{
+    return directStateAccessEnabled && HasDirectStateAccess();
+}
+
+void SetDirectStateAccess(bool enabled)
+{
+    directStateAccessEnabled = enabled;
+}
+
+GLuint CreateBuffer(GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    GLuint buffer;
+    stats.objects++;
+    if (UsesDirectStateAccess())
+    {
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, size, data, flags);
+        stats.calls += 2;
+        return buffer;
+    }
+    // GL_COPY_WRITE_BUFFER is bound by nothing else, so the vertex and element buffer bindings stay as they are
+    unsigned int issued = GLState().issuedCalls();
+    glGenBuffers(1, &buffer);
+    GLState().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, data, (flags & GL_DYNAMIC_STORAGE_BIT) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+    stats.calls += 2 + CacheCallsSince(issued);
+    return buffer;
+}
+
+void UpdateBuffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    if (UsesDirectStateAccess())
+    {
+        glNamedBufferSubData(buffer, offset, size, data);
+        stats.calls += 1;
+        return;
+    }
+    unsigned int issued = GLState().issuedCalls();
+    GLState().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    stats.calls += 1 + CacheCallsSince(issued);
+}
+
+GLuint CreateTexture2D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    GLuint texture;
+    stats.objects++;
+    if (UsesDirectStateAccess())
+    {
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, levels, internalFormat, width, height);
+        stats.calls += 2;
+        return texture;
+    }
+
+    unsigned int issued = GLState().issuedCalls();
+    glGenTextures(1, &texture);
+    BindForEditing(texture);
+    stats.calls += 1 + CacheCallsSince(issued);
+    if (HasTextureStorage())
+    {
+        glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+        stats.calls += 1;
+        return texture;
+    }
+    // 3.3: allocate every level by hand, without pixels
+    GLenum format, type;
+    TransferFormat(internalFormat, format, type);
+    for (GLsizei level = 0; level < levels; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, NULL);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    stats.calls += levels + 1;
+    return texture;
+}
+
+void UploadTexture2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    if (UsesDirectStateAccess())
+    {
+        glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        stats.calls += 1;
+        return;
+    }
+    unsigned int issued = GLState().issuedCalls();
+    BindForEditing(texture);
+    glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels);
+    stats.calls += 1 + CacheCallsSince(issued);
+}
+
+void SetTextureParameter(GLuint texture, GLenum name, GLint value)
+{
+    if (UsesDirectStateAccess())
+    {
+        glTextureParameteri(texture, name, value);
+        stats.calls += 1;
+        return;
+    }
+    unsigned int issued = GLState().issuedCalls();
+    BindForEditing(texture);
+    glTexParameteri(GL_TEXTURE_2D, name, value);
+    stats.calls += 1 + CacheCallsSince(issued);
+}
+
+void GenerateMipmaps(GLuint texture)
+{
+    if (UsesDirectStateAccess())
+    {
+        glGenerateTextureMipmap(texture);
+        stats.calls += 1;
+        return;
+    }
+    unsigned int issued = GLState().issuedCalls();
+    BindForEditing(texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    stats.calls += 1 + CacheCallsSince(issued);
+}
+
+GLuint CreateVertexArray()
+{
+    GLuint vao;
+    stats.objects++;
+    stats.calls += 1;
+    if (UsesDirectStateAccess())
+        glCreateVertexArrays(1, &vao);
+    else
+        glGenVertexArrays(1, &vao);
+    return vao;
+}
+
+void SetVertexBuffer(GLuint vao, GLuint binding, GLuint buffer, GLsizei stride, const VertexAttribFormat* attributes, int count)
+{
+    if (UsesDirectStateAccess())
+    {
+        glVertexArrayVertexBuffer(vao, binding, buffer, 0, stride);
+        for (int i = 0; i < count; i++)
+        {
+            const VertexAttribFormat& attribute = attributes[i];
+            if (attribute.integer)
+                glVertexArrayAttribIFormat(vao, attribute.location, attribute.components, attribute.type, attribute.offset);
+            else
+                glVertexArrayAttribFormat(vao, attribute.location, attribute.components, attribute.type, attribute.normalized, attribute.offset);
+            glVertexArrayAttribBinding(vao, attribute.location, binding);
+            glEnableVertexArrayAttrib(vao, attribute.location);
+        }
+        stats.calls += 1 + 3 * count;
+        return;
+    }
+
+    // the pointers take the buffer bound to GL_ARRAY_BUFFER when they are set
+    unsigned int issued = GLState().issuedCalls();
+    GLState().bindVertexArray(vao);
+    GLState().bindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (int i = 0; i < count; i++)
+    {
+        const VertexAttribFormat& attribute = attributes[i];
+        if (attribute.integer)
+            glVertexAttribIPointer(attribute.location, attribute.components, attribute.type, stride, (void*)(size_t)attribute.offset);
+        else
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized, stride, (void*)(size_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+    stats.calls += 2 * count + CacheCallsSince(issued);
+}
+
+void SetElementBuffer(GLuint vao, GLuint buffer)
+{
+    if (UsesDirectStateAccess())
+    {
+        glVertexArrayElementBuffer(vao, buffer);
+        stats.calls += 1;
+        return;
+    }
+    // the element buffer binding is vertex array state
+    unsigned int issued = GLState().issuedCalls();
+    GLState().bindVertexArray(vao);
+    GLState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    stats.calls += CacheCallsSince(issued);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <glad/glad.h>
+
+// creates and edits buffers, textures and vertex arrays. where the context has direct state
+// access (HasDirectStateAccess) the objects are edited by name and no binding changes; on the
+// 3.3 contexts the samples ask for they are bound through GLState() and edited the old way.
+// objects of both paths are the same GL objects, they are used and deleted like any other
+// (through GLState(), see GLStateCache.h). needs LoadGLExtensions first.
+
+// GL calls made by the functions below since the last ResetResourceStats(). only calls that
+// reach the driver are counted: binds through the state cache count when the cache issues them
+// (GLState().issuedCalls()), not when it drops them as redundant.
+struct GLResourceStats
+{
+    unsigned int calls = 0;
+    unsigned int objects = 0;
+};
+
+const GLResourceStats& ResourceStats();
+void ResetResourceStats();
+
+// true if the functions below take the DSA path
+bool UsesDirectStateAccess();
+// false forces the 3.3 path even where DSA is available, to compare the two
+void SetDirectStateAccess(bool enabled);
+
+// buffers
+// -------
+// flags as for glBufferStorage: GL_DYNAMIC_STORAGE_BIT for buffers UpdateBuffer writes to later,
+// GL_MAP_WRITE_BIT / GL_MAP_READ_BIT for glMapBufferRange. the DSA path allocates immutable
+// storage, the 3.3 path glBufferData with GL_DYNAMIC_DRAW or GL_STATIC_DRAW after the flags.
+// data may be NULL.
+GLuint CreateBuffer(GLsizeiptr size, const void* data, GLbitfield flags = 0);
+void UpdateBuffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+// 2D textures
+// -----------
+// storage for levels mip levels, immutable where the context has it (DSA or glTexStorage2D),
+// otherwise every level is allocated with glTexImage2D and GL_TEXTURE_MAX_LEVEL is set
+GLuint CreateTexture2D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+// glTexSubImage2D, pixels is an offset if a pixel unpack buffer is bound
+void UploadTexture2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+void SetTextureParameter(GLuint texture, GLenum name, GLint value);
+void GenerateMipmaps(GLuint texture);
+
+// vertex arrays
+// -------------
+struct VertexAttribFormat
+{
+    GLuint location;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    bool integer;           // glVertexAttribIFormat / glVertexAttribIPointer
+    GLuint offset;          // within a vertex, below GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET (2047 at least)
+};
+
+GLuint CreateVertexArray();
+// feeds the attributes from one buffer. binding is the buffer binding index of the DSA path,
+// every buffer of a vertex array needs its own; the 3.3 path has no use for it.
+void SetVertexBuffer(GLuint vao, GLuint binding, GLuint buffer, GLsizei stride, const VertexAttribFormat* attributes, int count);
+void SetElementBuffer(GLuint vao, GLuint buffer);
@@ -0,0 +1,330 @@
+#include "GLStateCache.h"
+
+GLStateCache::GLStateCache()
+{
+    invalidate();
+}
+
+int GLStateCache::bufferSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_ELEMENT_ARRAY_BUFFER: return 1;
+    case GL_UNIFORM_BUFFER: return 2;
+    case GL_PIXEL_PACK_BUFFER: return 3;
+    case GL_PIXEL_UNPACK_BUFFER: return 4;
+    case GL_DRAW_INDIRECT_BUFFER: return 5;
+    default: return -1;
+    }
+}
+
+int GLStateCache::textureSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_CUBE_MAP: return 1;
+    default: return -1;
+    }
+}
+
+int GLStateCache::capabilitySlot(GLenum cap)
+{
+    switch (cap)
+    {
+    case GL_DEPTH_TEST: return 0;
+    case GL_BLEND: return 1;
+    case GL_CULL_FACE: return 2;
+    case GL_SCISSOR_TEST: return 3;
+    case GL_STENCIL_TEST: return 4;
+    default: return -1;
+    }
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+    if (changed(program_ != program))
+    {
+        glUseProgram(program);
+        program_ = program;
+    }
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+    if (changed(vertexArray_ != vao))
+    {
+        glBindVertexArray(vao);
+        vertexArray_ = vao;
+        buffers_[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = bufferSlot(target);
+    if (slot < 0)
+    {
+        changed(true);
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (changed(buffers_[slot] != buffer))
+    {
+        glBindBuffer(target, buffer);
+        buffers_[slot] = buffer;
+    }
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    changed(true);
+    glBindBufferBase(target, index, buffer);
+    int slot = bufferSlot(target);
+    if (slot >= 0)
+        buffers_[slot] = buffer;
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    if (changed(activeUnit_ != unit))
+    {
+        glActiveTexture(unit);
+        activeUnit_ = unit;
+    }
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    int slot = textureSlot(target);
+    GLuint unit = activeUnit_ - GL_TEXTURE0;
+    // with an unknown active unit there is nothing to compare with
+    if (slot < 0 || unit >= TEXTURE_UNITS)
+    {
+        changed(true);
+        glBindTexture(target, texture);
+        return;
+    }
+    if (changed(textures_[unit][slot] != texture))
+    {
+        glBindTexture(target, texture);
+        textures_[unit][slot] = texture;
+    }
+}
+
+void GLStateCache::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+    int slot = textureSlot(target);
+    GLuint index = unit - GL_TEXTURE0;
+    if (slot >= 0 && index < TEXTURE_UNITS && textures_[index][slot] == texture)
+    {
+        // neither the unit switch nor the bind is needed
+        changed(false);
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler)
+{
+    if (unit >= TEXTURE_UNITS)
+    {
+        changed(true);
+        glBindSampler(unit, sampler);
+        return;
+    }
+    if (changed(samplers_[unit] != sampler))
+    {
+        glBindSampler(unit, sampler);
+        samplers_[unit] = sampler;
+    }
+}
+
+void GLStateCache::setCapability(GLenum cap, bool enabled)
+{
+    int slot = capabilitySlot(cap);
+    GLuint value = enabled ? 1 : 0;
+    if (slot >= 0 && !changed(capabilities_[slot] != value))
+        return;
+    if (slot < 0)
+        changed(true);
+    else
+        capabilities_[slot] = value;
+
+    if (enabled)
+        glEnable(cap);
+    else
+        glDisable(cap);
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+    setCapability(cap, true);
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+    setCapability(cap, false);
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+    if (changed(depthFunc_ != func))
+    {
+        glDepthFunc(func);
+        depthFunc_ = func;
+    }
+}
+
+void GLStateCache::depthMask(GLboolean flag)
+{
+    GLuint value = flag ? 1 : 0;
+    if (changed(depthMask_ != value))
+    {
+        glDepthMask(flag);
+        depthMask_ = value;
+    }
+}
+
+void GLStateCache::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+    if (changed(blendSrc_ != sfactor || blendDst_ != dfactor))
+    {
+        glBlendFunc(sfactor, dfactor);
+        blendSrc_ = sfactor;
+        blendDst_ = dfactor;
+    }
+}
+
+void GLStateCache::colorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+{
+    GLuint value = (r ? 1 : 0) | (g ? 2 : 0) | (b ? 4 : 0) | (a ? 8 : 0);
+    if (changed(colorMask_ != value))
+    {
+        glColorMask(r, g, b, a);
+        colorMask_ = value;
+    }
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    bool same = viewportKnown_ && viewport_[0] == x && viewport_[1] == y
+        && viewport_[2] == width && viewport_[3] == height;
+    if (changed(!same))
+    {
+        glViewport(x, y, width, height);
+        viewport_[0] = x;
+        viewport_[1] = y;
+        viewport_[2] = width;
+        viewport_[3] = height;
+        viewportKnown_ = true;
+    }
+}
+
+void GLStateCache::deleteProgram(GLuint program)
+{
+    // a program in use stays current until it is replaced, forgetting it is just the safe side
+    if (program_ == program)
+        program_ = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei n, const GLuint* vaos)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        // deleting the bound vertex array binds 0
+        if (vaos[i] != 0 && vertexArray_ == vaos[i])
+        {
+            vertexArray_ = 0;
+            buffers_[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+        }
+    }
+    glDeleteVertexArrays(n, vaos);
+}
+
+void GLStateCache::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (buffers[i] == 0)
+            continue;
+        for (GLuint& bound : buffers_)
+        {
+            if (bound == buffers[i])
+                bound = 0;
+        }
+    }
+    glDeleteBuffers(n, buffers);
+}
+
+void GLStateCache::deleteTextures(GLsizei n, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (textures[i] == 0)
+            continue;
+        for (auto& unit : textures_)
+        {
+            for (GLuint& bound : unit)
+            {
+                if (bound == textures[i])
+                    bound = 0;
+            }
+        }
+    }
+    glDeleteTextures(n, textures);
+}
+
+void GLStateCache::deleteSamplers(GLsizei n, const GLuint* samplers)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (samplers[i] == 0)
+            continue;
+        for (GLuint& bound : samplers_)
+        {
+            if (bound == samplers[i])
+                bound = 0;
+        }
+    }
+    glDeleteSamplers(n, samplers);
+}
+
+void GLStateCache::invalidate()
+{
+    program_ = UNKNOWN;
+    vertexArray_ = UNKNOWN;
+    for (GLuint& buffer : buffers_)
+        buffer = UNKNOWN;
+    activeUnit_ = UNKNOWN;
+    for (auto& unit : textures_)
+    {
+        for (GLuint& texture : unit)
+            texture = UNKNOWN;
+    }
+    for (GLuint& sampler : samplers_)
+        sampler = UNKNOWN;
+    for (GLuint& capability : capabilities_)
+        capability = UNKNOWN;
+    depthFunc_ = UNKNOWN;
+    depthMask_ = UNKNOWN;
+    blendSrc_ = UNKNOWN;
+    blendDst_ = UNKNOWN;
+    colorMask_ = UNKNOWN;
+    viewportKnown_ = false;
+}
+
+void GLStateCache::endFrame()
+{
+    lastFrame_ = frame_;
+    frame_ = GLStateStats();
+}
+
+GLStateCache& GLState()
+{
+    static thread_local GLStateCache cache;
+    return cache;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <glad/glad.h>
+
+// issued and elided GL calls of one frame, see GLStateCache::setStatistics
+struct GLStateStats
+{
+    unsigned int issued = 0;
+    unsigned int elided = 0;
+};
+
+// shadows the GL state the samples set every frame and drops the calls that would not change
+// anything. every value starts out unknown, so the first call always reaches GL.
+// the cache only knows about calls made through it: code that binds or changes this state
+// directly has to call invalidate() afterwards, and objects must be deleted through the
+// delete functions below, otherwise a new object that reuses the name of a deleted one
+// would look as if it were still bound.
+class GLStateCache
+{
+public:
+    static const int TEXTURE_UNITS = 16;
+
+    GLStateCache();
+
+    void useProgram(GLuint program);
+    // binding a vertex array also switches the element array buffer, which is vertex array state
+    void bindVertexArray(GLuint vao);
+    // targets the cache does not track are passed through
+    void bindBuffer(GLenum target, GLuint buffer);
+    // the indexed binding is always issued, the generic binding it also changes is remembered
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+    // unit is GL_TEXTURE0 + i like for glActiveTexture
+    void activeTexture(GLenum unit);
+    // binds on the active unit, GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP are tracked
+    void bindTexture(GLenum target, GLuint texture);
+    // activeTexture + bindTexture, the unit is only switched if the binding changes
+    void bindTexture(GLenum unit, GLenum target, GLuint texture);
+    // unit is the index i like for glBindSampler, 0 leaves the texture's own parameters in effect
+    void bindSampler(GLuint unit, GLuint sampler);
+
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST and GL_STENCIL_TEST are tracked
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void depthFunc(GLenum func);
+    void depthMask(GLboolean flag);
+    void blendFunc(GLenum sfactor, GLenum dfactor);
+    void colorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // delete the objects and forget every binding that refers to them
+    void deleteProgram(GLuint program);
+    void deleteVertexArrays(GLsizei n, const GLuint* vaos);
+    void deleteBuffers(GLsizei n, const GLuint* buffers);
+    void deleteTextures(GLsizei n, const GLuint* textures);
+    void deleteSamplers(GLsizei n, const GLuint* samplers);
+
+    // forgets everything, the next call of every kind reaches GL again
+    void invalidate();
+
+    // statistics mode counts the issued and elided calls, endFrame() moves the counts of the
+    // frame into lastFrame() and starts counting the next one
+    void setStatistics(bool enabled) { statistics_ = enabled; }
+    bool statistics() const { return statistics_; }
+    void endFrame();
+    const GLStateStats& lastFrame() const { return lastFrame_; }
+    // every call that reached GL so far, counted in statistics mode or not. code that wraps the
+    // cache takes the difference to know what its binds really cost.
+    unsigned int issuedCalls() const { return issuedCalls_; }
+
+private:
+    static const int BUFFER_TARGETS = 6;
+    static const int TEXTURE_TARGETS = 2;
+    static const int CAPABILITIES = 5;
+
+    // index into the shadow arrays, -1 if the target is not tracked
+    static int bufferSlot(GLenum target);
+    static int textureSlot(GLenum target);
+    static int capabilitySlot(GLenum cap);
+
+    // counts the call and returns true if it has to be issued
+    bool changed(bool differs)
+    {
+        if (differs)
+            issuedCalls_++;
+        if (statistics_)
+        {
+            if (differs)
+                frame_.issued++;
+            else
+                frame_.elided++;
+        }
+        return differs;
+    }
+    void setCapability(GLenum cap, bool enabled);
+
+    // unknown values are stored as UNKNOWN, which no real name or enum ever matches
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    GLuint program_;
+    GLuint vertexArray_;
+    GLuint buffers_[BUFFER_TARGETS];
+    GLenum activeUnit_;
+    GLuint textures_[TEXTURE_UNITS][TEXTURE_TARGETS];
+    GLuint samplers_[TEXTURE_UNITS];
+    GLuint capabilities_[CAPABILITIES];
+    GLenum depthFunc_;
+    GLuint depthMask_;
+    GLenum blendSrc_;
+    GLenum blendDst_;
+    GLuint colorMask_;
+    GLint viewport_[4];
+    bool viewportKnown_;
+
+    bool statistics_ = false;
+    GLStateStats frame_;
+    GLStateStats lastFrame_;
+    unsigned int issuedCalls_ = 0;
+};
+
+// the cache of the calling thread, i.e. of the context current on it. a thread that makes
+// another context current has to invalidate() it.
+GLStateCache& GLState();
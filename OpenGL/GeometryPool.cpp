@@ -0,0 +1,174 @@
+#include "GeometryPool.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+
+GeometryPool::GeometryPool(GLsizei vertexCapacity, GLsizei indexCapacity)
+    : vertexCapacity_(vertexCapacity), indexCapacity_(indexCapacity)
+{
+    GLStateCache& gl = GLState();
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vertexBuffer_);
+    glGenBuffers(1, &indexBuffer_);
+    glGenBuffers(1, &drawIdBuffer_);
+    glGenBuffers(1, &indirectBuffer_);
+    glGenBuffers(1, &modelBuffer_);
+    glGenTextures(1, &modelTexture_);
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity_ * GEOMETRY_VERTEX_FLOATS * sizeof(float), NULL, GL_STATIC_DRAW);
+    gl.bindBuffer(GL_ARRAY_BUFFER, drawIdBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_STATIC_DRAW);
+    // the element buffer binding is vertex array state, setupVertexArray binds it
+    gl.bindVertexArray(vao_);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity_ * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+    setupVertexArray();
+
+    gl.bindBuffer(GL_TEXTURE_BUFFER, modelBuffer_);
+    glBufferData(GL_TEXTURE_BUFFER, 0, NULL, GL_STREAM_DRAW);
+    gl.bindTexture(GL_TEXTURE_BUFFER, modelTexture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, modelBuffer_);
+}
+
+GeometryPool::~GeometryPool()
+{
+    GLStateCache& gl = GLState();
+    gl.deleteVertexArrays(1, &vao_);
+    GLuint buffers[] = { vertexBuffer_, indexBuffer_, drawIdBuffer_, indirectBuffer_, modelBuffer_ };
+    gl.deleteBuffers(5, buffers);
+    gl.deleteTextures(1, &modelTexture_);
+}
+
+void GeometryPool::setupVertexArray()
+{
+    GLStateCache& gl = GLState();
+    gl.bindVertexArray(vao_);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, GEOMETRY_VERTEX_FLOATS * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, GEOMETRY_VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // draw id, one value per instance. submitDraws switches the array on and off
+    gl.bindBuffer(GL_ARRAY_BUFFER, drawIdBuffer_);
+    glVertexAttribIPointer(GEOMETRY_DRAW_ID_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(GEOMETRY_DRAW_ID_ATTRIBUTE, 1);
+}
+
+void GeometryPool::growBuffer(GLuint& buffer, GLsizeiptr used, GLsizeiptr capacity)
+{
+    GLuint grown;
+    glGenBuffers(1, &grown);
+    GLState().bindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STATIC_DRAW);
+    GLState().bindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+    GLState().deleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+GeometryMesh GeometryPool::addMesh(const float* vertices, GLsizei vertexCount, const GLuint* indices, GLsizei indexCount)
+{
+    bool grown = false;
+    if (vertexCount_ + vertexCount > vertexCapacity_)
+    {
+        while (vertexCount_ + vertexCount > vertexCapacity_)
+            vertexCapacity_ *= 2;
+        growBuffer(vertexBuffer_, (GLsizeiptr)vertexCount_ * GEOMETRY_VERTEX_FLOATS * sizeof(float),
+            (GLsizeiptr)vertexCapacity_ * GEOMETRY_VERTEX_FLOATS * sizeof(float));
+        grown = true;
+    }
+    if (indexCount_ + indexCount > indexCapacity_)
+    {
+        while (indexCount_ + indexCount > indexCapacity_)
+            indexCapacity_ *= 2;
+        growBuffer(indexBuffer_, (GLsizeiptr)indexCount_ * sizeof(GLuint), (GLsizeiptr)indexCapacity_ * sizeof(GLuint));
+        grown = true;
+    }
+    // the vertex array still points at the old buffers
+    if (grown)
+        setupVertexArray();
+
+    GeometryMesh mesh;
+    mesh.firstIndex = indexCount_;
+    mesh.indexCount = indexCount;
+    mesh.baseVertex = vertexCount_;
+
+    GLState().bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexCount_ * GEOMETRY_VERTEX_FLOATS * sizeof(float),
+        (GLsizeiptr)vertexCount * GEOMETRY_VERTEX_FLOATS * sizeof(float), vertices);
+    GLState().bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexCount_ * sizeof(GLuint), (GLsizeiptr)indexCount * sizeof(GLuint), indices);
+
+    vertexCount_ += vertexCount;
+    indexCount_ += indexCount;
+    return mesh;
+}
+
+void GeometryPool::clearDraws()
+{
+    draws_.clear();
+    models_.clear();
+}
+
+void GeometryPool::addDraw(const GeometryMesh& mesh, const glm::mat4& model)
+{
+    DrawElementsIndirectCommand command;
+    command.count = (GLuint)mesh.indexCount;
+    command.instanceCount = 1;
+    command.firstIndex = mesh.firstIndex;
+    command.baseVertex = mesh.baseVertex;
+    // the single instance of draw i reads entry i of the draw id buffer
+    command.baseInstance = (GLuint)draws_.size();
+    draws_.push_back(command);
+    models_.push_back(model);
+}
+
+void GeometryPool::submitDraws(GLenum modelsUnit, bool multiDrawIndirect)
+{
+    if (draws_.empty())
+        return;
+    GLStateCache& gl = GLState();
+    GLsizei count = (GLsizei)draws_.size();
+
+    // the model matrices, the old storage is orphaned so the upload doesn't wait for the last frame
+    gl.bindBuffer(GL_TEXTURE_BUFFER, modelBuffer_);
+    glBufferData(GL_TEXTURE_BUFFER, models_.size() * sizeof(glm::mat4), models_.data(), GL_STREAM_DRAW);
+    gl.bindTexture(modelsUnit, GL_TEXTURE_BUFFER, modelTexture_);
+
+    gl.bindVertexArray(vao_);
+    if (multiDrawIndirect && HasMultiDrawIndirect())
+    {
+        if (drawIdCapacity_ < count)
+        {
+            while (drawIdCapacity_ < count)
+                drawIdCapacity_ = drawIdCapacity_ ? drawIdCapacity_ * 2 : 1024;
+            std::vector<GLuint> ids(drawIdCapacity_);
+            for (GLsizei i = 0; i < drawIdCapacity_; i++)
+                ids[i] = (GLuint)i;
+            gl.bindBuffer(GL_ARRAY_BUFFER, drawIdBuffer_);
+            glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(GLuint), ids.data(), GL_STATIC_DRAW);
+        }
+        glEnableVertexAttribArray(GEOMETRY_DRAW_ID_ATTRIBUTE);
+
+        gl.bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, draws_.size() * sizeof(DrawElementsIndirectCommand), draws_.data(), GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, count, 0);
+    }
+    else
+    {
+        // without the array the attribute reads its current value, which is set per draw
+        glDisableVertexAttribArray(GEOMETRY_DRAW_ID_ATTRIBUTE);
+        for (GLsizei i = 0; i < count; i++)
+        {
+            const DrawElementsIndirectCommand& draw = draws_[i];
+            glVertexAttribI1ui(GEOMETRY_DRAW_ID_ATTRIBUTE, (GLuint)i);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)draw.count, GL_UNSIGNED_INT,
+                (void*)((size_t)draw.firstIndex * sizeof(GLuint)), draw.baseVertex);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// where a mesh lives inside the pool, the arguments of its glDrawElementsBaseVertex
+struct GeometryMesh
+{
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    GLint baseVertex = 0;
+};
+
+// layout of GL_DRAW_INDIRECT_BUFFER entries for glDrawElementsIndirect / glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// all meshes in one vertex buffer and one index buffer behind one vertex array, so different meshes
+// can be drawn without switching any state. vertices are x y z u v like the Scene vertices, indices
+// are GLuint and relative to the first vertex of their mesh.
+//
+// the draws of a frame are collected with addDraw() and drawn by submitDraws(): with
+// glMultiDrawElementsIndirect when the context has it (see HasMultiDrawIndirect), otherwise with
+// one glDrawElementsBaseVertex per draw. the shader gets the index of the draw in attribute
+// GEOMETRY_DRAW_ID_ATTRIBUTE (a uint), either through an instanced attribute and the baseInstance
+// of the indirect command, or as a constant attribute value set before each draw in the fallback.
+// the model matrices of the draws are in a RGBA32F buffer texture, four texels per draw, see
+// Shader/vertexGeometryPool.shader.
+const GLuint GEOMETRY_DRAW_ID_ATTRIBUTE = 2;
+const int GEOMETRY_VERTEX_FLOATS = 5;
+
+class GeometryPool
+{
+public:
+    // initial capacities, the buffers grow when a mesh doesn't fit anymore
+    GeometryPool(GLsizei vertexCapacity = 1 << 16, GLsizei indexCapacity = 1 << 18);
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // copies the mesh into the pool, vertices holds vertexCount * GEOMETRY_VERTEX_FLOATS floats
+    GeometryMesh addMesh(const float* vertices, GLsizei vertexCount, const GLuint* indices, GLsizei indexCount);
+
+    // the draw list of the frame
+    void clearDraws();
+    void addDraw(const GeometryMesh& mesh, const glm::mat4& model);
+    size_t drawCount() const { return draws_.size(); }
+
+    // draws the list with the program in use, the model matrices are bound to texture unit
+    // modelsUnit (GL_TEXTURE0 + i) as GL_TEXTURE_BUFFER. the list stays, clearDraws() empties it.
+    // multiDrawIndirect = false forces the glDrawElementsBaseVertex loop.
+    void submitDraws(GLenum modelsUnit, bool multiDrawIndirect = true);
+
+    GLuint vertexArray() const { return vao_; }
+    GLsizei vertexCount() const { return vertexCount_; }
+    GLsizei indexCount() const { return indexCount_; }
+
+private:
+    // replaces buffer with a bigger one and keeps the first used bytes
+    static void growBuffer(GLuint& buffer, GLsizeiptr used, GLsizeiptr capacity);
+    void setupVertexArray();
+
+    GLuint vao_ = 0;
+    GLuint vertexBuffer_ = 0;
+    GLuint indexBuffer_ = 0;
+    GLsizei vertexCapacity_;
+    GLsizei indexCapacity_;
+    GLsizei vertexCount_ = 0;
+    GLsizei indexCount_ = 0;
+
+    // per draw data: 0, 1, 2... for the instanced draw id attribute, the indirect commands
+    // and the model matrices behind the buffer texture
+    GLuint drawIdBuffer_ = 0;
+    GLuint indirectBuffer_ = 0;
+    GLuint modelBuffer_ = 0;
+    GLuint modelTexture_ = 0;
+    GLsizei drawIdCapacity_ = 0;
+
+    std::vector<DrawElementsIndirectCommand> draws_;
+    std::vector<glm::mat4> models_;
+};
@@ -0,0 +1,357 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "GeometryPool.h"
+
+// three different meshes (cube, pyramid, sphere) in one GeometryPool, a grid of objects picks one
+// of them each. all objects are drawn with one glMultiDrawElementsIndirect if the context has it,
+// the model matrices come from a buffer texture indexed by the draw id. I switches to the
+// glDrawElementsBaseVertex loop, the frame times are printed every 100 frames.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int GRID_SIZE = 24;
+const float GRID_SPACING = 2.0f;
+
+glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, GRID_SIZE * GRID_SPACING * 0.5f + 5.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = SCR_WIDTH / 2.0;
+float lastY = SCR_HEIGHT / 2.0;
+float fov = 45.0f;
+
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+bool multiDrawIndirect = true;
+
+// the cube of the scene is a plain triangle list, every vertex gets its own index
+static GeometryMesh AddCube(GeometryPool& pool, const std::vector<float>& vertices)
+{
+    GLsizei vertexCount = (GLsizei)vertices.size() / GEOMETRY_VERTEX_FLOATS;
+    std::vector<GLuint> indices(vertexCount);
+    for (GLsizei i = 0; i < vertexCount; i++)
+        indices[i] = (GLuint)i;
+    return pool.addMesh(vertices.data(), vertexCount, indices.data(), vertexCount);
+}
+
+// square base and four sides, the sides get their own vertices for the texture coordinates
+static GeometryMesh AddPyramid(GeometryPool& pool)
+{
+    const float vertices[] = {
+        // base
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+         0.5f, -0.5f,  0.5f,  1.0f, 1.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f, 1.0f,
+        // sides, two base corners and the apex each
+        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,   0.5f, -0.5f,  0.5f,  1.0f, 0.0f,   0.0f, 0.5f, 0.0f,  0.5f, 1.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,   0.5f, -0.5f, -0.5f,  1.0f, 0.0f,   0.0f, 0.5f, 0.0f,  0.5f, 1.0f,
+         0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  -0.5f, -0.5f, -0.5f,  1.0f, 0.0f,   0.0f, 0.5f, 0.0f,  0.5f, 1.0f,
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  -0.5f, -0.5f,  0.5f,  1.0f, 0.0f,   0.0f, 0.5f, 0.0f,  0.5f, 1.0f,
+    };
+    const GLuint indices[] = {
+        0, 1, 2,  2, 3, 0,
+        4, 5, 6,  7, 8, 9,  10, 11, 12,  13, 14, 15,
+    };
+    return pool.addMesh(vertices, 16, indices, 18);
+}
+
+// latitude/longitude sphere with radius 0.5
+static GeometryMesh AddSphere(GeometryPool& pool, int rings, int segments)
+{
+    const float PI = 3.14159265f;
+    std::vector<float> vertices;
+    for (int ring = 0; ring <= rings; ring++)
+    {
+        float v = (float)ring / rings;
+        float theta = v * PI;
+        for (int segment = 0; segment <= segments; segment++)
+        {
+            float u = (float)segment / segments;
+            float phi = u * 2.0f * PI;
+            vertices.push_back(0.5f * std::sin(theta) * std::cos(phi));
+            vertices.push_back(0.5f * std::cos(theta));
+            vertices.push_back(0.5f * std::sin(theta) * std::sin(phi));
+            vertices.push_back(u);
+            vertices.push_back(1.0f - v);
+        }
+    }
+    std::vector<GLuint> indices;
+    for (int ring = 0; ring < rings; ring++)
+    {
+        for (int segment = 0; segment < segments; segment++)
+        {
+            GLuint a = ring * (segments + 1) + segment;
+            GLuint b = a + segments + 1;
+            indices.insert(indices.end(), { a, a + 1, b, b, a + 1, b + 1 });
+        }
+    }
+    return pool.addMesh(vertices.data(), (GLsizei)vertices.size() / GEOMETRY_VERTEX_FLOATS,
+        indices.data(), (GLsizei)indices.size());
+}
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // configure global opengl state
+    // -----------------------------
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        // one pool for all meshes, drawn with the textures of the camera sample
+        // ---------------------------------------------------------------------
+        Scene scene = CreateCubeScene();
+        std::string vertexShaderPath = GetWorkingDir() + "\\Shader\\vertexGeometryPool.shader";
+        Shader ourShader(vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+
+        GeometryPool pool;
+        GeometryMesh meshes[3] = { AddCube(pool, scene.vertices), AddPyramid(pool), AddSphere(pool, 16, 32) };
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        ourShader.use();
+        ourShader.setInt("ourTexture", 0);
+        ourShader.setInt("texture2", 1);
+        ourShader.setInt("models", 2);
+
+        if (HasMultiDrawIndirect())
+            std::cout << "glMultiDrawElementsIndirect is available" << std::endl;
+        else
+            std::cout << "no glMultiDrawElementsIndirect, drawing with glDrawElementsBaseVertex" << std::endl;
+
+        // the objects: a grid, each cell with one of the meshes and its own rotation
+        // --------------------------------------------------------------------------
+        std::vector<glm::vec3> objectPositions;
+        std::vector<int> objectMeshes;
+        for (int x = 0; x < GRID_SIZE; x++)
+            for (int y = 0; y < GRID_SIZE; y++)
+                for (int z = 0; z < GRID_SIZE; z++)
+                {
+                    objectPositions.push_back((glm::vec3((float)x, (float)y, (float)z) - glm::vec3(GRID_SIZE * 0.5f)) * GRID_SPACING);
+                    objectMeshes.push_back((x + y * 2 + z * 3) % 3);
+                }
+
+        double frameTimeSum = 0.0;
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            processInput(window);
+
+            glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+            glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+            ourShader.use();
+            ourShader.setMat4("view", view);
+            ourShader.setMat4("projection", projection);
+
+            // the draw list is rebuilt every frame, the objects keep turning
+            pool.clearDraws();
+            for (size_t i = 0; i < objectPositions.size(); i++)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), objectPositions[i]);
+                model = glm::rotate(model, currentFrame + (float)i, glm::vec3(1.0f, 0.3f, 0.5f));
+                pool.addDraw(meshes[objectMeshes[i]], model);
+            }
+            pool.submitDraws(GL_TEXTURE2, multiDrawIndirect);
+            glFinish();
+
+            frameTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (++framesMeasured == 100)
+            {
+                bool indirect = multiDrawIndirect && HasMultiDrawIndirect();
+                std::cout << (indirect ? "multi draw indirect" : "base vertex loop") << ": " << frameTimeSum / framesMeasured
+                    << " ms per frame for " << pool.drawCount() << " draws" << std::endl;
+                frameTimeSum = 0.0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool iWasPressed = false;
+    bool iPressed = glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS;
+    if (iPressed && !iWasPressed)
+        multiDrawIndirect = !multiDrawIndirect;
+    iWasPressed = iPressed;
+
+    float cameraSpeed = 5.0f * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // to avoid a camera jump causing by mouse focus on game start
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+    lastX = xpos;
+    lastY = ypos;
+
+    const float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
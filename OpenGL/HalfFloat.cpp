@@ -0,0 +1,28 @@
+#include "HalfFloat.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+
+F16C_TARGET
+static void FloatsToHalvesF16C(const float* values, uint16_t* halves, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(halves + i), packed);
+    }
+    for (; i < count; i++)
+        halves[i] = FloatToHalf(values[i]);
+}
+
+void FloatsToHalves(const float* values, uint16_t* halves, size_t count)
+{
+    if (CpuHasF16C())
+    {
+        FloatsToHalvesF16C(values, halves, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+        halves[i] = FloatToHalf(values[i]);
+}
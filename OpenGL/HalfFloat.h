@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// IEEE 754 binary16 conversion in plain C++, the format of GL_HALF_FLOAT attributes and textures.
+// float to half rounds to nearest even, values beyond the half range become infinity and
+// denormals are kept.
+
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    // NaN stays NaN (quiet), infinity and overflow become infinity
+    if (magnitude > 0x7F800000u)
+        return (uint16_t)(sign | 0x7E00u);
+    if (magnitude >= 0x477FF000u)
+        return (uint16_t)(sign | 0x7C00u);
+
+    if (magnitude < 0x38800000u)
+    {
+        // half denormal or zero: shift the mantissa with its implicit one into place
+        if (magnitude < 0x33000000u)
+            return (uint16_t)sign;
+        uint32_t exponent = magnitude >> 23;
+        uint32_t mantissa = (magnitude & 0x007FFFFFu) | 0x00800000u;
+        uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return (uint16_t)(sign | half);
+    }
+
+    // normal range: rebias the exponent and round the mantissa from 23 to 10 bits
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    uint32_t rest = magnitude & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1)))
+        half++;
+    return (uint16_t)(sign | half);
+}
+
+inline float HalfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0x1Fu)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // denormal half, normalize it for the float
+        exponent = 113;
+        while ((mantissa & 0x400u) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// FloatToHalf over an array, eight values per instruction where the CPU has F16C (HalfFloat.cpp).
+// the results are the same as FloatToHalf's, only NaNs keep their payload bits.
+void FloatsToHalves(const float* values, uint16_t* halves, size_t count);
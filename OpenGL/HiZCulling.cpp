@@ -0,0 +1,346 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "OcclusionCuller.h"
+
+// stress scene for the CPU occlusion culling: a block of GRID_SIZE^3 densely packed cubes, so
+// from outside nearly all of them are hidden behind the outer layers. the nearest cubes are
+// the occluder candidates, every cube is tested against the depth pyramid before its draw call.
+// C toggles the culling, the counters are printed every 100 frames.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int GRID_SIZE = 32;
+const float GRID_SPACING = 1.05f;
+const int OCCLUDER_CANDIDATES = 256;
+
+glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, GRID_SIZE * GRID_SPACING * 0.5f + 5.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = SCR_WIDTH / 2.0;
+float lastY = SCR_HEIGHT / 2.0;
+float fov = 45.0f;
+
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+bool cullingEnabled = true;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // configure global opengl state
+    // -----------------------------
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        // the cube, textures and shaders of the camera sample
+        // ---------------------------------------------------
+        Scene scene = CreateCubeScene();
+        Shader ourShader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+
+        unsigned int VBO, VAO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        GLState().bindVertexArray(VAO);
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, scene.vertices.size() * sizeof(float), scene.vertices.data(), GL_STATIC_DRAW);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coord attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        ourShader.use();
+        ourShader.setInt("ourTexture", 0);
+        ourShader.setInt("texture2", 1);
+
+        // the stress scene: a dense block of unit cubes around the origin
+        // ---------------------------------------------------------------
+        std::vector<glm::mat4> cubeModels;
+        std::vector<glm::vec3> cubePositions;
+        for (int x = 0; x < GRID_SIZE; x++)
+            for (int y = 0; y < GRID_SIZE; y++)
+                for (int z = 0; z < GRID_SIZE; z++)
+                {
+                    glm::vec3 position = (glm::vec3((float)x, (float)y, (float)z) - glm::vec3(GRID_SIZE * 0.5f)) * GRID_SPACING;
+                    cubePositions.push_back(position);
+                    cubeModels.push_back(glm::translate(glm::mat4(1.0f), position));
+                }
+        const glm::vec3 cubeMin(-0.5f), cubeMax(0.5f);
+
+        OcclusionCuller culler;
+        std::vector<int> candidates(cubeModels.size());
+
+        double cullTimeSum = 0.0;
+        double frameTimeSum = 0.0;
+        long long drawnSum = 0;
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            processInput(window);
+
+            glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+            glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // occlusion culling: the nearest cubes in front of the camera are the occluder candidates,
+            // the culler drops those that end up too small on screen
+            // ---------------------------------------------------------------------------------------
+            if (cullingEnabled)
+            {
+                culler.beginFrame(projection * view);
+                for (size_t i = 0; i < candidates.size(); i++)
+                    candidates[i] = (int)i;
+                auto distance = [&](int i) {
+                    glm::vec3 toCube = cubePositions[i] - cameraPos;
+                    // behind the camera sorts last
+                    return glm::dot(toCube, cameraFront) < 0.0f ? 1e30f : glm::dot(toCube, toCube);
+                };
+                int candidateCount = std::min(OCCLUDER_CANDIDATES, (int)candidates.size());
+                std::nth_element(candidates.begin(), candidates.begin() + candidateCount, candidates.end(),
+                    [&](int a, int b) { return distance(a) < distance(b); });
+                for (int i = 0; i < candidateCount; i++)
+                    culler.addOccluderBox(cubeModels[candidates[i]], cubeMin, cubeMax);
+                culler.buildPyramid();
+            }
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+
+            ourShader.use();
+            ourShader.setMat4("view", view);
+            ourShader.setMat4("projection", projection);
+
+            GLState().bindVertexArray(VAO);
+            int drawn = 0;
+            double cullTime = 0.0;
+            for (size_t i = 0; i < cubeModels.size(); i++)
+            {
+                if (cullingEnabled)
+                {
+                    auto testStart = std::chrono::steady_clock::now();
+                    bool visible = culler.isVisible(cubeModels[i], cubeMin, cubeMax);
+                    cullTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - testStart).count();
+                    if (!visible)
+                        continue;
+                }
+                ourShader.setMat4("model", cubeModels[i]);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                drawn++;
+            }
+            glFinish();
+
+            frameTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            cullTimeSum += cullTime;
+            drawnSum += drawn;
+            if (++framesMeasured == 100)
+            {
+                std::cout << (cullingEnabled ? "culling on" : "culling off") << ": " << frameTimeSum / framesMeasured << " ms per frame, "
+                    << drawnSum / framesMeasured << " of " << cubeModels.size() << " cubes drawn" << std::endl;
+                if (cullingEnabled)
+                {
+                    const OcclusionStats& stats = culler.stats();
+                    std::cout << "  last frame: " << stats.occluders << " occluders (" << stats.occludersRejected << " rejected, "
+                        << stats.occluderTriangles << " triangles), " << stats.tested << " tested, " << stats.frustumCulled
+                        << " frustum culled, " << stats.occlusionCulled << " occlusion culled, " << stats.visible << " visible ("
+                        << stats.unoccluded << " unoccluded)" << std::endl;
+                    std::cout << "  rasterize " << stats.rasterizeMs << " ms, pyramid " << stats.pyramidMs << " ms, tests "
+                        << cullTimeSum / framesMeasured << " ms per frame" << std::endl;
+                }
+                frameTimeSum = 0.0;
+                cullTimeSum = 0.0;
+                drawnSum = 0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool cWasPressed = false;
+    bool cPressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+    if (cPressed && !cWasPressed)
+        cullingEnabled = !cullingEnabled;
+    cWasPressed = cPressed;
+
+    float cameraSpeed = 5.0f * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // to avoid a camera jump causing by mouse focus on game start
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+    lastX = xpos;
+    lastY = ypos;
+
+    const float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
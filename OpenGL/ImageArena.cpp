@@ -0,0 +1,158 @@
+#include "ImageArena.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+// all blocks are 16 byte aligned, stb_image's SSE2/NEON paths rely on that for malloc'ed memory
+static const size_t ARENA_ALIGNMENT = 16;
+
+static std::atomic<size_t> globalHighWaterMark(0);
+
+struct ImageArena
+{
+    unsigned char* base = nullptr;
+    size_t capacity = IMAGE_ARENA_DEFAULT_CAPACITY;
+    size_t top = 0;             // first free byte
+    size_t lastOffset = 0;      // start of the most recent block, the only one that can grow in place or be popped
+    unsigned char* last = nullptr;
+    int scopeDepth = 0;
+    ImageArenaStats stats = {};
+
+    ~ImageArena()
+    {
+        std::free(base);
+    }
+
+    bool Owns(const void* p) const
+    {
+        const unsigned char* bytes = (const unsigned char*)p;
+        return base != nullptr && bytes >= base && bytes < base + capacity;
+    }
+
+    void* Allocate(size_t size)
+    {
+        size_t offset = (top + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+        if (offset > capacity || size > capacity - offset)
+        {
+            // stb_image reports this as "outofmem" and the load fails cleanly
+            stats.failedAllocations++;
+            return nullptr;
+        }
+        lastOffset = offset;
+        last = base + offset;
+        top = offset + size;
+        stats.allocations++;
+        UpdateUsage();
+        return last;
+    }
+
+    void UpdateUsage()
+    {
+        stats.used = top;
+        if (top > stats.highWaterMark)
+        {
+            stats.highWaterMark = top;
+            size_t global = globalHighWaterMark.load(std::memory_order_relaxed);
+            while (top > global && !globalHighWaterMark.compare_exchange_weak(global, top, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    void Reset()
+    {
+        top = 0;
+        lastOffset = 0;
+        last = nullptr;
+        stats.used = 0;
+        stats.resets++;
+    }
+};
+
+static thread_local ImageArena arena;
+
+void SetImageArenaCapacity(size_t capacity)
+{
+    if (arena.scopeDepth > 0)
+        return; // blocks of the running scope live in the current reservation
+    std::free(arena.base);
+    arena.base = nullptr;
+    arena.capacity = capacity;
+}
+
+ImageArenaStats GetImageArenaStats()
+{
+    ImageArenaStats stats = arena.stats;
+    stats.capacity = arena.capacity;
+    return stats;
+}
+
+size_t GetImageArenaGlobalHighWaterMark()
+{
+    return globalHighWaterMark.load(std::memory_order_relaxed);
+}
+
+ImageArenaScope::ImageArenaScope()
+{
+    if (arena.scopeDepth++ == 0 && arena.base == nullptr)
+        arena.base = (unsigned char*)std::malloc(arena.capacity);
+}
+
+ImageArenaScope::~ImageArenaScope()
+{
+    if (--arena.scopeDepth == 0)
+        arena.Reset();
+}
+
+void* ImageArenaMalloc(size_t size)
+{
+    if (arena.scopeDepth == 0 || arena.base == nullptr)
+    {
+        arena.stats.heapAllocations++;
+        return std::malloc(size);
+    }
+    return arena.Allocate(size);
+}
+
+void* ImageArenaRealloc(void* p, size_t oldSize, size_t newSize)
+{
+    if (p == nullptr)
+        return ImageArenaMalloc(newSize);
+
+    if (!arena.Owns(p))
+        return std::realloc(p, newSize);
+
+    // the zlib output buffer is grown over and over while it is the newest block, so this is the common case
+    if (p == arena.last && newSize <= arena.capacity - arena.lastOffset)
+    {
+        arena.top = arena.lastOffset + newSize;
+        arena.UpdateUsage();
+        return p;
+    }
+
+    void* moved = arena.scopeDepth > 0 ? arena.Allocate(newSize) : std::malloc(newSize);
+    if (moved != nullptr)
+        std::memcpy(moved, p, oldSize < newSize ? oldSize : newSize);
+    return moved;
+}
+
+void ImageArenaFree(void* p)
+{
+    if (p == nullptr)
+        return;
+
+    if (!arena.Owns(p))
+    {
+        std::free(p);
+        return;
+    }
+
+    // everything else is released in one go when the scope ends
+    if (p == arena.last)
+    {
+        arena.top = arena.lastOffset;
+        arena.last = nullptr;
+        arena.stats.used = arena.top;
+    }
+}
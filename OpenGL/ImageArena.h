@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+
+// per thread bump allocator for the temporary buffers stb_image allocates while decoding
+// (jpeg component planes, the zlib output of png files, png filter rows and the final image).
+// stb_image.cpp routes STBI_MALLOC, STBI_REALLOC_SIZED and STBI_FREE through it.
+//
+// usage on a loader thread:
+//     ImageArenaScope scope;            // everything stb_image allocates from here on comes from the arena
+//     stbi_load_into(path, ...);        // or stbi_load + upload + stbi_image_free
+//                                       // the arena is reset when the scope ends
+//
+// outside of a scope the hooks fall back to malloc/realloc/free, so code that keeps
+// images around longer (like stbi_load on the main thread) still works unchanged.
+// an image loaded inside a scope has to be freed (or simply dropped) on the thread that loaded it.
+
+struct ImageArenaStats
+{
+    size_t capacity;            // the cap of the arena, it never grows beyond this
+    size_t used;                // bytes handed out since the last reset
+    size_t highWaterMark;       // largest 'used' value seen on this thread
+    size_t allocations;         // allocations served by the arena
+    size_t failedAllocations;   // allocations refused because they would have exceeded the cap
+    size_t heapAllocations;     // allocations passed on to the heap because no scope was active
+    size_t resets;              // number of images (scopes) the arena was reset after
+};
+
+// default cap of every thread's arena, enough to decode a 4096 x 4096 jpeg into RGBA
+const size_t IMAGE_ARENA_DEFAULT_CAPACITY = 160 * 1024 * 1024;
+
+// sets the cap of the calling thread's arena. the memory is reserved lazily by the first scope,
+// so this has to be called before that (or between scopes, which releases the old block)
+void SetImageArenaCapacity(size_t capacity);
+
+// statistics of the calling thread's arena
+ImageArenaStats GetImageArenaStats();
+
+// highest high water mark of all threads that used an arena so far
+size_t GetImageArenaGlobalHighWaterMark();
+
+// while a scope is alive the calling thread allocates from its arena.
+// scopes may nest, the arena is reset when the outermost one ends.
+class ImageArenaScope
+{
+public:
+    ImageArenaScope();
+    ~ImageArenaScope();
+
+    ImageArenaScope(const ImageArenaScope&) = delete;
+    ImageArenaScope& operator=(const ImageArenaScope&) = delete;
+};
+
+// the hooks used by stb_image.cpp
+void* ImageArenaMalloc(size_t size);
+void* ImageArenaRealloc(void* p, size_t oldSize, size_t newSize);
+void ImageArenaFree(void* p);
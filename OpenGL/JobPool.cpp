@@ -0,0 +1,82 @@
+#include "JobPool.h"
+
+JobPool::JobPool(unsigned int threads)
+    : next_(0)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    for (unsigned int i = 1; i < threads; i++)
+        workers_.push_back(std::thread(&JobPool::workerLoop, this));
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_)
+        worker.join();
+}
+
+void JobPool::parallelFor(int count, const std::function<void(int)>& job)
+{
+    if (count <= 0)
+        return;
+    if (workers_.empty() || count == 1)
+    {
+        for (int i = 0; i < count; i++)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        count_ = count;
+        next_ = 0;
+        busyWorkers_ = workers_.size();
+        batch_++;
+    }
+    wake_.notify_all();
+
+    // the calling thread takes indices as well instead of just waiting
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busyWorkers_ == 0; });
+    job_ = nullptr;
+}
+
+void JobPool::workerLoop()
+{
+    unsigned long long lastBatch = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || batch_ != lastBatch; });
+            if (stopping_)
+                return;
+            lastBatch = batch_;
+        }
+
+        work();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busyWorkers_ == 0)
+            done_.notify_one();
+    }
+}
+
+void JobPool::work()
+{
+    for (;;)
+    {
+        int index = next_.fetch_add(1);
+        if (index >= count_)
+            return;
+        (*job_)(index);
+    }
+}
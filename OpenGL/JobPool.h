@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small fork-join pool: parallelFor hands the indices of one batch to the worker threads
+// and the calling thread, and returns once every index has been processed.
+// batches don't nest, a job must not call parallelFor of the same pool.
+class JobPool
+{
+public:
+    // threads = 0 uses one thread per hardware thread (the calling thread counts as one)
+    explicit JobPool(unsigned int threads = 0);
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // runs job(i) for every i in [0, count), in any order and on any thread of the pool
+    void parallelFor(int count, const std::function<void(int)>& job);
+
+    // number of threads working on a batch, including the calling thread
+    unsigned int threadCount() const { return (unsigned int)workers_.size() + 1; }
+
+private:
+    void workerLoop();
+    void work();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // the current batch, written under mutex_ before the workers are woken
+    const std::function<void(int)>* job_ = nullptr;
+    int count_ = 0;
+    std::atomic<int> next_;
+    size_t busyWorkers_ = 0;
+    unsigned long long batch_ = 0;
+    bool stopping_ = false;
+};
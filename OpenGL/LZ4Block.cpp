@@ -0,0 +1,175 @@
+#include "LZ4Block.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;    // the last 5 bytes of a block are always literals
+static const size_t MF_LIMIT = 12;        // the last match has to start at least 12 bytes before the end
+static const size_t MAX_OFFSET = 65535;
+static const int HASH_BITS = 16;
+
+static uint32_t Read32(const unsigned char* p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// writes the 255-byte continuation of a literal or match length
+static unsigned char* WriteLength(unsigned char* op, size_t length)
+{
+    while (length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+size_t LZ4CompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t LZ4CompressBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstCapacity)
+{
+    if (dstCapacity < LZ4CompressBound(srcSize))
+        return 0; // keeps the loop below free of output bounds checks
+
+    std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0); // position + 1, 0 = empty
+    unsigned char* op = dst;
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    if (srcSize > MF_LIMIT)
+    {
+        size_t matchLimit = srcSize - LAST_LITERALS;
+        size_t inputLimit = srcSize - MF_LIMIT;
+        while (ip < inputLimit)
+        {
+            uint32_t sequence = Read32(src + ip);
+            uint32_t hash = HashSequence(sequence);
+            size_t candidate = table[hash];
+            table[hash] = (uint32_t)(ip + 1);
+
+            if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || Read32(src + candidate - 1) != sequence)
+            {
+                ip++;
+                continue;
+            }
+            size_t reference = candidate - 1;
+
+            size_t matchLength = MIN_MATCH;
+            while (ip + matchLength < matchLimit && src[reference + matchLength] == src[ip + matchLength])
+                matchLength++;
+
+            // token, literals, offset, match length
+            size_t literalLength = ip - anchor;
+            unsigned char* token = op++;
+            *token = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+            if (literalLength >= 15)
+                op = WriteLength(op, literalLength - 15);
+            std::memcpy(op, src + anchor, literalLength);
+            op += literalLength;
+
+            size_t offset = ip - reference;
+            *op++ = (unsigned char)(offset & 0xFF);
+            *op++ = (unsigned char)(offset >> 8);
+
+            size_t storedMatch = matchLength - MIN_MATCH;
+            *token |= (unsigned char)(storedMatch >= 15 ? 15 : storedMatch);
+            if (storedMatch >= 15)
+                op = WriteLength(op, storedMatch - 15);
+
+            ip += matchLength;
+            anchor = ip;
+        }
+    }
+
+    // last literals
+    size_t literalLength = srcSize - anchor;
+    *op++ = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15)
+        op = WriteLength(op, literalLength - 15);
+    std::memcpy(op, src + anchor, literalLength);
+    op += literalLength;
+
+    return (size_t)(op - dst);
+}
+
+bool LZ4DecompressBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize)
+{
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < srcSize)
+    {
+        unsigned char token = src[ip++];
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (ip >= srcSize)
+                    return false;
+                extra = src[ip++];
+                literalLength += extra;
+            } while (extra == 255);
+        }
+        if (literalLength > srcSize - ip || literalLength > dstSize - op)
+            return false;
+        std::memcpy(dst + op, src + ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        // the last sequence has no match part
+        if (ip == srcSize)
+            break;
+
+        if (srcSize - ip < 2)
+            return false;
+        size_t offset = src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+            return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (ip >= srcSize)
+                    return false;
+                extra = src[ip++];
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > dstSize - op)
+            return false;
+
+        // matches may overlap their own output (e.g. runs), so copy byte by byte in that case
+        const unsigned char* match = dst + op - offset;
+        if (offset >= matchLength)
+        {
+            std::memcpy(dst + op, match, matchLength);
+        }
+        else
+        {
+            for (size_t i = 0; i < matchLength; i++)
+                dst[op + i] = match[i];
+        }
+        op += matchLength;
+    }
+    return op == dstSize;
+}
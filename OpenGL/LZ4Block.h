@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+
+// minimal implementation of the LZ4 block format (no frame header, no checksums),
+// compatible with LZ4_compress_default / LZ4_decompress_safe of the reference library.
+// the compressor is a simple greedy single-probe matcher: it is meant for offline packing,
+// the decompressor is the part that runs at load time.
+
+// worst case size of the compressed data for an input of the given size
+size_t LZ4CompressBound(size_t size);
+
+// returns the compressed size, 0 if the output did not fit into dstCapacity
+size_t LZ4CompressBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstCapacity);
+
+// returns false on corrupt input or if the output is not exactly dstSize bytes
+bool LZ4DecompressBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize);
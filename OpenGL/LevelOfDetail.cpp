@@ -0,0 +1,383 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "ObjLoader.h"
+#include "MeshSimplifier.h"
+
+// levels of detail built at import time and picked by their error on screen.
+//
+// usage: LevelOfDetail <file.obj>
+//
+// the mesh is simplified into up to 6 levels, every level has half the triangles of the one
+// before. a field of copies reaches from the camera far into the distance, every copy picks the
+// coarsest level whose error stays below the pixel error, with hysteresis against popping.
+// L cycles through automatic selection and every fixed level, P through pixel errors of
+// 0.5, 1, 2 and 4. every 100 frames the frame time, the triangles drawn and the copies per level
+// are printed. the fly camera works like in the camera sample.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int FIELD_COLUMNS = 8;
+const int FIELD_ROWS = 48;
+const float FIELD_SPACING = 2.5f;
+const float PIXEL_ERRORS[] = { 0.5f, 1.0f, 2.0f, 4.0f };
+const int PIXEL_ERROR_COUNT = sizeof(PIXEL_ERRORS) / sizeof(PIXEL_ERRORS[0]);
+
+glm::vec3 cameraPos = glm::vec3(0.0f, 1.5f, 5.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = SCR_WIDTH / 2.0;
+float lastY = SCR_HEIGHT / 2.0;
+float fov = 45.0f;
+
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// -1 selects by screen error, otherwise the level every copy uses
+int forcedLod = -1;
+int lodCount = 1;
+int pixelErrorIndex = 1;
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: LevelOfDetail <file.obj>" << std::endl;
+        return -1;
+    }
+
+    // load and build the levels
+    // -------------------------
+    ObjMesh mesh;
+    if (!LoadObjMesh(argv[1], mesh))
+        return -1;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MeshLod> lods = BuildMeshLods(mesh, 6, 0.5f);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (lods.empty())
+    {
+        std::cout << argv[1] << " has no triangles" << std::endl;
+        return -1;
+    }
+    lodCount = (int)lods.size();
+    std::cout << lodCount << " levels built in " << buildMs << " ms" << std::endl;
+    for (int i = 0; i < lodCount; i++)
+        std::cout << "  level " << i << ": " << lods[i].indexCount / 3 << " triangles, error " << lods[i].error << std::endl;
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // configure global opengl state
+    // -----------------------------
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        Scene scene = CreateCubeScene();
+        std::string vertexShaderPath = GetWorkingDir() + "\\Shader\\vertexMesh.shader";
+        std::string fragmentShaderPath = GetWorkingDir() + "\\Shader\\fragmentMeshLit.shader";
+        Shader ourShader(vertexShaderPath.c_str(), fragmentShaderPath.c_str());
+
+        // one vertex buffer, the levels are ranges of one element buffer
+        // --------------------------------------------------------------
+        unsigned int VBO, VAO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        GLState().bindVertexArray(VAO);
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(ObjVertex), mesh.vertices.data(), GL_STATIC_DRAW);
+        GLState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, texCoord));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, normal));
+        glEnableVertexAttribArray(2);
+
+        // scale and center the mesh into a unit cube, the level errors scale along
+        glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+        for (const ObjVertex& vertex : mesh.vertices)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                boundsMin[c] = vertex.position[c] < boundsMin[c] ? vertex.position[c] : boundsMin[c];
+                boundsMax[c] = vertex.position[c] > boundsMax[c] ? vertex.position[c] : boundsMax[c];
+            }
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        float largest = extent.x > extent.y ? extent.x : extent.y;
+        largest = largest > extent.z ? largest : extent.z;
+        float fitScale = largest > 0.0f ? 1.0f / largest : 1.0f;
+        glm::mat4 fit = glm::scale(glm::mat4(1.0f), glm::vec3(fitScale));
+        fit = glm::translate(fit, -(boundsMin + boundsMax) * 0.5f);
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        ourShader.use();
+        ourShader.setInt("ourTexture", 0);
+        ourShader.setInt("texture2", 1);
+        ourShader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.4f, -1.0f, -0.6f)));
+
+        // the field: rows of copies from the camera into the distance, each remembers its level
+        // -------------------------------------------------------------------------------------
+        std::vector<glm::vec3> objectPositions;
+        for (int row = 0; row < FIELD_ROWS; row++)
+            for (int column = 0; column < FIELD_COLUMNS; column++)
+                objectPositions.push_back(glm::vec3((column - (FIELD_COLUMNS - 1) * 0.5f) * FIELD_SPACING, 0.0f, -row * FIELD_SPACING));
+        std::vector<int> objectLods(objectPositions.size(), 0);
+
+        double frameTimeSum = 0.0;
+        long long trianglesSum = 0;
+        std::vector<long long> lodUseSum(lodCount, 0);
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            processInput(window);
+
+            glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+            glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 200.0f);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            LodSelection selection;
+            selection.fovY = glm::radians(fov);
+            selection.screenHeight = (float)SCR_HEIGHT;
+            selection.pixelError = PIXEL_ERRORS[pixelErrorIndex];
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+            ourShader.use();
+            ourShader.setMat4("view", view);
+            ourShader.setMat4("projection", projection);
+            GLState().bindVertexArray(VAO);
+
+            long long triangles = 0;
+            for (size_t i = 0; i < objectPositions.size(); i++)
+            {
+                float distance = glm::length(objectPositions[i] - cameraPos);
+                int lod = forcedLod >= 0 ? forcedLod : SelectMeshLod(lods, fitScale, distance, selection, objectLods[i]);
+                objectLods[i] = lod;
+                lodUseSum[lod]++;
+
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), objectPositions[i]);
+                model = glm::rotate(model, currentFrame * 0.3f + (float)i, glm::vec3(0.0f, 1.0f, 0.0f)) * fit;
+                ourShader.setMat4("model", model);
+                glDrawElements(GL_TRIANGLES, (GLsizei)lods[lod].indexCount, GL_UNSIGNED_INT, (void*)(lods[lod].firstIndex * sizeof(uint32_t)));
+                triangles += lods[lod].indexCount / 3;
+            }
+            glFinish();
+
+            frameTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            trianglesSum += triangles;
+            if (++framesMeasured == 100)
+            {
+                if (forcedLod >= 0)
+                    std::cout << "level " << forcedLod;
+                else
+                    std::cout << "automatic, " << PIXEL_ERRORS[pixelErrorIndex] << " pixel error";
+                std::cout << ": " << frameTimeSum / framesMeasured << " ms per frame, " << trianglesSum / framesMeasured
+                    << " triangles, copies per level";
+                for (int i = 0; i < lodCount; i++)
+                    std::cout << " " << lodUseSum[i] / framesMeasured;
+                std::cout << std::endl;
+                frameTimeSum = 0.0;
+                trianglesSum = 0;
+                std::fill(lodUseSum.begin(), lodUseSum.end(), 0);
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteBuffers(1, &EBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool lWasPressed = false;
+    bool lPressed = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+    if (lPressed && !lWasPressed)
+        forcedLod = forcedLod + 1 < lodCount ? forcedLod + 1 : -1;
+    lWasPressed = lPressed;
+
+    static bool pWasPressed = false;
+    bool pPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+    if (pPressed && !pWasPressed)
+        pixelErrorIndex = (pixelErrorIndex + 1) % PIXEL_ERROR_COUNT;
+    pWasPressed = pPressed;
+
+    float cameraSpeed = 5.0f * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // to avoid a camera jump causing by mouse focus on game start
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+    lastX = xpos;
+    lastY = ypos;
+
+    const float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
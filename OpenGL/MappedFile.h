@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// read-only memory mapping of a whole file.
+// pages are only read from disk when they are touched, so probing a file header
+// through a mapping costs one or two page faults instead of a full read.
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // maps the file, returns false if it can't be opened or is empty
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
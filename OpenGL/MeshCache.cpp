@@ -0,0 +1,425 @@
+#include "MeshCache.h"
+#include "HalfFloat.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+
+#include <sys/stat.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static const char MESH_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+// version 2: meshes cooked by LoadOrCookMesh have optimized index and vertex orders
+static const uint32_t MESH_VERSION = 2;
+
+enum MeshFlags
+{
+    MESH_HALF_TEXCOORDS = 1
+};
+
+struct MeshHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t stride;
+    uint32_t indexType;
+    float positionScale[3];
+    float positionOffset[3];
+    uint64_t sourceSize;
+    uint64_t sourceTime;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+
+// the 16 byte vertex of the quantized formats
+struct QuantizedVertex
+{
+    uint16_t position[4];       // unorm16 or half, the fourth value is padding
+    uint16_t texCoord[2];       // unorm16 or half
+    int16_t normal[2];          // octahedral snorm16
+};
+
+static_assert(sizeof(MeshHeader) == 88, "mesh header layout changed");
+static_assert(sizeof(QuantizedVertex) == 16, "quantized vertex layout changed");
+static_assert(sizeof(ObjVertex) == 32, "float vertex layout changed");
+
+static const uint64_t MESH_DATA_ALIGNMENT = 16;
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + MESH_DATA_ALIGNMENT - 1) / MESH_DATA_ALIGNMENT * MESH_DATA_ALIGNMENT;
+}
+
+// size and modification time of the OBJ, both 0 if it doesn't exist
+static void SourceStamp(const std::string& path, uint64_t& size, uint64_t& time)
+{
+    struct stat info;
+    if (path.empty() || stat(path.c_str(), &info) != 0)
+    {
+        size = 0;
+        time = 0;
+        return;
+    }
+    size = (uint64_t)info.st_size;
+    time = (uint64_t)info.st_mtime;
+}
+
+static uint16_t QuantizeUnorm16(float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+    if (value >= 1.0f)
+        return 65535;
+    return (uint16_t)(value * 65535.0f + 0.5f);
+}
+
+static float SignNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static int16_t ClampSnorm16(float value)
+{
+    if (value >= 32767.0f)
+        return 32767;
+    if (value <= -32767.0f)
+        return -32767;
+    return (int16_t)value;
+}
+
+glm::vec3 DecodeOctahedral(const int16_t encoded[2])
+{
+    // the GL 4.2 snorm rule, -32768 and -32767 both become -1
+    float x = encoded[0] < -32767 ? -1.0f : encoded[0] / 32767.0f;
+    float y = encoded[1] < -32767 ? -1.0f : encoded[1] / 32767.0f;
+    glm::vec3 n(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+    if (n.z < 0.0f)
+    {
+        float foldedX = (1.0f - std::fabs(n.y)) * SignNotZero(n.x);
+        float foldedY = (1.0f - std::fabs(n.x)) * SignNotZero(n.y);
+        n.x = foldedX;
+        n.y = foldedY;
+    }
+    return glm::normalize(n);
+}
+
+void EncodeOctahedral(const glm::vec3& normal, int16_t encoded[2])
+{
+    float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (length == 0.0f)
+    {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+
+    // project onto the octahedron and fold the lower half over the diagonals
+    float x = normal.x / length;
+    float y = normal.y / length;
+    if (normal.z < 0.0f)
+    {
+        float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+        float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    // rounding to the nearest code is not the nearest direction after the decode, so all four
+    // neighbouring codes are tried and the one closest to the normal is kept
+    glm::vec3 unit = glm::normalize(normal);
+    float baseX = std::floor(x * 32767.0f);
+    float baseY = std::floor(y * 32767.0f);
+    float bestDot = -2.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        int16_t candidate[2] = { ClampSnorm16(baseX + (i & 1)), ClampSnorm16(baseY + (i >> 1)) };
+        float d = glm::dot(DecodeOctahedral(candidate), unit);
+        if (d > bestDot)
+        {
+            bestDot = d;
+            encoded[0] = candidate[0];
+            encoded[1] = candidate[1];
+        }
+    }
+}
+
+bool CookedMesh::open(const std::string& path)
+{
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(MeshHeader))
+    {
+        close();
+        return false;
+    }
+
+    MeshHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    uint64_t indexSize = header.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    if (std::memcmp(header.magic, MESH_MAGIC, sizeof(header.magic)) != 0 || header.version != MESH_VERSION
+        || header.format > MESH_VERTEX_HALF
+        || header.vertexOffset + (uint64_t)header.vertexCount * header.stride > file_.size()
+        || header.indexOffset + header.indexCount * indexSize > file_.size())
+    {
+        std::cout << "ERROR::MESHCACHE::INVALID_MESH " << path << std::endl;
+        close();
+        return false;
+    }
+
+    format_ = (MeshVertexFormat)header.format;
+    halfTexCoords_ = (header.flags & MESH_HALF_TEXCOORDS) != 0;
+    vertexCount_ = header.vertexCount;
+    indexCount_ = header.indexCount;
+    stride_ = (GLsizei)header.stride;
+    indexType_ = (GLenum)header.indexType;
+    vertices_ = file_.data() + header.vertexOffset;
+    indices_ = file_.data() + header.indexOffset;
+    sourceSize_ = header.sourceSize;
+    sourceTime_ = header.sourceTime;
+    positionScale_ = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+    positionOffset_ = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+    return true;
+}
+
+void CookedMesh::close()
+{
+    file_.close();
+    vertices_ = nullptr;
+    indices_ = nullptr;
+    vertexCount_ = 0;
+    indexCount_ = 0;
+    sourceSize_ = 0;
+    sourceTime_ = 0;
+}
+
+bool CookedMesh::isCookedFrom(const std::string& sourcePath) const
+{
+    uint64_t size, time;
+    SourceStamp(sourcePath, size, time);
+    return isOpen() && size == sourceSize_ && time == sourceTime_;
+}
+
+VertexLayout CookedMesh::vertexLayout() const
+{
+    VertexLayout layout(stride_);
+    if (format_ == MESH_VERTEX_FLOAT)
+    {
+        layout.add("aPos", 3, GL_FLOAT, offsetof(ObjVertex, position));
+        layout.add("aTexCoord", 2, GL_FLOAT, offsetof(ObjVertex, texCoord));
+        layout.add("aNormal", 3, GL_FLOAT, offsetof(ObjVertex, normal));
+        return layout;
+    }
+
+    if (format_ == MESH_VERTEX_UNORM16)
+        layout.add("aPos", 3, GL_UNSIGNED_SHORT, offsetof(QuantizedVertex, position), true);
+    else
+        layout.add("aPos", 3, GL_HALF_FLOAT, offsetof(QuantizedVertex, position));
+    if (halfTexCoords_)
+        layout.add("aTexCoord", 2, GL_HALF_FLOAT, offsetof(QuantizedVertex, texCoord));
+    else
+        layout.add("aTexCoord", 2, GL_UNSIGNED_SHORT, offsetof(QuantizedVertex, texCoord), true);
+    layout.add("aNormal", 2, GL_SHORT, offsetof(QuantizedVertex, normal), true);
+    return layout;
+}
+
+void CookedMesh::decodeVertex(uint32_t i, glm::vec3& position, glm::vec2& texCoord, glm::vec3& normal) const
+{
+    const unsigned char* data = vertices_ + (size_t)i * stride_;
+    if (format_ == MESH_VERTEX_FLOAT)
+    {
+        ObjVertex vertex;
+        std::memcpy(&vertex, data, sizeof(vertex));
+        position = glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+        texCoord = glm::vec2(vertex.texCoord[0], vertex.texCoord[1]);
+        normal = glm::vec3(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+        return;
+    }
+
+    QuantizedVertex vertex;
+    std::memcpy(&vertex, data, sizeof(vertex));
+    glm::vec3 attribute;
+    for (int c = 0; c < 3; c++)
+        attribute[c] = format_ == MESH_VERTEX_UNORM16 ? vertex.position[c] / 65535.0f : HalfToFloat(vertex.position[c]);
+    position = attribute * positionScale_ + positionOffset_;
+    for (int c = 0; c < 2; c++)
+        texCoord[c] = halfTexCoords_ ? HalfToFloat(vertex.texCoord[c]) : vertex.texCoord[c] / 65535.0f;
+    normal = DecodeOctahedral(vertex.normal);
+}
+
+bool CookMesh(const ObjMesh& mesh, MeshVertexFormat format, const std::string& path, const std::string& sourcePath)
+{
+    MeshHeader header = {};
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(header.magic));
+    header.version = MESH_VERSION;
+    header.format = format;
+    header.vertexCount = (uint32_t)mesh.vertices.size();
+    header.indexCount = (uint32_t)mesh.indices.size();
+    header.stride = format == MESH_VERTEX_FLOAT ? sizeof(ObjVertex) : sizeof(QuantizedVertex);
+    header.indexType = mesh.vertices.size() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    SourceStamp(sourcePath, header.sourceSize, header.sourceTime);
+
+    glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+    bool texCoordsInUnitRange = true;
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        const ObjVertex& vertex = mesh.vertices[i];
+        for (int c = 0; c < 3; c++)
+        {
+            if (i == 0 || vertex.position[c] < boundsMin[c])
+                boundsMin[c] = vertex.position[c];
+            if (i == 0 || vertex.position[c] > boundsMax[c])
+                boundsMax[c] = vertex.position[c];
+        }
+        for (int c = 0; c < 2; c++)
+            texCoordsInUnitRange = texCoordsInUnitRange && vertex.texCoord[c] >= 0.0f && vertex.texCoord[c] <= 1.0f;
+    }
+    if (!texCoordsInUnitRange)
+        header.flags |= MESH_HALF_TEXCOORDS;
+
+    // unorm16 spans the bounds, half is centered in them to keep the values small and precise
+    glm::vec3 scale(1.0f), offset(0.0f);
+    if (format == MESH_VERTEX_UNORM16)
+    {
+        scale = boundsMax - boundsMin;
+        offset = boundsMin;
+    }
+    else if (format == MESH_VERTEX_HALF)
+    {
+        offset = (boundsMin + boundsMax) * 0.5f;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        header.positionScale[c] = scale[c];
+        header.positionOffset[c] = offset[c];
+    }
+
+    std::vector<unsigned char> vertices((size_t)header.vertexCount * header.stride);
+    if (format == MESH_VERTEX_FLOAT)
+    {
+        if (!mesh.vertices.empty())
+            std::memcpy(vertices.data(), mesh.vertices.data(), vertices.size());
+    }
+    else
+    {
+        QuantizedVertex* quantized = (QuantizedVertex*)vertices.data();
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            const ObjVertex& vertex = mesh.vertices[i];
+            QuantizedVertex& q = quantized[i];
+            for (int c = 0; c < 3; c++)
+            {
+                float p = vertex.position[c] - offset[c];
+                if (format == MESH_VERTEX_UNORM16)
+                    q.position[c] = QuantizeUnorm16(scale[c] > 0.0f ? p / scale[c] : 0.0f);
+                else
+                    q.position[c] = FloatToHalf(p);
+            }
+            q.position[3] = 0;
+            for (int c = 0; c < 2; c++)
+                q.texCoord[c] = texCoordsInUnitRange ? QuantizeUnorm16(vertex.texCoord[c]) : FloatToHalf(vertex.texCoord[c]);
+            EncodeOctahedral(glm::vec3(vertex.normal[0], vertex.normal[1], vertex.normal[2]), q.normal);
+        }
+    }
+
+    std::vector<unsigned char> indices;
+    if (header.indexType == GL_UNSIGNED_SHORT)
+    {
+        indices.resize(mesh.indices.size() * sizeof(uint16_t));
+        uint16_t* shortIndices = (uint16_t*)indices.data();
+        for (size_t i = 0; i < mesh.indices.size(); i++)
+            shortIndices[i] = (uint16_t)mesh.indices[i];
+    }
+    else
+    {
+        indices.resize(mesh.indices.size() * sizeof(uint32_t));
+        if (!mesh.indices.empty())
+            std::memcpy(indices.data(), mesh.indices.data(), indices.size());
+    }
+
+    header.vertexOffset = AlignOffset(sizeof(header));
+    header.indexOffset = AlignOffset(header.vertexOffset + vertices.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::MESHCACHE::FILE_NOT_WRITTEN " << path << std::endl;
+        return false;
+    }
+    static const char zeros[MESH_DATA_ALIGNMENT] = {};
+    out.write((const char*)&header, sizeof(header));
+    out.write(zeros, (std::streamsize)(header.vertexOffset - sizeof(header)));
+    out.write((const char*)vertices.data(), (std::streamsize)vertices.size());
+    out.write(zeros, (std::streamsize)(header.indexOffset - header.vertexOffset - vertices.size()));
+    out.write((const char*)indices.data(), (std::streamsize)indices.size());
+    if (!out)
+    {
+        std::cout << "ERROR::MESHCACHE::FILE_NOT_WRITTEN " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LoadOrCookMesh(const std::string& cachePath, const std::string& objPath, MeshVertexFormat format, CookedMesh& mesh)
+{
+    if (mesh.open(cachePath) && mesh.format() == format && mesh.isCookedFrom(objPath))
+        return true;
+    mesh.close();
+
+    ObjMesh source;
+    if (!LoadObjMesh(objPath, source))
+        return false;
+    OptimizeObjMesh(source);
+    if (!CookMesh(source, format, cachePath, objPath))
+        return false;
+    return mesh.open(cachePath);
+}
+
+MeshQuantizationError MeasureQuantizationError(const CookedMesh& reference, const CookedMesh& cooked)
+{
+    MeshQuantizationError error;
+    if (cooked.vertexCount() != reference.vertexCount() || cooked.vertexCount() == 0)
+        return error;
+
+    double positionSum = 0.0, normalSum = 0.0;
+    size_t normalCount = 0;
+    for (uint32_t i = 0; i < cooked.vertexCount(); i++)
+    {
+        glm::vec3 sourcePosition, sourceNormal, position, normal;
+        glm::vec2 sourceTexCoord, texCoord;
+        reference.decodeVertex(i, sourcePosition, sourceTexCoord, sourceNormal);
+        cooked.decodeVertex(i, position, texCoord, normal);
+
+        float positionError = glm::length(position - sourcePosition);
+        positionSum += positionError;
+        if (positionError > error.maxPosition)
+            error.maxPosition = positionError;
+
+        for (int c = 0; c < 2; c++)
+        {
+            float texCoordError = std::fabs(texCoord[c] - sourceTexCoord[c]);
+            if (texCoordError > error.maxTexCoord)
+                error.maxTexCoord = texCoordError;
+        }
+
+        // meshes without normals have zero normals, there is nothing to compare
+        if (glm::dot(sourceNormal, sourceNormal) > 0.0f && glm::dot(normal, normal) > 0.0f)
+        {
+            // atan2 instead of acos, which has no precision left for angles close to 0
+            float degrees = glm::degrees(std::atan2(glm::length(glm::cross(sourceNormal, normal)), glm::dot(sourceNormal, normal)));
+            normalSum += degrees;
+            normalCount++;
+            if (degrees > error.maxNormalDegrees)
+                error.maxNormalDegrees = degrees;
+        }
+    }
+    error.meanPosition = (float)(positionSum / cooked.vertexCount());
+    error.meanNormalDegrees = normalCount > 0 ? (float)(normalSum / normalCount) : 0.0f;
+    return error;
+}
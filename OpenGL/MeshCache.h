@@ -0,0 +1,107 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+#include "PipelineBuilder.h"
+
+struct ObjMesh;
+
+// vertex layouts of a cooked mesh, attributes aPos, aTexCoord and aNormal
+//
+//   MESH_VERTEX_FLOAT    3 float position, 2 float uv, 3 float normal                      32 bytes
+//   MESH_VERTEX_UNORM16  3 unorm16 position in the bounds (+ padding), 2 x 16 bit uv,
+//                        2 snorm16 octahedral normal                                       16 bytes
+//   MESH_VERTEX_HALF     3 half position relative to the bounds center (+ padding),
+//                        2 x 16 bit uv, 2 snorm16 octahedral normal                        16 bytes
+//
+// the 16 bit uvs are unorm16 when all of them are in [0, 1], half floats otherwise (repeating
+// textures). the quantized positions are brought back with positionScale/positionOffset, the
+// normals with the octahedral decode in Shader/octahedral.glsl.
+enum MeshVertexFormat
+{
+    MESH_VERTEX_FLOAT,
+    MESH_VERTEX_UNORM16,
+    MESH_VERTEX_HALF
+};
+
+// memory mapped cooked mesh. the vertex and index data are stored in their GL layout, so they
+// go from the mapping into glBufferData without any conversion.
+//
+//     header      magic "MESH", version, format, counts, bounds, size and time of the source file
+//     vertices    at a 16 byte aligned offset
+//     indices     GL_UNSIGNED_SHORT if there are at most 65536 vertices, GL_UNSIGNED_INT otherwise
+class CookedMesh
+{
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return vertices_ != nullptr; }
+
+    MeshVertexFormat format() const { return format_; }
+    uint32_t vertexCount() const { return vertexCount_; }
+    uint32_t indexCount() const { return indexCount_; }
+    GLsizei vertexStride() const { return stride_; }
+    GLenum indexType() const { return indexType_; }
+    size_t vertexBytes() const { return (size_t)vertexCount_ * stride_; }
+    size_t indexBytes() const { return (size_t)indexCount_ * (indexType_ == GL_UNSIGNED_SHORT ? 2 : 4); }
+    const void* vertices() const { return vertices_; }
+    const void* indices() const { return indices_; }
+    // true if the OBJ still has the size and modification time it had when the mesh was cooked
+    bool isCookedFrom(const std::string& sourcePath) const;
+
+    // object space position = attribute * positionScale + positionOffset
+    glm::vec3 positionScale() const { return positionScale_; }
+    glm::vec3 positionOffset() const { return positionOffset_; }
+
+    // aPos, aTexCoord and aNormal in the format of the file, for PipelineBuilder
+    VertexLayout vertexLayout() const;
+
+    // the attributes of vertex i decoded on the CPU, for error measurements
+    void decodeVertex(uint32_t i, glm::vec3& position, glm::vec2& texCoord, glm::vec3& normal) const;
+
+private:
+    MappedFile file_;
+    MeshVertexFormat format_ = MESH_VERTEX_FLOAT;
+    bool halfTexCoords_ = false;
+    uint32_t vertexCount_ = 0;
+    uint32_t indexCount_ = 0;
+    GLsizei stride_ = 0;
+    GLenum indexType_ = GL_UNSIGNED_INT;
+    const unsigned char* vertices_ = nullptr;
+    const unsigned char* indices_ = nullptr;
+    uint64_t sourceSize_ = 0;
+    uint64_t sourceTime_ = 0;
+    glm::vec3 positionScale_ = glm::vec3(1.0f);
+    glm::vec3 positionOffset_ = glm::vec3(0.0f);
+};
+
+// writes the mesh in the given format, false on write errors. sourcePath is the OBJ the mesh was
+// loaded from, for the staleness check of LoadOrCookMesh.
+bool CookMesh(const ObjMesh& mesh, MeshVertexFormat format, const std::string& path, const std::string& sourcePath = "");
+
+// opens the cooked mesh, or loads the OBJ and cooks it first if there is no cache for it yet
+// or the OBJ changed since the cache was cooked. the OBJ goes through OptimizeObjMesh before
+// cooking, the cached mesh has vertex cache, overdraw and vertex fetch optimized orders.
+bool LoadOrCookMesh(const std::string& cachePath, const std::string& objPath, MeshVertexFormat format, CookedMesh& mesh);
+
+// differences between a float mesh and a quantized cooking of the same mesh
+struct MeshQuantizationError
+{
+    float maxPosition = 0.0f;       // object space units
+    float meanPosition = 0.0f;
+    float maxTexCoord = 0.0f;
+    float maxNormalDegrees = 0.0f;
+    float meanNormalDegrees = 0.0f;
+};
+
+// reference is the MESH_VERTEX_FLOAT cooking, which has the OBJ values unchanged. CookMesh keeps
+// the vertex order, so the vertices are compared one by one.
+MeshQuantizationError MeasureQuantizationError(const CookedMesh& reference, const CookedMesh& cooked);
+
+// octahedral normal encoding in two snorm16, exposed for the error report
+void EncodeOctahedral(const glm::vec3& normal, int16_t encoded[2]);
+glm::vec3 DecodeOctahedral(const int16_t encoded[2]);
@@ -0,0 +1,262 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+#include "Scene.h"
+#include "MeshCache.h"
+#include "ShaderVariantCache.h"
+#include "PipelineBuilder.h"
+
+// binary mesh cache with quantized vertex formats.
+//
+// usage: MeshCooking <file.obj>
+//
+// the OBJ is cooked into <file.obj>.float.mesh, .unorm16.mesh and .half.mesh on the first run, or
+// when it changed; later runs map the caches directly. the sizes of the three formats and the
+// error of the quantized ones against the float one are printed, then the mesh is drawn with
+// normals and the textures of the camera sample. Q cycles through the formats, the frame times
+// are printed every 100 frames.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int FORMAT_COUNT = 3;
+const char* const FORMAT_NAMES[FORMAT_COUNT] = { "float", "unorm16", "half" };
+int currentFormat = MESH_VERTEX_UNORM16;
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: MeshCooking <file.obj>" << std::endl;
+        return -1;
+    }
+    std::string objPath = argv[1];
+
+    // cook or map the three formats
+    // -----------------------------
+    CookedMesh meshes[FORMAT_COUNT];
+    for (int format = 0; format < FORMAT_COUNT; format++)
+    {
+        std::string cachePath = objPath + "." + FORMAT_NAMES[format] + ".mesh";
+        auto start = std::chrono::steady_clock::now();
+        if (!LoadOrCookMesh(cachePath, objPath, (MeshVertexFormat)format, meshes[format]))
+            return -1;
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << cachePath << " ready in " << milliseconds << " ms" << std::endl;
+    }
+
+    // memory and the error the quantization costs
+    // -------------------------------------------
+    const CookedMesh& reference = meshes[MESH_VERTEX_FLOAT];
+    size_t referenceBytes = reference.vertexBytes() + reference.indexBytes();
+    std::cout << reference.vertexCount() << " vertices, " << reference.indexCount() / 3 << " triangles" << std::endl;
+    for (int format = 0; format < FORMAT_COUNT; format++)
+    {
+        const CookedMesh& mesh = meshes[format];
+        size_t bytes = mesh.vertexBytes() + mesh.indexBytes();
+        std::cout << "  " << FORMAT_NAMES[format] << ": " << mesh.vertexStride() << " byte vertices, "
+            << (mesh.indexType() == GL_UNSIGNED_SHORT ? 16 : 32) << " bit indices, " << bytes / 1024 << " KB ("
+            << 100.0 - 100.0 * bytes / referenceBytes << "% saved)" << std::endl;
+        if (format == MESH_VERTEX_FLOAT)
+            continue;
+        MeshQuantizationError error = MeasureQuantizationError(reference, mesh);
+        std::cout << "    position error max " << error.maxPosition << " mean " << error.meanPosition
+            << ", uv error max " << error.maxTexCoord << ", normal error max " << error.maxNormalDegrees
+            << " mean " << error.meanNormalDegrees << " degrees" << std::endl;
+    }
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        Scene scene = CreateCubeScene();
+        std::string vertexShaderPath = GetWorkingDir() + "\\Shader\\vertexMesh.shader";
+        std::string fragmentShaderPath = GetWorkingDir() + "\\Shader\\fragmentMeshLit.shader";
+        ShaderVariantCache meshShaders(vertexShaderPath, fragmentShaderPath, { "QUANTIZED_VERTEX" });
+        uint32_t quantizedKey = meshShaders.feature("QUANTIZED_VERTEX");
+
+        // buffers per format, the cooked data goes from the mapping straight into them
+        // ---------------------------------------------------------------------------
+        // created without touching the element array binding, which belongs to a vertex array
+        unsigned int VBOs[FORMAT_COUNT], EBOs[FORMAT_COUNT];
+        for (int format = 0; format < FORMAT_COUNT; format++)
+        {
+            const CookedMesh& mesh = meshes[format];
+            VBOs[format] = CreateBuffer((GLsizeiptr)mesh.vertexBytes(), mesh.vertices());
+            EBOs[format] = CreateBuffer((GLsizeiptr)mesh.indexBytes(), mesh.indices());
+        }
+
+        // scale and center the mesh into a unit cube, the unorm16 cooking has the bounds
+        glm::vec3 extent = meshes[MESH_VERTEX_UNORM16].positionScale();
+        glm::vec3 boundsMin = meshes[MESH_VERTEX_UNORM16].positionOffset();
+        float largest = extent.x > extent.y ? extent.x : extent.y;
+        largest = largest > extent.z ? largest : extent.z;
+        glm::mat4 fit = glm::scale(glm::mat4(1.0f), glm::vec3(largest > 0.0f ? 1.0f / largest : 1.0f));
+        fit = glm::translate(fit, -(boundsMin + extent * 0.5f));
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+
+        // one pipeline per format, the vertex arrays come from the layouts of the cooked files and
+        // the reflected inputs of the shader variant
+        // -----------------------------------------------------------------------------------------
+        std::unique_ptr<Pipeline> pipelines[FORMAT_COUNT];
+        for (int format = 0; format < FORMAT_COUNT; format++)
+        {
+            Shader& shader = meshShaders.get(format == MESH_VERTEX_FLOAT ? 0 : quantizedKey);
+            pipelines[format].reset(new Pipeline(PipelineBuilder(shader)
+                .vertexBuffer(VBOs[format], meshes[format].vertexLayout())
+                .indexBuffer(EBOs[format])
+                .texture("ourTexture", GL_TEXTURE_2D, textures[0], sampler)
+                .texture("texture2", GL_TEXTURE_2D, textures[1], sampler)));
+            shader.set("lightDirection"_u, glm::normalize(glm::vec3(-0.4f, -1.0f, -0.6f)));
+        }
+
+        double frameTimeSum = 0.0;
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            const CookedMesh& mesh = meshes[currentFormat];
+            const Pipeline& pipeline = *pipelines[currentFormat];
+            Shader& shader = pipeline.shader();
+            pipeline.bind();
+
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), (float)glfwGetTime() * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)) * fit;
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.5f, 1.8f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.01f, 100.0f);
+            shader.set("model"_u, model);
+            shader.set("view"_u, view);
+            shader.set("projection"_u, projection);
+            if (currentFormat != MESH_VERTEX_FLOAT)
+            {
+                shader.set("positionScale"_u, mesh.positionScale());
+                shader.set("positionOffset"_u, mesh.positionOffset());
+            }
+
+            glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indexCount(), mesh.indexType(), 0);
+            glFinish();
+
+            // every vertex is fetched at least once a frame, so the buffer sizes are the least
+            // vertex and index bandwidth of a frame
+            frameTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (++framesMeasured == 100)
+            {
+                std::cout << FORMAT_NAMES[currentFormat] << ": " << frameTimeSum / framesMeasured << " ms per frame, "
+                    << (mesh.vertexBytes() + mesh.indexBytes()) / 1024 << " KB of vertices and indices" << std::endl;
+                frameTimeSum = 0.0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteBuffers(FORMAT_COUNT, VBOs);
+        GLState().deleteBuffers(FORMAT_COUNT, EBOs);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool qWasPressed = false;
+    bool qPressed = glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS;
+    if (qPressed && !qWasPressed)
+    {
+        currentFormat = (currentFormat + 1) % FORMAT_COUNT;
+        std::cout << "drawing the " << FORMAT_NAMES[currentFormat] << " vertices" << std::endl;
+    }
+    qWasPressed = qPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
@@ -0,0 +1,306 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLQueries.h"
+#include "Scene.h"
+#include "ObjLoader.h"
+#include "MeshOptimizer.h"
+
+// index and vertex buffer optimization benchmark.
+//
+// usage: MeshOptimization <file.obj> [shuffle]
+//
+// the mesh runs through OptimizeVertexCache, OptimizeOverdraw and OptimizeVertexFetch, the ACMR
+// and ATVR of a 16 and a 32 entry FIFO cache and the vertex fetch overfetch are printed after every
+// pass. shuffle puts the triangles into random order first, like a careless exporter would.
+// the original and the optimized mesh are drawn, O switches between them. every 100 frames the
+// frame time, the vertex shader invocations (GL_ARB_pipeline_statistics_query, if the driver has
+// it) and the samples passed are printed.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+bool drawOptimized = true;
+
+static void PrintStats(const char* stage, const ObjMesh& mesh, double milliseconds)
+{
+    VertexCacheStats cache16 = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), 16);
+    VertexCacheStats cache32 = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), 32);
+    float overfetch = AnalyzeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), sizeof(ObjVertex));
+    std::cout << "  " << stage << ": ACMR " << cache16.acmr << " / " << cache32.acmr << ", ATVR " << cache16.atvr << " / " << cache32.atvr
+        << ", overfetch " << overfetch << " (" << milliseconds << " ms)" << std::endl;
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// vertex array with the float ObjVertex layout, attribute 0 position, 1 texture coordinate, 2 normal
+static void CreateMeshBuffers(const ObjMesh& mesh, unsigned int& VAO, unsigned int& VBO, unsigned int& EBO)
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    GLState().bindVertexArray(VAO);
+    GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(ObjVertex), mesh.vertices.data(), GL_STATIC_DRAW);
+    GLState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, texCoord));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)offsetof(ObjVertex, normal));
+    glEnableVertexAttribArray(2);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: MeshOptimization <file.obj> [shuffle]" << std::endl;
+        return -1;
+    }
+
+    // load and optimize
+    // -----------------
+    ObjMesh original;
+    if (!LoadObjMesh(argv[1], original))
+        return -1;
+    if (original.indices.empty())
+    {
+        std::cout << argv[1] << " has no triangles" << std::endl;
+        return -1;
+    }
+    if (argc > 2 && std::string(argv[2]) == "shuffle")
+    {
+        std::vector<uint32_t> triangles(original.indices.size() / 3);
+        for (size_t i = 0; i < triangles.size(); i++)
+            triangles[i] = (uint32_t)i;
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+        std::vector<uint32_t> shuffled(triangles.size() * 3);
+        for (size_t i = 0; i < triangles.size(); i++)
+            for (int k = 0; k < 3; k++)
+                shuffled[i * 3 + k] = original.indices[triangles[i] * 3 + k];
+        original.indices.swap(shuffled);
+    }
+    std::cout << original.vertices.size() << " vertices, " << original.indices.size() / 3 << " triangles, "
+        << "cache sizes 16 / 32" << std::endl;
+    PrintStats("original", original, 0.0);
+
+    ObjMesh optimized = original;
+    auto start = std::chrono::steady_clock::now();
+    OptimizeVertexCache(optimized.indices.data(), optimized.indices.size(), optimized.vertices.size());
+    PrintStats("vertex cache", optimized, MillisecondsSince(start));
+    start = std::chrono::steady_clock::now();
+    OptimizeOverdraw(optimized.indices.data(), optimized.indices.size(), optimized.vertices[0].position, sizeof(ObjVertex), optimized.vertices.size());
+    PrintStats("overdraw", optimized, MillisecondsSince(start));
+    start = std::chrono::steady_clock::now();
+    size_t used = OptimizeVertexFetch(optimized.vertices.data(), optimized.vertices.size(), sizeof(ObjVertex), optimized.indices.data(), optimized.indices.size());
+    optimized.vertices.resize(used);
+    PrintStats("vertex fetch", optimized, MillisecondsSince(start));
+
+    size_t originalMisses = AnalyzeVertexCache(original.indices.data(), original.indices.size(), original.vertices.size()).misses;
+    size_t optimizedMisses = AnalyzeVertexCache(optimized.indices.data(), optimized.indices.size(), optimized.vertices.size()).misses;
+    std::cout << "expected vertex shader invocations per draw: " << originalMisses << " -> " << optimizedMisses << std::endl;
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        Scene scene = CreateCubeScene();
+        std::string vertexShaderPath = GetWorkingDir() + "\\Shader\\vertexMesh.shader";
+        std::string fragmentShaderPath = GetWorkingDir() + "\\Shader\\fragmentMeshLit.shader";
+        Shader ourShader(vertexShaderPath.c_str(), fragmentShaderPath.c_str());
+
+        unsigned int VAOs[2], VBOs[2], EBOs[2];
+        CreateMeshBuffers(original, VAOs[0], VBOs[0], EBOs[0]);
+        CreateMeshBuffers(optimized, VAOs[1], VBOs[1], EBOs[1]);
+
+        // scale and center the mesh into a unit cube
+        glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+        for (const ObjVertex& vertex : optimized.vertices)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                boundsMin[c] = vertex.position[c] < boundsMin[c] ? vertex.position[c] : boundsMin[c];
+                boundsMax[c] = vertex.position[c] > boundsMax[c] ? vertex.position[c] : boundsMax[c];
+            }
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        float largest = extent.x > extent.y ? extent.x : extent.y;
+        largest = largest > extent.z ? largest : extent.z;
+        glm::mat4 fit = glm::scale(glm::mat4(1.0f), glm::vec3(largest > 0.0f ? 1.0f / largest : 1.0f));
+        fit = glm::translate(fit, -(boundsMin + boundsMax) * 0.5f);
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        ourShader.use();
+        ourShader.setInt("ourTexture", 0);
+        ourShader.setInt("texture2", 1);
+        ourShader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.4f, -1.0f, -0.6f)));
+
+        // only where the context has pipeline statistics queries
+        std::unique_ptr<QueryCounter> vertexInvocations;
+        if (HasPipelineStatistics())
+            vertexInvocations.reset(new QueryCounter(GL_VERTEX_SHADER_INVOCATIONS));
+        SamplesPassedCounter samplesPassed;
+        if (vertexInvocations == nullptr)
+            std::cout << "no GL_ARB_pipeline_statistics_query, the vertex shader invocations are not measured" << std::endl;
+
+        double frameTimeSum = 0.0;
+        int framesMeasured = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+            ourShader.use();
+
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), (float)glfwGetTime() * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)) * fit;
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.5f, 1.8f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.01f, 100.0f);
+            ourShader.setMat4("model", model);
+            ourShader.setMat4("view", view);
+            ourShader.setMat4("projection", projection);
+
+            const ObjMesh& mesh = drawOptimized ? optimized : original;
+            GLState().bindVertexArray(VAOs[drawOptimized ? 1 : 0]);
+            if (vertexInvocations)
+                vertexInvocations->begin();
+            samplesPassed.begin();
+            glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+            samplesPassed.end();
+            if (vertexInvocations)
+                vertexInvocations->end();
+            glFinish();
+
+            frameTimeSum += MillisecondsSince(frameStart);
+            if (++framesMeasured == 100)
+            {
+                std::cout << (drawOptimized ? "optimized" : "original") << ": " << frameTimeSum / framesMeasured << " ms per frame";
+                GLuint64 count = 0;
+                if (vertexInvocations && vertexInvocations->latest(count))
+                    std::cout << ", " << count << " vertex shader invocations";
+                if (samplesPassed.latest(count))
+                    std::cout << ", " << count << " samples passed";
+                std::cout << std::endl;
+                frameTimeSum = 0.0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(2, VAOs);
+        GLState().deleteBuffers(2, VBOs);
+        GLState().deleteBuffers(2, EBOs);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool oWasPressed = false;
+    bool oPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+    if (oPressed && !oWasPressed)
+        drawOptimized = !drawOptimized;
+    oWasPressed = oPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
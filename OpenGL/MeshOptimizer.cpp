@@ -0,0 +1,392 @@
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// FIFO post-transform cache: a vertex is in the cache while fewer than cacheSize misses happened
+// since it was transformed. advancing the time by cacheSize + 1 empties the cache.
+class FifoCache
+{
+public:
+    FifoCache(size_t vertexCount, unsigned int cacheSize)
+        : timestamps_(vertexCount, 0), cacheSize_(cacheSize), time_(cacheSize + 1)
+    {
+    }
+
+    // 1 if the vertex had to be transformed
+    unsigned int access(uint32_t vertex)
+    {
+        if (time_ - timestamps_[vertex] <= cacheSize_)
+            return 0;
+        timestamps_[vertex] = time_++;
+        return 1;
+    }
+
+    unsigned int accessTriangle(const uint32_t* triangle)
+    {
+        return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+
+    void flush()
+    {
+        time_ += cacheSize_ + 1;
+    }
+
+private:
+    std::vector<size_t> timestamps_;
+    size_t cacheSize_;
+    size_t time_;
+};
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+    VertexCacheStats stats;
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    size_t usedCount = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        stats.misses += cache.access(indices[i]);
+        if (!used[indices[i]])
+        {
+            used[indices[i]] = true;
+            usedCount++;
+        }
+    }
+    if (indexCount >= 3)
+        stats.acmr = (float)stats.misses / (float)(indexCount / 3);
+    if (usedCount > 0)
+        stats.atvr = (float)stats.misses / (float)usedCount;
+    return stats;
+}
+
+float AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+    // direct mapped, every line remembers the address it holds
+    const size_t LINE_SIZE = 64;
+    const size_t LINE_COUNT = 256;
+    std::vector<size_t> lines(LINE_COUNT, (size_t)-1);
+    std::vector<bool> used(vertexCount, false);
+    size_t fetchedBytes = 0, usedBytes = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t vertex = indices[i];
+        if (!used[vertex])
+        {
+            used[vertex] = true;
+            usedBytes += vertexSize;
+        }
+        size_t first = vertex * vertexSize / LINE_SIZE;
+        size_t last = (vertex * vertexSize + vertexSize - 1) / LINE_SIZE;
+        for (size_t line = first; line <= last; line++)
+        {
+            if (lines[line % LINE_COUNT] != line)
+            {
+                lines[line % LINE_COUNT] = line;
+                fetchedBytes += LINE_SIZE;
+            }
+        }
+    }
+    return usedBytes > 0 ? (float)fetchedBytes / (float)usedBytes : 0.0f;
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation": vertices are scored by their position
+// in a simulated LRU cache and by how many triangles still need them, each step emits the best
+// scoring triangle that uses a cached vertex.
+static const int FORSYTH_CACHE_SIZE = 32;
+static const int FORSYTH_MAX_VALENCE = 32;
+
+struct ForsythScores
+{
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+
+    ForsythScores()
+    {
+        const float CACHE_DECAY_POWER = 1.5f;
+        const float LAST_TRIANGLE_SCORE = 0.75f;
+        const float VALENCE_BOOST_SCALE = 2.0f;
+        const float VALENCE_BOOST_POWER = 0.5f;
+        for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+        {
+            // the vertices of the last triangle get a fixed score, so the next triangle does not
+            // just turn around on the same edge
+            if (i < 3)
+                cache[i] = LAST_TRIANGLE_SCORE;
+            else
+                cache[i] = std::pow(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++)
+            valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+    }
+
+    // remaining: triangles not emitted yet that use the vertex
+    float score(int cachePosition, uint32_t remaining) const
+    {
+        if (remaining == 0)
+            return -1.0f;
+        float value = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+        return value + valence[remaining < (uint32_t)FORSYTH_MAX_VALENCE ? remaining : FORSYTH_MAX_VALENCE];
+    }
+};
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    static const ForsythScores scores;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // triangles of every vertex, the emitted ones are swapped to the end of each list
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        remaining[indices[i]]++;
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = scores.score(-1, remaining[v]);
+    std::vector<float> triangleScore(triangleCount);
+    size_t best = 0;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t* triangle = indices + t * 3;
+        triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = t;
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output(triangleCount * 3);
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t nextUnemitted = 0;
+
+    for (size_t written = 0; written < triangleCount; written++)
+    {
+        if (best == (size_t)-1)
+        {
+            // nothing in the cache has triangles left, continue with the next triangle of the input
+            // instead of searching all of them for the best score
+            while (emitted[nextUnemitted])
+                nextUnemitted++;
+            best = nextUnemitted;
+        }
+
+        const uint32_t* triangle = indices + best * 3;
+        std::memcpy(&output[written * 3], triangle, 3 * sizeof(uint32_t));
+        emitted[best] = true;
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = triangle[k];
+            uint32_t* begin = &adjacency[firstTriangle[v]];
+            uint32_t* end = begin + remaining[v];
+            uint32_t* found = std::find(begin, end, (uint32_t)best);
+            std::swap(*found, *(end - 1));
+            remaining[v]--;
+        }
+
+        // the triangle moves to the front of the LRU cache, the rest keeps its order
+        int newCount = 0;
+        for (int k = 0; k < 3; k++)
+            newCache[newCount++] = triangle[k];
+        for (int i = 0; i < cacheCount; i++)
+        {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache[newCount++] = v;
+        }
+
+        // update the scores of every vertex whose cache position or valence changed, the
+        // vertices pushed out of the cache included
+        for (int i = 0; i < newCount; i++)
+        {
+            uint32_t v = newCache[i];
+            int position = i < FORSYTH_CACHE_SIZE ? i : -1;
+            cachePosition[v] = position;
+            float score = scores.score(position, remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            const uint32_t* adjacent = &adjacency[firstTriangle[v]];
+            for (uint32_t j = 0; j < remaining[v]; j++)
+                triangleScore[adjacent[j]] += delta;
+        }
+        cacheCount = newCount < FORSYTH_CACHE_SIZE ? newCount : FORSYTH_CACHE_SIZE;
+        std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // the next triangle is the best one touching the cache
+        best = (size_t)-1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheCount; i++)
+        {
+            uint32_t v = cache[i];
+            const uint32_t* adjacent = &adjacency[firstTriangle[v]];
+            for (uint32_t j = 0; j < remaining[v]; j++)
+            {
+                if (triangleScore[adjacent[j]] > bestScore)
+                {
+                    bestScore = triangleScore[adjacent[j]];
+                    best = adjacent[j];
+                }
+            }
+        }
+    }
+
+    std::memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+// Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold)
+{
+    const unsigned int CACHE_SIZE = 16;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // hard boundaries: triangles that miss with all three vertices start over somewhere else
+    // in the mesh, the cache optimized order is cut there anyway
+    std::vector<size_t> hardClusters;
+    FifoCache cache(vertexCount, CACHE_SIZE);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (cache.accessTriangle(indices + t * 3) == 3)
+            hardClusters.push_back(t);
+    }
+    if (hardClusters.empty() || hardClusters[0] != 0)
+        hardClusters.insert(hardClusters.begin(), 0);
+
+    // soft boundaries: a hard cluster is cut further whenever the part since the last cut has
+    // reached the ACMR of the whole cluster (times the threshold), a cut flushes the cache
+    std::vector<size_t> clusters;
+    for (size_t c = 0; c < hardClusters.size(); c++)
+    {
+        size_t start = hardClusters[c];
+        size_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : triangleCount;
+
+        cache.flush();
+        size_t clusterMisses = 0;
+        for (size_t t = start; t < end; t++)
+            clusterMisses += cache.accessTriangle(indices + t * 3);
+        float clusterThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+        size_t clusterCount = clusters.size();
+        clusters.push_back(start);
+        cache.flush();
+        size_t runningMisses = 0, runningTriangles = 0;
+        for (size_t t = start; t < end; t++)
+        {
+            runningMisses += cache.accessTriangle(indices + t * 3);
+            runningTriangles++;
+            if ((float)runningMisses <= clusterThreshold * runningTriangles)
+            {
+                clusters.push_back(t + 1);
+                cache.flush();
+                runningMisses = 0;
+                runningTriangles = 0;
+            }
+        }
+        // the part after the last cut is usually a few triangles with a bad ACMR, it goes to
+        // the cluster before it. a cut at the very end is dropped here as well.
+        if (clusters.size() - clusterCount > 1)
+            clusters.pop_back();
+    }
+
+    // cluster centroids and normals, both area weighted through the unnormalized cross products
+    auto position = [&](uint32_t vertex) {
+        const float* p = (const float*)((const char*)positions + vertex * positionStride);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+    glm::vec3 meshCentroid(0.0f);
+    for (size_t v = 0; v < vertexCount; v++)
+        meshCentroid += position((uint32_t)v);
+    meshCentroid /= (float)(vertexCount > 0 ? vertexCount : 1);
+
+    struct Cluster
+    {
+        size_t start;
+        size_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> sorted(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        Cluster& cluster = sorted[c];
+        cluster.start = clusters[c];
+        cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = cluster.start; t < cluster.end; t++)
+        {
+            glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), d = position(indices[t * 3 + 2]);
+            glm::vec3 cross = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(cross);
+            centroid += (a + b + d) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+        centroid = area > 0.0f ? centroid / area : position(indices[cluster.start * 3]);
+        float normalLength = glm::length(normal);
+        // clusters facing away from the center are on the outside and draw first
+        cluster.sortKey = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (const Cluster& cluster : sorted)
+        output.insert(output.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+    std::memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount)
+{
+    const uint32_t UNUSED = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t& target = remap[indices[i]];
+        if (target == UNUSED)
+            target = next++;
+        indices[i] = target;
+    }
+    size_t usedCount = next;
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] == UNUSED)
+            remap[v] = next++;
+    }
+
+    std::vector<unsigned char> copy((unsigned char*)vertices, (unsigned char*)vertices + vertexCount * vertexSize);
+    for (size_t v = 0; v < vertexCount; v++)
+        std::memcpy((unsigned char*)vertices + remap[v] * vertexSize, copy.data() + v * vertexSize, vertexSize);
+    return usedCount;
+}
+
+void OptimizeObjMesh(ObjMesh& mesh)
+{
+    size_t vertexCount = mesh.vertices.size();
+    if (vertexCount == 0 || mesh.indices.empty())
+        return;
+    OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices[0].position, sizeof(ObjVertex), vertexCount);
+    size_t used = OptimizeVertexFetch(mesh.vertices.data(), vertexCount, sizeof(ObjVertex), mesh.indices.data(), mesh.indices.size());
+    mesh.vertices.resize(used);
+}
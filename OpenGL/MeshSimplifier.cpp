@@ -0,0 +1,339 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// symmetric 4x4 plane quadric, weighted by the triangle areas so that the error divided by the
+// weight is a squared distance
+struct Quadric
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+
+    void add(const Quadric& other)
+    {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // squared distance of p to the planes, averaged over their areas
+    double error(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double value = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z + a22 * z * z
+            + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.0 ? (value > 0.0 ? value : 0.0) / weight : 0.0;
+    }
+};
+
+static Quadric PlaneQuadric(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    Quadric q = {};
+    glm::vec3 cross = glm::cross(b - a, c - a);
+    float length = glm::length(cross);
+    if (length == 0.0f)
+        return q;
+    glm::vec3 n = cross / length;
+    double area = length * 0.5;
+    double d = -glm::dot(n, a);
+    q.a00 = area * n.x * n.x; q.a01 = area * n.x * n.y; q.a02 = area * n.x * n.z;
+    q.a11 = area * n.y * n.y; q.a12 = area * n.y * n.z; q.a22 = area * n.z * n.z;
+    q.b0 = area * n.x * d; q.b1 = area * n.y * d; q.b2 = area * n.z * d;
+    q.c = area * d * d;
+    q.weight = area;
+    return q;
+}
+
+struct Collapse
+{
+    uint32_t from;      // welded vertex that goes away
+    uint32_t to;        // vertex it is replaced by
+    float cost;         // squared distance
+};
+
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+    size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError)
+{
+    auto position = [&](uint32_t vertex) {
+        const float* p = (const float*)((const char*)positions + vertex * positionStride);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // weld the vertices by position, the welded index is the first vertex with that position
+    std::vector<uint32_t> order(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        order[v] = (uint32_t)v;
+    auto positionLess = [&](uint32_t a, uint32_t b) {
+        const float* pa = (const float*)((const char*)positions + a * positionStride);
+        const float* pb = (const float*)((const char*)positions + b * positionStride);
+        if (pa[0] != pb[0])
+            return pa[0] < pb[0];
+        if (pa[1] != pb[1])
+            return pa[1] < pb[1];
+        if (pa[2] != pb[2])
+            return pa[2] < pb[2];
+        return a < b;
+    };
+    std::sort(order.begin(), order.end(), positionLess);
+    std::vector<uint32_t> weld(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        uint32_t v = order[i];
+        bool same = i > 0 && position(order[i - 1]) == position(v);
+        weld[v] = same ? weld[order[i - 1]] : v;
+    }
+
+    // welded vertices with more than one used wedge sit on an attribute seam
+    std::vector<uint32_t> wedge(vertexCount, 0xFFFFFFFFu);
+    std::vector<bool> locked(vertexCount, false);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t w = weld[indices[i]];
+        if (wedge[w] == 0xFFFFFFFFu)
+            wedge[w] = indices[i];
+        else if (wedge[w] != indices[i])
+            locked[w] = true;
+    }
+
+    // the current triangles, without the ones that are degenerate after welding
+    std::vector<uint32_t> current;
+    current.reserve(indexCount);
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t a = weld[indices[i]], b = weld[indices[i + 1]], c = weld[indices[i + 2]];
+        if (a != b && b != c && c != a)
+            current.insert(current.end(), indices + i, indices + i + 3);
+    }
+
+    // edges used by one triangle are on a border, edges used by more than two are non-manifold,
+    // the vertices of both stay
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(current.size());
+        for (size_t i = 0; i < current.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = weld[current[i + k]], b = weld[current[i + (k + 1) % 3]];
+                edges.push_back(a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i])
+                j++;
+            if (j - i != 2)
+            {
+                locked[(uint32_t)(edges[i] >> 32)] = true;
+                locked[(uint32_t)edges[i]] = true;
+            }
+            i = j;
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric());
+    for (size_t i = 0; i < current.size(); i += 3)
+    {
+        Quadric q = PlaneQuadric(position(current[i]), position(current[i + 1]), position(current[i + 2]));
+        for (int k = 0; k < 3; k++)
+            quadrics[weld[current[i + k]]].add(q);
+    }
+
+    // every pass collapses the cheapest edges that don't touch each other, until enough triangles
+    // are gone or nothing can collapse any more
+    double maxCost = (double)targetError * targetError;
+    double worstCost = 0.0;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> firstTriangle(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> collapseTarget(vertexCount);
+    while (current.size() > targetIndexCount)
+    {
+        collapses.clear();
+        for (size_t i = 0; i < current.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = current[i + k], b = current[i + (k + 1) % 3];
+                uint32_t wa = weld[a], wb = weld[b];
+                Quadric q = quadrics[wa];
+                q.add(quadrics[wb]);
+                if (!locked[wa])
+                    collapses.push_back({ wa, b, (float)q.error(position(b)) });
+                if (!locked[wb])
+                    collapses.push_back({ wb, a, (float)q.error(position(a)) });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        // triangles around every welded vertex, for the flip test
+        std::fill(firstTriangle.begin(), firstTriangle.end(), 0);
+        for (size_t i = 0; i < current.size(); i++)
+            firstTriangle[weld[current[i]] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            firstTriangle[v + 1] += firstTriangle[v];
+        adjacency.resize(current.size());
+        {
+            std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+            for (size_t i = 0; i < current.size(); i++)
+                adjacency[fill[weld[current[i]]]++] = (uint32_t)(i / 3);
+        }
+
+        // a collapse removes about two triangles
+        size_t triangleCount = current.size() / 3;
+        size_t targetTriangles = targetIndexCount / 3;
+        size_t wanted = (triangleCount - targetTriangles) / 2 + 1;
+        size_t accepted = 0;
+        std::fill(touched.begin(), touched.end(), false);
+        std::fill(collapseTarget.begin(), collapseTarget.end(), 0xFFFFFFFFu);
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.cost > maxCost || accepted == wanted)
+                break;
+            uint32_t from = collapse.from, to = weld[collapse.to];
+            if (touched[from] || touched[to])
+                continue;
+
+            // the triangles that keep existing must not turn over
+            glm::vec3 target = position(collapse.to);
+            bool flips = false;
+            for (uint32_t j = firstTriangle[from]; j < firstTriangle[from + 1] && !flips; j++)
+            {
+                const uint32_t* triangle = &current[adjacency[j] * 3];
+                glm::vec3 corners[3], moved[3];
+                bool degenerate = false;
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t w = weld[triangle[k]];
+                    degenerate = degenerate || w == to;
+                    corners[k] = position(triangle[k]);
+                    moved[k] = w == from ? target : corners[k];
+                }
+                if (degenerate)
+                    continue;
+                glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips)
+                continue;
+
+            // the neighbourhood is frozen for the rest of the pass, the flip tests of other
+            // collapses assumed it does not move
+            for (uint32_t j = firstTriangle[from]; j < firstTriangle[from + 1]; j++)
+            {
+                const uint32_t* triangle = &current[adjacency[j] * 3];
+                for (int k = 0; k < 3; k++)
+                    touched[weld[triangle[k]]] = true;
+            }
+            collapseTarget[from] = collapse.to;
+            quadrics[to].add(quadrics[from]);
+            worstCost = std::max(worstCost, (double)collapse.cost);
+            accepted++;
+        }
+        if (accepted == 0)
+            break;
+
+        // from is not on a seam, all of its indices are the one wedge and become the target vertex
+        size_t kept = 0;
+        for (size_t i = 0; i < current.size(); i += 3)
+        {
+            uint32_t triangle[3];
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = current[i + k];
+                uint32_t target = collapseTarget[weld[v]];
+                triangle[k] = target != 0xFFFFFFFFu ? target : v;
+            }
+            uint32_t a = weld[triangle[0]], b = weld[triangle[1]], c = weld[triangle[2]];
+            if (a == b || b == c || c == a)
+                continue;
+            std::memcpy(&current[kept], triangle, sizeof(triangle));
+            kept += 3;
+        }
+        current.resize(kept);
+    }
+
+    if (!current.empty())
+        std::memcpy(destination, current.data(), current.size() * sizeof(uint32_t));
+    if (resultError)
+        *resultError = (float)std::sqrt(worstCost);
+    return current.size();
+}
+
+std::vector<MeshLod> BuildMeshLods(ObjMesh& mesh, int maxLodCount, float reduction)
+{
+    std::vector<MeshLod> lods;
+    if (mesh.indices.empty() || mesh.vertices.empty())
+        return lods;
+
+    std::vector<uint32_t> source = mesh.indices;
+    OptimizeVertexCache(source.data(), source.size(), mesh.vertices.size());
+    mesh.indices = source;
+    lods.push_back({ 0, (uint32_t)source.size(), 0.0f });
+
+    // every level is simplified from the one before, which is much faster than starting from the
+    // full detail each time. the errors add up, the sum bounds the distance to the original.
+    std::vector<uint32_t> previous = source;
+    std::vector<uint32_t> simplified(source.size());
+    for (int level = 1; level < maxLodCount; level++)
+    {
+        size_t target = (size_t)(previous.size() / 3 * reduction) * 3;
+        float error = 0.0f;
+        size_t count = SimplifyMesh(simplified.data(), previous.data(), previous.size(), mesh.vertices[0].position, sizeof(ObjVertex),
+            mesh.vertices.size(), target, FLT_MAX, &error);
+        // nothing left to take away, e.g. everything is on seams or borders
+        if (count == 0 || count > previous.size() * 9 / 10)
+            break;
+        OptimizeVertexCache(simplified.data(), count, mesh.vertices.size());
+        lods.push_back({ (uint32_t)mesh.indices.size(), (uint32_t)count, lods.back().error + error });
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.begin() + count);
+        previous.assign(simplified.begin(), simplified.begin() + count);
+    }
+    return lods;
+}
+
+float ProjectedLodError(const MeshLod& lod, float objectScale, float distance, const LodSelection& selection)
+{
+    // the height of the view at that distance spans the screen height
+    float viewHeight = 2.0f * std::max(distance, 1e-4f) * std::tan(selection.fovY * 0.5f);
+    return lod.error * objectScale / viewHeight * selection.screenHeight;
+}
+
+int SelectMeshLod(const std::vector<MeshLod>& lods, float objectScale, float distance, const LodSelection& selection, int currentLod)
+{
+    if (lods.empty())
+        return 0;
+    int last = (int)lods.size() - 1;
+    currentLod = currentLod < 0 ? 0 : (currentLod > last ? last : currentLod);
+
+    // the current level got too coarse: straight to the coarsest one that is good enough, the
+    // error is already visible
+    if (ProjectedLodError(lods[currentLod], objectScale, distance, selection) > selection.pixelError * (1.0f + selection.hysteresis))
+    {
+        int lod = currentLod;
+        while (lod > 0 && ProjectedLodError(lods[lod], objectScale, distance, selection) > selection.pixelError)
+            lod--;
+        return lod;
+    }
+
+    // coarser levels only once they are clearly below the limit
+    int lod = currentLod;
+    while (lod < last && ProjectedLodError(lods[lod + 1], objectScale, distance, selection) <= selection.pixelError * (1.0f - selection.hysteresis))
+        lod++;
+    return lod;
+}
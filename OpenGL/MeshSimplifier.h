@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ObjMesh;
+
+// quadric error metric simplification (Garland and Heckbert) of an indexed triangle list.
+// vertices collapse onto a neighbour, so the result indexes the same vertex buffer and LODs can
+// share it. positions are 3 floats every positionStride bytes.
+//
+// vertices with the same position but different texture coordinates or normals (the seams the
+// OBJ import creates) and vertices on open borders are kept where they are, so the attributes
+// and the outline of the mesh survive. everything else collapses in the order of the error it
+// adds, until the index count is at most targetIndexCount or the next collapse would move the
+// surface by more than targetError.
+//
+// writes the indices to destination (indexCount entries are enough) and returns their count.
+// resultError is the largest distance of the simplified surface to the original one the
+// quadrics measured, in the units of the positions.
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+    size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+// one level of detail, a range of the index buffer
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;            // object space units, 0 for the full detail level
+};
+
+// replaces mesh.indices with the full detail triangles followed by up to maxLodCount - 1
+// simplified levels, each with about reduction times the triangles of the one before.
+// stops early when a level would not be simpler than the one before. all levels are vertex
+// cache optimized and use the vertices of the mesh. a level is simplified from the one before,
+// its error is the sum of the errors on the way, an upper bound of the distance to the original.
+std::vector<MeshLod> BuildMeshLods(ObjMesh& mesh, int maxLodCount = 5, float reduction = 0.5f);
+
+struct LodSelection
+{
+    float fovY = 0.785398f;         // radians, as given to glm::perspective
+    float screenHeight = 600.0f;    // pixels
+    float pixelError = 1.0f;        // largest error allowed on screen
+    float hysteresis = 0.25f;       // fraction of pixelError a level has to be past before it changes
+};
+
+// error of a level in pixels, for an object at distance from the camera scaled by objectScale
+float ProjectedLodError(const MeshLod& lod, float objectScale, float distance, const LodSelection& selection);
+
+// coarsest level whose projected error is below the pixel error. around the switching distances
+// the level of the last frame is kept, a coarser level is only taken below
+// pixelError * (1 - hysteresis) and the current level is only left for a finer one above
+// pixelError * (1 + hysteresis), so an object on the edge does not pop every frame.
+int SelectMeshLod(const std::vector<MeshLod>& lods, float objectScale, float distance, const LodSelection& selection, int currentLod);
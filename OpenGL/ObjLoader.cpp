@@ -0,0 +1,545 @@
+#include "ObjLoader.h"
+#include "JobPool.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// one face corner as it is in the file, 0 based. -1 means the index is not given.
+// negative (relative) indices may point into earlier chunks, the parser stores them as
+// OBJ_RELATIVE_BASE + the index relative to the start of its chunk, they are resolved
+// once the element counts of all chunks are known.
+struct ObjCorner
+{
+    int32_t v;
+    int32_t vt;
+    int32_t vn;
+};
+
+static const int32_t OBJ_MISSING = -1;
+static const int32_t OBJ_RELATIVE_BASE = -(1 << 30);
+// marks the corners in ObjMesh::indices that still hold the index of their first corner
+static const uint32_t OBJ_FOLLOWER = 0x80000000u;
+
+// a line aligned piece of the file and what the parser found in it
+struct ObjChunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<float> positions;       // 3 per v
+    std::vector<float> texCoords;       // 2 per vt
+    std::vector<float> normals;         // 3 per vn
+    std::vector<ObjCorner> corners;     // 3 per triangle
+    size_t positionBase = 0;
+    size_t texCoordBase = 0;
+    size_t normalBase = 0;
+    size_t cornerBase = 0;
+    size_t vertexBase = 0;
+    size_t vertexCount = 0;
+};
+
+// the deduplication hashes every corner, the top bits pick the shard, the low bits the slot
+static const int OBJ_SHARD_BITS = 6;
+static const int OBJ_SHARDS = 1 << OBJ_SHARD_BITS;
+
+// a corner with its index in the file, partitioned by shard
+struct ObjShardEntry
+{
+    ObjCorner corner;
+    uint32_t index;
+};
+
+static inline uint32_t HashCorner(const ObjCorner& corner)
+{
+    uint32_t h = (uint32_t)corner.v * 0x9E3779B1u;
+    h ^= (uint32_t)corner.vt * 0x85EBCA77u;
+    h ^= (uint32_t)corner.vn * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 13;
+    return h;
+}
+
+static inline bool IsDigit(char c)
+{
+    return (unsigned char)(c - '0') < 10;
+}
+
+static inline const char* SkipBlanks(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+// decimal float without locale and without std::stringstream: up to 19 significant digits are
+// collected in an integer and scaled by a power of ten in double precision. the result can be one
+// float ulp off the correctly rounded value, which doesn't matter for vertex data.
+// returns nullptr if there is no number at p.
+static const char* ParseFloat(const char* p, const char* end, float& value)
+{
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    p = SkipBlanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any = false;
+    while (p < end && IsDigit(*p))
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0)
+                digits++;
+        }
+        else
+        {
+            exponent++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        while (p < end && IsDigit(*p))
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0)
+                    digits++;
+                exponent--;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any)
+        return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = *q == '-';
+            q++;
+        }
+        if (q < end && IsDigit(*q))
+        {
+            int e = 0;
+            while (q < end && IsDigit(*q))
+            {
+                if (e < 10000)
+                    e = e * 10 + (*q - '0');
+                q++;
+            }
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    double result = (double)mantissa;
+    if (exponent != 0 && mantissa != 0)
+    {
+        if (exponent > 0 && exponent <= 22)
+            result *= powers[exponent];
+        else if (exponent < 0 && exponent >= -22)
+            result /= powers[-exponent];
+        else
+            result *= std::pow(10.0, exponent);
+    }
+    value = (float)(negative ? -result : result);
+    return p;
+}
+
+// one face index: an integer, negative counts back from the last element defined so far.
+// 0 is not a valid OBJ index and is rejected like a missing number.
+static const char* ParseIndex(const char* p, const char* end, size_t definedSoFar, int32_t& index)
+{
+    bool negative = false;
+    if (p < end && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+    if (p >= end || !IsDigit(*p))
+        return nullptr;
+    int64_t value = 0;
+    while (p < end && IsDigit(*p))
+    {
+        if (value < (int64_t)1 << 32)
+            value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (value == 0 || value > (int64_t)1 << 30)
+        return nullptr;
+    index = negative ? OBJ_RELATIVE_BASE + (int32_t)((int64_t)definedSoFar - value) : (int32_t)(value - 1);
+    return p;
+}
+
+static inline const char* NextLine(const char* p, const char* end)
+{
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+// floats on the rest of the line into out, missing ones are 0
+static const char* ParseFloats(const char* p, const char* end, int count, std::vector<float>& out)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float value = 0.0f;
+        const char* next = ParseFloat(p, end, value);
+        if (next)
+            p = next;
+        out.push_back(value);
+    }
+    return p;
+}
+
+static void ParseChunk(ObjChunk& chunk)
+{
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    while (p < end)
+    {
+        p = SkipBlanks(p, end);
+        if (end - p >= 2 && p[0] == 'v')
+        {
+            if (p[1] == ' ' || p[1] == '\t')
+                p = ParseFloats(p + 2, end, 3, chunk.positions);
+            else if (p[1] == 't' && end - p >= 3 && (p[2] == ' ' || p[2] == '\t'))
+                p = ParseFloats(p + 3, end, 2, chunk.texCoords);
+            else if (p[1] == 'n' && end - p >= 3 && (p[2] == ' ' || p[2] == '\t'))
+                p = ParseFloats(p + 3, end, 3, chunk.normals);
+        }
+        else if (end - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            // the corners of a polygon, split into a fan around the first one
+            ObjCorner first = {}, previous = {};
+            int cornerCount = 0;
+            p += 2;
+            for (;;)
+            {
+                p = SkipBlanks(p, end);
+                ObjCorner corner = { OBJ_MISSING, OBJ_MISSING, OBJ_MISSING };
+                const char* next = ParseIndex(p, end, chunk.positions.size() / 3, corner.v);
+                if (!next)
+                    break;
+                p = next;
+                if (p < end && *p == '/')
+                {
+                    p++;
+                    if (p < end && *p != '/')
+                    {
+                        next = ParseIndex(p, end, chunk.texCoords.size() / 2, corner.vt);
+                        if (!next)
+                            break;
+                        p = next;
+                    }
+                    if (p < end && *p == '/')
+                    {
+                        next = ParseIndex(p + 1, end, chunk.normals.size() / 3, corner.vn);
+                        if (!next)
+                            break;
+                        p = next;
+                    }
+                }
+
+                if (cornerCount == 0)
+                    first = corner;
+                else if (cornerCount >= 2)
+                {
+                    chunk.corners.push_back(first);
+                    chunk.corners.push_back(previous);
+                    chunk.corners.push_back(corner);
+                }
+                previous = corner;
+                cornerCount++;
+            }
+        }
+        p = NextLine(p, end);
+    }
+}
+
+// relative indices to file indices, false if the index is outside of [0, count)
+static inline bool ResolveIndex(int32_t& index, size_t chunkBase, size_t count, bool optional)
+{
+    if (index == OBJ_MISSING)
+        return optional;
+    int64_t resolved = index;
+    if (index < OBJ_MISSING)
+        resolved = (int64_t)chunkBase + (index - OBJ_RELATIVE_BASE);
+    if (resolved < 0 || resolved >= (int64_t)count)
+        return false;
+    index = (int32_t)resolved;
+    return true;
+}
+
+bool LoadObjMesh(const std::string& path, ObjMesh& mesh, JobPool& pool)
+{
+    mesh = ObjMesh();
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::OBJ::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+
+    // line aligned chunks, a few per thread so uneven chunks even out. the upper limit keeps the
+    // arrays of a chunk small enough that the allocator can recycle them for the next ones
+    const char* data = (const char*)file.data();
+    const size_t size = file.size();
+    size_t chunkSize = size / (pool.threadCount() * 8) + 1;
+    if (chunkSize < ((size_t)256 << 10))
+        chunkSize = (size_t)256 << 10;
+    if (chunkSize > ((size_t)4 << 20))
+        chunkSize = (size_t)4 << 20;
+    std::vector<ObjChunk> chunks;
+    const char* begin = data;
+    while (begin < data + size)
+    {
+        const char* end = begin + chunkSize < data + size ? NextLine(begin + chunkSize, data + size) : data + size;
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = end;
+        begin = end;
+    }
+    const int chunkCount = (int)chunks.size();
+
+    pool.parallelFor(chunkCount, [&](int c) { ParseChunk(chunks[c]); });
+
+    // where the elements of every chunk start in the whole file
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.positionBase = positionCount;
+        chunk.texCoordBase = texCoordCount;
+        chunk.normalBase = normalCount;
+        chunk.cornerBase = cornerCount;
+        positionCount += chunk.positions.size() / 3;
+        texCoordCount += chunk.texCoords.size() / 2;
+        normalCount += chunk.normals.size() / 3;
+        cornerCount += chunk.corners.size();
+    }
+    if (cornerCount >= OBJ_FOLLOWER)
+    {
+        std::cout << "ERROR::OBJ::TOO_MANY_FACES " << path << std::endl;
+        return false;
+    }
+
+    // resolve the indices, gather the attributes of all chunks and count the corners per dedup shard
+    std::vector<float> positions(positionCount * 3);
+    std::vector<float> texCoords(texCoordCount * 2);
+    std::vector<float> normals(normalCount * 3);
+    std::vector<size_t> shardCounts((size_t)chunkCount * OBJ_SHARDS, 0);
+    std::atomic<bool> outOfRange(false);
+    pool.parallelFor(chunkCount, [&](int c) {
+        ObjChunk& chunk = chunks[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase * 3);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase * 2);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase * 3);
+        std::vector<float>().swap(chunk.positions);
+        std::vector<float>().swap(chunk.texCoords);
+        std::vector<float>().swap(chunk.normals);
+
+        size_t* counts = &shardCounts[(size_t)c * OBJ_SHARDS];
+        for (ObjCorner& corner : chunk.corners)
+        {
+            if (!ResolveIndex(corner.v, chunk.positionBase, positionCount, false)
+                || !ResolveIndex(corner.vt, chunk.texCoordBase, texCoordCount, true)
+                || !ResolveIndex(corner.vn, chunk.normalBase, normalCount, true))
+            {
+                outOfRange = true;
+                return;
+            }
+            counts[HashCorner(corner) >> (32 - OBJ_SHARD_BITS)]++;
+        }
+    });
+    if (outOfRange)
+    {
+        std::cout << "ERROR::OBJ::INDEX_OUT_OF_RANGE " << path << std::endl;
+        return false;
+    }
+
+    // partition the corners by shard, within a shard they stay in file order. shardCounts
+    // becomes the write position of every chunk in every shard
+    std::vector<size_t> shardBegin(OBJ_SHARDS + 1);
+    size_t offset = 0;
+    for (int shard = 0; shard < OBJ_SHARDS; shard++)
+    {
+        shardBegin[shard] = offset;
+        for (int c = 0; c < chunkCount; c++)
+        {
+            size_t count = shardCounts[(size_t)c * OBJ_SHARDS + shard];
+            shardCounts[(size_t)c * OBJ_SHARDS + shard] = offset;
+            offset += count;
+        }
+    }
+    shardBegin[OBJ_SHARDS] = offset;
+    std::vector<ObjShardEntry> partitioned(cornerCount);
+    pool.parallelFor(chunkCount, [&](int c) {
+        const ObjChunk& chunk = chunks[c];
+        size_t* positionsInShards = &shardCounts[(size_t)c * OBJ_SHARDS];
+        for (size_t i = 0; i < chunk.corners.size(); i++)
+        {
+            const ObjCorner& corner = chunk.corners[i];
+            ObjShardEntry& entry = partitioned[positionsInShards[HashCorner(corner) >> (32 - OBJ_SHARD_BITS)]++];
+            entry.corner = corner;
+            entry.index = (uint32_t)(chunk.cornerBase + i);
+        }
+    });
+
+    // dedup: every shard owns the combinations that hash into it and sees their corners in file
+    // order, so the first corner of every combination is found without any locking.
+    // until the vertices are numbered, mesh.indices[i] is the first corner with the same
+    // v/vt/vn as corner i
+    std::vector<uint32_t>& cornerFirst = mesh.indices;
+    cornerFirst.resize(cornerCount);
+    pool.parallelFor(OBJ_SHARDS, [&](int shard) {
+        const ObjShardEntry* entries = partitioned.data() + shardBegin[shard];
+        const size_t count = shardBegin[shard + 1] - shardBegin[shard];
+        // open addressing with linear probing, the table holds the combinations themselves so the
+        // probes don't touch the corners. it starts for about two corners per vertex and is kept
+        // at most half full
+        size_t slots = 16;
+        while (slots < count)
+            slots *= 2;
+        std::vector<ObjShardEntry> table(slots);
+        for (ObjShardEntry& slot : table)
+            slot.index = 0xFFFFFFFFu;
+        size_t used = 0;
+        for (size_t e = 0; e < count; e++)
+        {
+            const ObjShardEntry& entry = entries[e];
+            size_t mask = table.size() - 1;
+            size_t slot = HashCorner(entry.corner) & mask;
+            for (;;)
+            {
+                ObjShardEntry& existing = table[slot];
+                if (existing.index == 0xFFFFFFFFu)
+                {
+                    existing = entry;
+                    cornerFirst[entry.index] = entry.index;
+                    used++;
+                    break;
+                }
+                if (existing.corner.v == entry.corner.v && existing.corner.vt == entry.corner.vt && existing.corner.vn == entry.corner.vn)
+                {
+                    cornerFirst[entry.index] = existing.index;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+
+            if (used * 2 > table.size())
+            {
+                std::vector<ObjShardEntry> grown(table.size() * 2);
+                for (ObjShardEntry& slot : grown)
+                    slot.index = 0xFFFFFFFFu;
+                mask = grown.size() - 1;
+                for (const ObjShardEntry& existing : table)
+                {
+                    if (existing.index == 0xFFFFFFFFu)
+                        continue;
+                    size_t target = HashCorner(existing.corner) & mask;
+                    while (grown[target].index != 0xFFFFFFFFu)
+                        target = (target + 1) & mask;
+                    grown[target] = existing;
+                }
+                table.swap(grown);
+            }
+        }
+    });
+    std::vector<ObjShardEntry>().swap(partitioned);
+
+    // the first corners become the vertices, numbered in file order
+    pool.parallelFor(chunkCount, [&](int c) {
+        ObjChunk& chunk = chunks[c];
+        size_t count = 0;
+        for (size_t i = 0; i < chunk.corners.size(); i++)
+            count += cornerFirst[chunk.cornerBase + i] == chunk.cornerBase + i;
+        chunk.vertexCount = count;
+    });
+    size_t vertexCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.vertexBase = vertexCount;
+        vertexCount += chunk.vertexCount;
+    }
+
+    mesh.vertices.resize(vertexCount);
+    mesh.hasTexCoords = texCoordCount > 0;
+    mesh.hasNormals = normalCount > 0;
+    pool.parallelFor(chunkCount, [&](int c) {
+        ObjChunk& chunk = chunks[c];
+        uint32_t next = (uint32_t)chunk.vertexBase;
+        for (size_t i = 0; i < chunk.corners.size(); i++)
+        {
+            size_t index = chunk.cornerBase + i;
+            if (cornerFirst[index] != index)
+            {
+                cornerFirst[index] |= OBJ_FOLLOWER;
+                continue;
+            }
+            const ObjCorner& corner = chunk.corners[i];
+            ObjVertex& vertex = mesh.vertices[next];
+            memcpy(vertex.position, &positions[(size_t)corner.v * 3], 3 * sizeof(float));
+            if (corner.vt >= 0)
+                memcpy(vertex.texCoord, &texCoords[(size_t)corner.vt * 2], 2 * sizeof(float));
+            else
+                vertex.texCoord[0] = vertex.texCoord[1] = 0.0f;
+            if (corner.vn >= 0)
+                memcpy(vertex.normal, &normals[(size_t)corner.vn * 3], 3 * sizeof(float));
+            else
+                vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+            cornerFirst[index] = next++;
+        }
+        std::vector<ObjCorner>().swap(chunk.corners);
+    });
+    // the other corners take the vertex of their first corner, which may be in an earlier chunk
+    pool.parallelFor(chunkCount, [&](int c) {
+        size_t end = c + 1 < chunkCount ? chunks[c + 1].cornerBase : cornerCount;
+        for (size_t i = chunks[c].cornerBase; i < end; i++)
+        {
+            if (mesh.indices[i] & OBJ_FOLLOWER)
+                mesh.indices[i] = mesh.indices[mesh.indices[i] & ~OBJ_FOLLOWER];
+        }
+    });
+    return true;
+}
+
+bool LoadObjMesh(const std::string& path, ObjMesh& mesh, unsigned int threadCount)
+{
+    JobPool pool(threadCount);
+    return LoadObjMesh(path, mesh, pool);
+}
+
+std::vector<float> ObjPositionsAndTexCoords(const ObjMesh& mesh)
+{
+    std::vector<float> vertices;
+    vertices.reserve(mesh.vertices.size() * 5);
+    for (const ObjVertex& vertex : mesh.vertices)
+    {
+        vertices.insert(vertices.end(), vertex.position, vertex.position + 3);
+        vertices.insert(vertices.end(), vertex.texCoord, vertex.texCoord + 2);
+    }
+    return vertices;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobPool;
+
+struct ObjVertex
+{
+    float position[3];
+    float texCoord[2];
+    float normal[3];
+};
+
+// an OBJ file as one indexed triangle list. every distinct v/vt/vn combination of the faces
+// becomes one vertex, in the order the combinations first appear in the file.
+struct ObjMesh
+{
+    std::vector<ObjVertex> vertices;
+    std::vector<uint32_t> indices;
+    bool hasTexCoords = false;      // false: the texture coordinates are 0
+    bool hasNormals = false;        // false: the normals are 0
+};
+
+// Wavefront OBJ import of v, vt, vn and f lines, polygons are split into triangle fans. objects,
+// groups, smoothing groups and materials are ignored, lines and points are skipped.
+// the file is memory mapped and cut into line aligned chunks that are parsed on the threads of
+// the pool, the vertex deduplication is spread over the threads as well.
+// returns false with a message on std::cout if the file can't be read or an index is out of range.
+bool LoadObjMesh(const std::string& path, ObjMesh& mesh, JobPool& pool);
+// same with a pool of threadCount threads (0 = one per hardware thread) for this one call
+bool LoadObjMesh(const std::string& path, ObjMesh& mesh, unsigned int threadCount = 0);
+
+// x y z u v per vertex, the vertex layout of the Scene vertices and the GeometryPool
+std::vector<float> ObjPositionsAndTexCoords(const ObjMesh& mesh);
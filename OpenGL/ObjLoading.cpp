@@ -0,0 +1,256 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "JobPool.h"
+#include "MappedFile.h"
+#include "ObjLoader.h"
+
+// OBJ import benchmark and viewer.
+//
+// usage: ObjLoading <file.obj> [threads]
+//        ObjLoading generate <file.obj> <megabytes>
+//
+// the first form loads the file on a pool of threads (default: one per hardware thread), prints
+// the parse throughput and shows the mesh with the textures of the camera sample.
+// generate writes a tessellated sphere with v, vt, vn and quad faces of about the given size,
+// e.g. "ObjLoading generate big.obj 1024" for the 1 GB test mesh. like for AssetPackLoading,
+// the first load after generating measures a warm file cache.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// a (segments + 1) x (segments + 1) grid wrapped around a sphere, the seam vertices are duplicated
+// like a real exporter would for the texture coordinates
+static bool GenerateTestObj(const std::string& path, double megabytes)
+{
+    // about 190 bytes of v, vt, vn and f lines per grid vertex
+    int segments = (int)std::sqrt(megabytes * 1e6 / 190.0);
+    if (segments < 2)
+        segments = 2;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cout << "ERROR::OBJ::FILE_NOT_WRITTEN " << path << std::endl;
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    const float PI = 3.14159265f;
+    fprintf(file, "# test sphere, %d x %d quads\n", segments, segments);
+    for (int row = 0; row <= segments; row++)
+    {
+        for (int column = 0; column <= segments; column++)
+        {
+            float u = (float)column / segments;
+            float v = (float)row / segments;
+            float x = std::sin(v * PI) * std::cos(u * 2.0f * PI);
+            float y = std::cos(v * PI);
+            float z = std::sin(v * PI) * std::sin(u * 2.0f * PI);
+            fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", x, y, z, u, 1.0f - v, x, y, z);
+        }
+    }
+    for (int row = 0; row < segments; row++)
+    {
+        for (int column = 0; column < segments; column++)
+        {
+            int a = row * (segments + 1) + column + 1;
+            int b = a + segments + 1;
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+        }
+    }
+    bool written = ferror(file) == 0;
+    fclose(file);
+    std::cout << "wrote " << path << " with " << (segments + 1) * (segments + 1) << " vertices" << std::endl;
+    return written;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 3 && std::string(argv[1]) == "generate")
+        return GenerateTestObj(argv[2], std::stod(argv[3])) ? 0 : -1;
+    if (argc < 2)
+    {
+        std::cout << "usage: ObjLoading <file.obj> [threads] | ObjLoading generate <file.obj> <megabytes>" << std::endl;
+        return -1;
+    }
+    unsigned int threads = argc > 2 ? (unsigned int)std::stoul(argv[2]) : 0;
+
+    // load
+    // ----
+    ObjMesh mesh;
+    JobPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    if (!LoadObjMesh(argv[1], mesh, pool))
+        return -1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = MappedFile(argv[1]).size() / 1e6;
+    std::cout << argv[1] << ": " << megabytes << " MB in " << seconds * 1000.0 << " ms on " << pool.threadCount()
+        << " threads, " << megabytes / seconds << " MB/s" << std::endl;
+    std::cout << "  " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles" << std::endl;
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        Scene scene = CreateCubeScene();
+        Shader ourShader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+
+        // the mesh in the vertex layout of the other samples: x y z u v and an element buffer
+        // -----------------------------------------------------------------------------------
+        std::vector<float> vertices = ObjPositionsAndTexCoords(mesh);
+        unsigned int VBO, VAO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        GLState().bindVertexArray(VAO);
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        GLState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coord attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // scale and center the mesh into a unit cube
+        glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+        for (const ObjVertex& vertex : mesh.vertices)
+        {
+            glm::vec3 position(vertex.position[0], vertex.position[1], vertex.position[2]);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        float largest = glm::max(extent.x, glm::max(extent.y, extent.z));
+        glm::mat4 fit = glm::scale(glm::mat4(1.0f), glm::vec3(largest > 0.0f ? 1.0f / largest : 1.0f));
+        fit = glm::translate(fit, -(boundsMin + boundsMax) * 0.5f);
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+        ourShader.use();
+        ourShader.setInt("ourTexture", 0);
+        ourShader.setInt("texture2", 1);
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+
+            // render
+            // ------
+            glClearColor(0.2f, 0.7f, 0.7f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+            ourShader.use();
+
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), (float)glfwGetTime() * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)) * fit;
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.5f, 1.8f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.01f, 100.0f);
+            ourShader.setMat4("model", model);
+            ourShader.setMat4("view", view);
+            ourShader.setMat4("projection", projection);
+
+            GLState().bindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, 0);
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteBuffers(1, &EBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
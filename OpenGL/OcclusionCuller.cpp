@@ -0,0 +1,337 @@
+#include "OcclusionCuller.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <immintrin.h>
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+    : width_(std::max(width, 1)), height_(std::max(height, 1)), avx2_(CpuHasAVX2())
+{
+    int levelWidth = width_;
+    int levelHeight = height_;
+    for (;;)
+    {
+        levelWidth_.push_back(levelWidth);
+        levelHeight_.push_back(levelHeight);
+        maxDepth_.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+        // level 0 has a single depth, its min is read from maxDepth_[0]
+        minDepth_.push_back(std::vector<float>(levelWidth_.size() == 1 ? 0 : (size_t)levelWidth * levelHeight, 1.0f));
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection)
+{
+    viewProjection_ = viewProjection;
+    std::fill(maxDepth_[0].begin(), maxDepth_[0].end(), 1.0f);
+    stats_ = OcclusionStats();
+}
+
+OcclusionCuller::ScreenVertex OcclusionCuller::project(const glm::mat4& mvp, const glm::vec3& position) const
+{
+    glm::vec4 clip = mvp * glm::vec4(position, 1.0f);
+    ScreenVertex vertex;
+    vertex.valid = clip.z >= -clip.w && clip.w > 0.0f;
+    float invW = vertex.valid ? 1.0f / clip.w : 0.0f;
+    vertex.x = (clip.x * invW * 0.5f + 0.5f) * width_;
+    vertex.y = (clip.y * invW * 0.5f + 0.5f) * height_;
+    vertex.z = clip.z * invW * 0.5f + 0.5f;
+    return vertex;
+}
+
+bool OcclusionCuller::addOccluder(const glm::vec3* positions, const unsigned int* indices, int indexCount, const glm::mat4& model)
+{
+    auto start = std::chrono::steady_clock::now();
+    glm::mat4 mvp = viewProjection_ * model;
+
+    unsigned int vertexCount = 0;
+    for (int i = 0; i < indexCount; i++)
+        vertexCount = std::max(vertexCount, indices[i] + 1);
+    std::vector<ScreenVertex> vertices(vertexCount);
+    float minX = (float)width_, minY = (float)height_, maxX = 0.0f, maxY = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; i++)
+    {
+        vertices[i] = project(mvp, positions[i]);
+        if (!vertices[i].valid)
+            continue;
+        minX = std::min(minX, vertices[i].x);
+        minY = std::min(minY, vertices[i].y);
+        maxX = std::max(maxX, vertices[i].x);
+        maxY = std::max(maxY, vertices[i].y);
+    }
+
+    // the part of the bounds inside the buffer decides if the occluder is worth its triangles
+    float area = std::max(std::min(maxX, (float)width_) - std::max(minX, 0.0f), 0.0f)
+               * std::max(std::min(maxY, (float)height_) - std::max(minY, 0.0f), 0.0f);
+    if (area < minOccluderArea_)
+    {
+        stats_.occludersRejected++;
+        return false;
+    }
+
+    // a mirroring model matrix turns the front faces clockwise on screen
+    glm::vec3 x(model[0]), y(model[1]), z(model[2]);
+    mirrored_ = glm::dot(glm::cross(x, y), z) < 0.0f;
+
+    for (int i = 0; i + 2 < indexCount; i += 3)
+        rasterizeTriangle(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]);
+    stats_.occluders++;
+
+    stats_.rasterizeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool OcclusionCuller::addOccluderBox(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+    // corner i has bit 0 = x, bit 1 = y, bit 2 = z set to the max side
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++)
+        corners[i] = glm::vec3(i & 1 ? boxMax.x : boxMin.x, i & 2 ? boxMax.y : boxMin.y, i & 4 ? boxMax.z : boxMin.z);
+    // counter clockwise seen from outside
+    static const unsigned int indices[36] = {
+        1, 3, 7,  1, 7, 5,      // +x
+        0, 4, 6,  0, 6, 2,      // -x
+        2, 6, 7,  2, 7, 3,      // +y
+        0, 1, 5,  0, 5, 4,      // -y
+        4, 5, 7,  4, 7, 6,      // +z
+        0, 2, 3,  0, 3, 1       // -z
+    };
+    return addOccluder(corners, indices, 36, model);
+}
+
+void OcclusionCuller::rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2)
+{
+    if (!v0.valid || !v1.valid || !v2.valid)
+        return;
+
+    const ScreenVertex* v[3] = { &v0, &v1, &v2 };
+    if (mirrored_)
+        std::swap(v[1], v[2]);
+    float area = (v[1]->x - v[0]->x) * (v[2]->y - v[0]->y) - (v[2]->x - v[0]->x) * (v[1]->y - v[0]->y);
+    // back facing or degenerate
+    if (!(area > 0.0f))
+        return;
+
+    Triangle triangle;
+    float minX = std::min(std::min(v[0]->x, v[1]->x), v[2]->x);
+    float maxX = std::max(std::max(v[0]->x, v[1]->x), v[2]->x);
+    float minY = std::min(std::min(v[0]->y, v[1]->y), v[2]->y);
+    float maxY = std::max(std::max(v[0]->y, v[1]->y), v[2]->y);
+    if (maxX < 0.0f || maxY < 0.0f || minX > (float)width_ || minY > (float)height_)
+        return;
+    triangle.minX = std::max((int)std::floor(std::max(minX, 0.0f)), 0);
+    triangle.minY = std::max((int)std::floor(std::max(minY, 0.0f)), 0);
+    triangle.maxX = std::min((int)std::ceil(std::min(maxX, (float)width_)), width_ - 1);
+    triangle.maxY = std::min((int)std::ceil(std::min(maxY, (float)height_)), height_ - 1);
+
+    // same edge functions and fill rule as SoftwareRasterizer
+    for (int e = 0; e < 3; e++)
+    {
+        const ScreenVertex* a = v[(e + 1) % 3];
+        const ScreenVertex* b = v[(e + 2) % 3];
+        triangle.edgeA[e] = a->y - b->y;
+        triangle.edgeB[e] = b->x - a->x;
+        triangle.edgeC[e] = a->x * b->y - b->x * a->y;
+        triangle.edgeInclusive[e] = triangle.edgeA[e] > 0.0f || (triangle.edgeA[e] == 0.0f && triangle.edgeB[e] > 0.0f);
+    }
+
+    // depth plane, moved back by half a pixel along its slope: the farthest depth of the plane
+    // inside the pixel. the farthest vertex caps it for slopes at grazing angles.
+    float dz1 = v[1]->z - v[0]->z, dz2 = v[2]->z - v[0]->z;
+    float dx1 = v[1]->x - v[0]->x, dx2 = v[2]->x - v[0]->x;
+    float dy1 = v[1]->y - v[0]->y, dy2 = v[2]->y - v[0]->y;
+    triangle.zA = (dz1 * dy2 - dz2 * dy1) / area;
+    triangle.zB = (dx1 * dz2 - dx2 * dz1) / area;
+    triangle.zC = v[0]->z - triangle.zA * v[0]->x - triangle.zB * v[0]->y
+                + 0.5f * (std::fabs(triangle.zA) + std::fabs(triangle.zB));
+    triangle.zMax = std::max(std::max(v[0]->z, v[1]->z), v[2]->z);
+
+    for (int y = triangle.minY; y <= triangle.maxY; y++)
+    {
+        if (avx2_)
+            rasterizeRowAVX2(triangle, y);
+        else
+            rasterizeRowScalar(triangle, y);
+    }
+    stats_.occluderTriangles++;
+}
+
+void OcclusionCuller::rasterizeRowScalar(const Triangle& triangle, int y)
+{
+    float py = y + 0.5f;
+    float* depthRow = &maxDepth_[0][(size_t)y * width_];
+    for (int x = triangle.minX; x <= triangle.maxX; x++)
+    {
+        float px = x + 0.5f;
+        bool inside = true;
+        for (int e = 0; e < 3 && inside; e++)
+        {
+            float value = triangle.edgeA[e] * px + triangle.edgeB[e] * py + triangle.edgeC[e];
+            inside = triangle.edgeInclusive[e] ? value >= 0.0f : value > 0.0f;
+        }
+        if (!inside)
+            continue;
+        float z = std::min(triangle.zA * px + triangle.zB * py + triangle.zC, triangle.zMax);
+        if (z < depthRow[x])
+            depthRow[x] = z;
+    }
+}
+
+AVX2_TARGET
+void OcclusionCuller::rasterizeRowAVX2(const Triangle& triangle, int y)
+{
+    const __m256 laneCenters = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 end = _mm256_set1_ps((float)(triangle.maxX + 1));
+
+    float py = y + 0.5f;
+    __m256 edgeA[3], rowEdge[3];
+    for (int e = 0; e < 3; e++)
+    {
+        edgeA[e] = _mm256_set1_ps(triangle.edgeA[e]);
+        rowEdge[e] = _mm256_set1_ps(triangle.edgeB[e] * py + triangle.edgeC[e]);
+    }
+    const __m256 zA = _mm256_set1_ps(triangle.zA);
+    const __m256 rowZ = _mm256_set1_ps(triangle.zB * py + triangle.zC);
+    const __m256 zMax = _mm256_set1_ps(triangle.zMax);
+    float* depthRow = &maxDepth_[0][(size_t)y * width_];
+
+    for (int x = triangle.minX; x <= triangle.maxX; x += 8)
+    {
+        __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), laneCenters);
+        __m256 mask = _mm256_cmp_ps(px, end, _CMP_LT_OQ);
+        for (int e = 0; e < 3; e++)
+        {
+            __m256 value = _mm256_fmadd_ps(edgeA[e], px, rowEdge[e]);
+            if (triangle.edgeInclusive[e])
+                mask = _mm256_and_ps(mask, _mm256_cmp_ps(value, zero, _CMP_GE_OQ));
+            else
+                mask = _mm256_and_ps(mask, _mm256_cmp_ps(value, zero, _CMP_GT_OQ));
+        }
+        if (_mm256_movemask_ps(mask) == 0)
+            continue;
+
+        // the lanes past the end of the row must not be touched
+        __m256i lanes = _mm256_castps_si256(mask);
+        __m256 z = _mm256_min_ps(_mm256_fmadd_ps(zA, px, rowZ), zMax);
+        __m256 depth = _mm256_maskload_ps(depthRow + x, lanes);
+        _mm256_maskstore_ps(depthRow + x, lanes, _mm256_min_ps(depth, z));
+    }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t level = 1; level < maxDepth_.size(); level++)
+    {
+        int sourceWidth = levelWidth_[level - 1];
+        int sourceHeight = levelHeight_[level - 1];
+        const std::vector<float>& sourceMax = maxDepth_[level - 1];
+        const std::vector<float>& sourceMin = level == 1 ? maxDepth_[0] : minDepth_[level - 1];
+        std::vector<float>& targetMax = maxDepth_[level];
+        std::vector<float>& targetMin = minDepth_[level];
+        for (int y = 0; y < levelHeight_[level]; y++)
+        {
+            // odd sizes: the last row/column is its own 2x2 block
+            size_t row0 = (size_t)(2 * y) * sourceWidth;
+            size_t row1 = (size_t)std::min(2 * y + 1, sourceHeight - 1) * sourceWidth;
+            for (int x = 0; x < levelWidth_[level]; x++)
+            {
+                int x0 = 2 * x;
+                int x1 = std::min(2 * x + 1, sourceWidth - 1);
+                size_t target = (size_t)y * levelWidth_[level] + x;
+                targetMax[target] = std::max(std::max(sourceMax[row0 + x0], sourceMax[row0 + x1]),
+                                             std::max(sourceMax[row1 + x0], sourceMax[row1 + x1]));
+                targetMin[target] = std::min(std::min(sourceMin[row0 + x0], sourceMin[row0 + x1]),
+                                             std::min(sourceMin[row1 + x0], sourceMin[row1 + x1]));
+            }
+        }
+    }
+    stats_.pyramidMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionCuller::isVisible(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+    stats_.tested++;
+    glm::mat4 mvp = viewProjection_ * model;
+
+    int outsideAll = 0x3F;
+    bool crossesNear = false;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    float nearest = 1.0f, farthest = 0.0f;
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner(i & 1 ? boxMax.x : boxMin.x, i & 2 ? boxMax.y : boxMin.y, i & 4 ? boxMax.z : boxMin.z);
+        glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+        int outside = (clip.x < -clip.w ? 1 : 0) | (clip.x > clip.w ? 2 : 0) | (clip.y < -clip.w ? 4 : 0)
+                    | (clip.y > clip.w ? 8 : 0) | (clip.z < -clip.w ? 16 : 0) | (clip.z > clip.w ? 32 : 0);
+        outsideAll &= outside;
+        if (clip.z < -clip.w || clip.w <= 0.0f)
+        {
+            crossesNear = true;
+            continue;
+        }
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * width_;
+        float y = (clip.y * invW * 0.5f + 0.5f) * height_;
+        float z = clip.z * invW * 0.5f + 0.5f;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, z);
+        farthest = std::max(farthest, z);
+    }
+
+    // all corners outside of the same frustum plane
+    if (outsideAll != 0)
+    {
+        stats_.frustumCulled++;
+        return false;
+    }
+    // the box reaches behind the camera, its screen bounds are unknown
+    if (crossesNear)
+    {
+        stats_.visible++;
+        return true;
+    }
+
+    int x0 = std::max((int)std::floor(minX), 0);
+    int y0 = std::max((int)std::floor(minY), 0);
+    int x1 = std::min((int)std::floor(maxX), width_ - 1);
+    int y1 = std::min((int)std::floor(maxY), height_ - 1);
+
+    // the level on which the bounds touch at most 2x2 texels
+    int level = 0;
+    while (level + 1 < (int)maxDepth_.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+
+    const std::vector<float>& levelMax = maxDepth_[level];
+    const std::vector<float>& levelMin = level == 0 ? maxDepth_[0] : minDepth_[level];
+    float occluderMax = 0.0f;
+    float occluderMin = 1.0f;
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+        {
+            size_t texel = (size_t)y * levelWidth_[level] + x;
+            occluderMax = std::max(occluderMax, levelMax[texel]);
+            occluderMin = std::min(occluderMin, levelMin[texel]);
+        }
+    }
+
+    if (nearest > occluderMax)
+    {
+        stats_.occlusionCulled++;
+        return false;
+    }
+    stats_.visible++;
+    if (farthest < occluderMin)
+        stats_.unoccluded++;
+    return true;
+}
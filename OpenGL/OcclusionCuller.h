@@ -0,0 +1,101 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// CPU occlusion culling with a hierarchical depth buffer.
+//
+// every frame: beginFrame with the camera, addOccluder/addOccluderBox for the large objects near
+// the camera, buildPyramid, then isVisible for every object before issuing its draw call.
+//
+// the occluders are rasterized into a small depth buffer, 8 pixels at a time with AVX2 where the
+// CPU has it. coverage is sampled at pixel centers like on the GPU and the depth written is the
+// farthest depth of the triangle inside the pixel, so an occluder never ends up nearer than it is.
+// gaps between occluders thinner than one pixel of the buffer count as closed though: objects only
+// visible through such gaps are culled, the usual trade of software occlusion culling. a larger
+// buffer makes those gaps smaller.
+//
+// the depth buffer is then reduced into a pyramid holding the min and max depth of every 2x2
+// block. an object is tested with its screen bounds and nearest depth on the level where the
+// bounds touch at most 2x2 texels: it is hidden when it is farther than the max depth of all of them.
+
+struct OcclusionStats
+{
+    int occluders = 0;          // occluders rasterized this frame
+    int occludersRejected = 0;  // too small on screen
+    int occluderTriangles = 0;  // front facing triangles rasterized
+    int tested = 0;
+    int frustumCulled = 0;
+    int occlusionCulled = 0;
+    int visible = 0;
+    int unoccluded = 0;         // visible objects in front of every occluder they overlap (min pyramid)
+    double rasterizeMs = 0.0;
+    double pyramidMs = 0.0;
+};
+
+class OcclusionCuller
+{
+public:
+    OcclusionCuller(int width = 256, int height = 128);
+
+    // clears the depth buffer and the statistics
+    void beginFrame(const glm::mat4& viewProjection);
+
+    // rasterizes the front facing (counter clockwise) triangles of an indexed mesh, unless its screen
+    // bounds cover less than minOccluderArea pixels of the buffer. returns whether it was used.
+    // triangles crossing the near plane are left out.
+    bool addOccluder(const glm::vec3* positions, const unsigned int* indices, int indexCount, const glm::mat4& model);
+    // the box boxMin..boxMax in model space
+    bool addOccluderBox(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+    // call after the last occluder and before the first isVisible
+    void buildPyramid();
+
+    // whether any part of the box boxMin..boxMax (in model space) may be visible
+    bool isVisible(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+    const OcclusionStats& stats() const { return stats_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    // level 0 of the pyramid, window depth (0..1) with row 0 at the bottom
+    const float* depthBuffer() const { return maxDepth_[0].data(); }
+
+    float minOccluderArea() const { return minOccluderArea_; }
+    void setMinOccluderArea(float pixels) { minOccluderArea_ = pixels; }
+
+private:
+    struct ScreenVertex
+    {
+        float x, y, z;
+        bool valid;             // in front of the near plane
+    };
+
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        bool edgeInclusive[3];
+        float zA, zB, zC;       // farthest depth inside the pixel around (x, y)
+        float zMax;             // farthest vertex
+        int minX, minY, maxX, maxY;
+    };
+
+    ScreenVertex project(const glm::mat4& mvp, const glm::vec3& position) const;
+    void rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2);
+    void rasterizeRowScalar(const Triangle& triangle, int y);
+    void rasterizeRowAVX2(const Triangle& triangle, int y);
+
+    int width_;
+    int height_;
+    bool avx2_;
+    float minOccluderArea_ = 64.0f;
+    glm::mat4 viewProjection_ = glm::mat4(1.0f);
+    bool mirrored_ = false;     // the current occluder's model matrix flips the winding
+
+    // level 0 is the depth buffer itself (min and max are the same there)
+    std::vector<std::vector<float>> minDepth_;
+    std::vector<std::vector<float>> maxDepth_;
+    std::vector<int> levelWidth_;
+    std::vector<int> levelHeight_;
+
+    OcclusionStats stats_;
+};
@@ -0,0 +1,151 @@
+#include "PipelineBuilder.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shaderLoad.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+
+#include <iostream>
+
+VertexLayout& VertexLayout::add(const std::string& attribute, GLint components, GLenum type, size_t offset, bool normalized)
+{
+    elements.push_back({ attribute, components, type, normalized ? (GLboolean)GL_TRUE : (GLboolean)GL_FALSE, false, offset });
+    return *this;
+}
+
+VertexLayout& VertexLayout::addInteger(const std::string& attribute, GLint components, GLenum type, size_t offset)
+{
+    elements.push_back({ attribute, components, type, (GLboolean)GL_FALSE, true, offset });
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::vertexBuffer(unsigned int buffer, const VertexLayout& layout)
+{
+    vertexBuffers_.push_back({ buffer, layout });
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::indexBuffer(unsigned int buffer)
+{
+    indexBuffer_ = buffer;
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::texture(const std::string& sampler, GLenum target, unsigned int texture, unsigned int samplerObject)
+{
+    textures_.push_back({ sampler, target, texture, samplerObject });
+    return *this;
+}
+
+PipelineBuilder& PipelineBuilder::uniformBuffer(const std::string& block, unsigned int buffer)
+{
+    uniformBuffers_.push_back({ block, buffer });
+    return *this;
+}
+
+Pipeline::Pipeline(const PipelineBuilder& builder)
+    : shader_(builder.shader_)
+{
+    const ShaderReflection& reflection = shader_->reflection;
+
+    // vertex array, every active input has to come from one of the buffers
+    // ---------------------------------------------------------------------
+    vao_ = CreateVertexArray();
+    std::vector<std::vector<VertexAttribFormat>> formats(builder.vertexBuffers_.size());
+    for (const ShaderAttribute& attribute : reflection.attributes)
+    {
+        bool found = false;
+        for (size_t i = 0; i < builder.vertexBuffers_.size() && !found; i++)
+        {
+            for (const VertexElement& element : builder.vertexBuffers_[i].layout.elements)
+            {
+                if (element.attribute != attribute.name)
+                    continue;
+                formats[i].push_back({ (GLuint)attribute.location, element.components, element.type, element.normalized, element.integer, (GLuint)element.offset });
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            std::cout << "ERROR::PIPELINE::ATTRIBUTE_WITHOUT_DATA " << attribute.name << " of " << shader_->vertexPath << std::endl;
+    }
+    for (size_t i = 0; i < builder.vertexBuffers_.size(); i++)
+    {
+        const PipelineBuilder::VertexBinding& binding = builder.vertexBuffers_[i];
+        if (!formats[i].empty())
+            SetVertexBuffer(vao_, (GLuint)i, binding.buffer, binding.layout.stride, formats[i].data(), (int)formats[i].size());
+    }
+    if (builder.indexBuffer_ != 0)
+        SetElementBuffer(vao_, builder.indexBuffer_);
+
+    // texture units and uniform block bindings, written into the program once
+    // ------------------------------------------------------------------------
+    GLState().useProgram(shader_->ID);
+    for (const PipelineBuilder::TextureBinding& binding : builder.textures_)
+    {
+        const ShaderUniform* sampler = reflection.findUniform(binding.sampler);
+        // a sampler the compiler removed needs no unit
+        if (sampler == nullptr || !sampler->sampler)
+            continue;
+        GLint unit = (GLint)textures_.size();
+        if (unit >= GLStateCache::TEXTURE_UNITS)
+        {
+            std::cout << "ERROR::PIPELINE::TOO_MANY_TEXTURES " << binding.sampler << std::endl;
+            break;
+        }
+        glUniform1i(sampler->location, unit);
+        textures_.push_back({ (GLenum)(GL_TEXTURE0 + unit), binding.target, binding.texture, binding.samplerObject });
+    }
+    for (const ShaderUniform& uniform : reflection.uniforms)
+    {
+        if (!uniform.sampler)
+            continue;
+        bool bound = false;
+        for (const PipelineBuilder::TextureBinding& binding : builder.textures_)
+            bound = bound || binding.sampler == uniform.name;
+        if (!bound)
+            std::cout << "ERROR::PIPELINE::SAMPLER_WITHOUT_TEXTURE " << uniform.name << " of " << shader_->fragmentPath << std::endl;
+    }
+
+    for (const PipelineBuilder::BlockBinding& binding : builder.uniformBuffers_)
+    {
+        const ShaderUniformBlock* block = reflection.findUniformBlock(binding.block);
+        if (block == nullptr)
+            continue;
+        GLuint index = (GLuint)uniformBuffers_.size();
+        glUniformBlockBinding(shader_->ID, block->index, index);
+        uniformBuffers_.push_back({ index, binding.buffer });
+    }
+    for (const ShaderUniformBlock& block : reflection.uniformBlocks)
+    {
+        bool bound = false;
+        for (const PipelineBuilder::BlockBinding& binding : builder.uniformBuffers_)
+            bound = bound || binding.block == block.name;
+        if (!bound)
+            std::cout << "ERROR::PIPELINE::BLOCK_WITHOUT_BUFFER " << block.name << std::endl;
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    GLState().deleteVertexArrays(1, &vao_);
+}
+
+void Pipeline::bind() const
+{
+    GLState().useProgram(shader_->ID);
+    GLState().bindVertexArray(vao_);
+    for (const TextureUnit& texture : textures_)
+    {
+        GLState().bindTexture(texture.unit, texture.target, texture.texture);
+        GLState().bindSampler(texture.unit - GL_TEXTURE0, texture.sampler);
+    }
+    for (const BufferBinding& buffer : uniformBuffers_)
+        GLState().bindBufferBase(GL_UNIFORM_BUFFER, buffer.index, buffer.buffer);
+}
+
+GLint Pipeline::uniformLocation(const std::string& name) const
+{
+    return shader_->reflection.uniformLocation(name);
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class Shader;
+
+// how the vertices of one buffer are laid out. elements are named after the vertex shader
+// inputs they feed (aPos, aTexCoord, ...); PipelineBuilder looks the locations up in the
+// reflection of the shader, so the layout (location = N) of the shaders and the data stay
+// in sync by themselves.
+struct VertexElement
+{
+    std::string attribute;
+    GLint components;
+    GLenum type;            // GL_FLOAT, GL_UNSIGNED_SHORT, GL_HALF_FLOAT, ...
+    GLboolean normalized;
+    bool integer;           // glVertexAttribIPointer, for int and uint inputs
+    size_t offset;
+};
+
+struct VertexLayout
+{
+    GLsizei stride = 0;
+    std::vector<VertexElement> elements;
+
+    explicit VertexLayout(GLsizei stride = 0) : stride(stride) {}
+    VertexLayout& add(const std::string& attribute, GLint components, GLenum type, size_t offset, bool normalized = false);
+    VertexLayout& addInteger(const std::string& attribute, GLint components, GLenum type, size_t offset);
+};
+
+class Pipeline;
+
+// collects the buffers and textures a shader is drawn with, Pipeline turns them into GL state
+// once at load time:
+//   Pipeline cube(PipelineBuilder(shader)
+//       .vertexBuffer(VBO, layout).texture("ourTexture", GL_TEXTURE_2D, texture, samplers.get(state)));
+// the texture units and uniform block bindings are handed out in the order of the calls.
+// a texture without a sampler object (0) is filtered with its own parameters.
+class PipelineBuilder
+{
+public:
+    explicit PipelineBuilder(Shader& shader) : shader_(&shader) {}
+
+    PipelineBuilder& vertexBuffer(unsigned int buffer, const VertexLayout& layout);
+    PipelineBuilder& indexBuffer(unsigned int buffer);
+    PipelineBuilder& texture(const std::string& sampler, GLenum target, unsigned int texture, unsigned int samplerObject = 0);
+    PipelineBuilder& uniformBuffer(const std::string& block, unsigned int buffer);
+
+private:
+    friend class Pipeline;
+
+    struct VertexBinding
+    {
+        unsigned int buffer;
+        VertexLayout layout;
+    };
+    struct TextureBinding
+    {
+        std::string sampler;
+        GLenum target;
+        unsigned int texture;
+        unsigned int samplerObject;
+    };
+    struct BlockBinding
+    {
+        std::string block;
+        unsigned int buffer;
+    };
+
+    Shader* shader_;
+    std::vector<VertexBinding> vertexBuffers_;
+    unsigned int indexBuffer_ = 0;
+    std::vector<TextureBinding> textures_;
+    std::vector<BlockBinding> uniformBuffers_;
+};
+
+// a shader with its vertex array, texture units and uniform buffers. the vertex array is
+// created from the reflected attribute locations, the sampler units and block bindings are
+// written into the program once, so a draw only has to bind() and set its own uniforms.
+// inputs of the shader that nothing was given for are reported on std::cout.
+class Pipeline
+{
+public:
+    explicit Pipeline(const PipelineBuilder& builder);
+    // deletes the vertex array, the buffers, textures and the shader belong to the caller
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // program, vertex array, textures, samplers and uniform buffers, through the state cache
+    void bind() const;
+
+    Shader& shader() const { return *shader_; }
+    unsigned int vertexArray() const { return vao_; }
+    // looked up in the reflection, meant to be kept instead of asking by name every frame
+    GLint uniformLocation(const std::string& name) const;
+
+private:
+    struct TextureUnit
+    {
+        GLenum unit;        // GL_TEXTURE0 + i
+        GLenum target;
+        unsigned int texture;
+        unsigned int sampler;
+    };
+    struct BufferBinding
+    {
+        GLuint index;
+        unsigned int buffer;
+    };
+
+    Shader* shader_;
+    unsigned int vao_ = 0;
+    std::vector<TextureUnit> textures_;
+    std::vector<BufferBinding> uniformBuffers_;
+};
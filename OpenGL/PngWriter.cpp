@@ -0,0 +1,250 @@
+#include "PngWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+// deflate (RFC 1951) with the fixed codes
+// -----------------------------------------
+static const int MIN_MATCH = 4;     // the format allows 3, but the matcher hashes 4 bytes
+static const int MAX_MATCH = 258;
+static const size_t WINDOW_SIZE = 32768;
+static const int HASH_BITS = 15;
+
+static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// deflate packs values starting at the least significant bit, Huffman codes most significant bit first
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out_(out) {}
+
+    void put(uint32_t value, int count)
+    {
+        bits_ |= value << count_;
+        count_ += count;
+        while (count_ >= 8)
+        {
+            out_.push_back((unsigned char)bits_);
+            bits_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void putCode(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++)
+            reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        put(reversed, length);
+    }
+
+    void flush()
+    {
+        if (count_ > 0)
+            out_.push_back((unsigned char)bits_);
+        bits_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out_;
+    uint32_t bits_ = 0;
+    int count_ = 0;
+};
+
+static void PutSymbol(BitWriter& writer, int symbol)
+{
+    if (symbol < 144)
+        writer.putCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writer.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writer.putCode(symbol - 256, 7);
+    else
+        writer.putCode(0xC0 + symbol - 280, 8);
+}
+
+static void PutMatch(BitWriter& writer, int length, size_t distance)
+{
+    int code = 28;
+    while (lengthBase[code] > length)
+        code--;
+    PutSymbol(writer, 257 + code);
+    writer.put(length - lengthBase[code], lengthExtra[code]);
+
+    code = 29;
+    while (distanceBase[code] > distance)
+        code--;
+    writer.putCode(code, 5);
+    writer.put((uint32_t)(distance - distanceBase[code]), distanceExtra[code]);
+}
+
+static uint32_t Hash4(const unsigned char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void Deflate(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+    BitWriter writer(out);
+    writer.put(1, 1);   // final block
+    writer.put(1, 2);   // fixed Huffman codes
+
+    // last position + 1 of every hash, 0 = none yet
+    std::vector<size_t> table((size_t)1 << HASH_BITS, 0);
+    size_t i = 0;
+    while (i < size)
+    {
+        int length = 0;
+        size_t distance = 0;
+        if (i + MIN_MATCH <= size)
+        {
+            uint32_t hash = Hash4(data + i);
+            size_t candidate = table[hash];
+            table[hash] = i + 1;
+            if (candidate != 0 && i - (candidate - 1) <= WINDOW_SIZE)
+            {
+                const unsigned char* match = data + candidate - 1;
+                size_t limit = size - i < (size_t)MAX_MATCH ? size - i : (size_t)MAX_MATCH;
+                size_t n = 0;
+                while (n < limit && match[n] == data[i + n])
+                    n++;
+                if (n >= (size_t)MIN_MATCH)
+                {
+                    length = (int)n;
+                    distance = data + i - match;
+                }
+            }
+        }
+
+        if (length == 0)
+        {
+            PutSymbol(writer, data[i]);
+            i++;
+            continue;
+        }
+        PutMatch(writer, length, distance);
+        // the positions inside the match go into the table as well, later rows match against them
+        size_t end = i + length;
+        for (i++; i < end; i++)
+        {
+            if (i + MIN_MATCH <= size)
+                table[Hash4(data + i)] = i + 1;
+        }
+    }
+    PutSymbol(writer, 256);
+    writer.flush();
+}
+
+// png container
+// -------------
+static uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc)
+{
+    static uint32_t table[256];
+    static const bool initialized = [] {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t Adler32(const unsigned char* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    while (size > 0)
+    {
+        // 5552 bytes is the most that can be summed before b overflows
+        size_t block = size < 5552 ? size : 5552;
+        for (size_t i = 0; i < block; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        size -= block;
+    }
+    return (b << 16) | a;
+}
+
+static void PutBigEndian(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static void PutChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size)
+{
+    PutBigEndian(out, (uint32_t)size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    PutBigEndian(out, Crc32(&out[start], size + 4, 0));
+}
+
+std::vector<unsigned char> EncodePng(const unsigned char* pixels, int width, int height, size_t stride, int channels, bool bottomUp)
+{
+    // every row gets the Sub filter: the difference to the pixel on its left, which turns
+    // gradients and flat areas into runs the matcher finds
+    size_t rowBytes = (size_t)width * channels;
+    std::vector<unsigned char> filtered((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = pixels + (size_t)(bottomUp ? height - 1 - y : y) * stride;
+        unsigned char* out = &filtered[(rowBytes + 1) * y];
+        out[0] = 1;
+        for (size_t x = 0; x < rowBytes; x++)
+            out[1 + x] = (unsigned char)(row[x] - (x >= (size_t)channels ? row[x - channels] : 0));
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.push_back(0x78);   // deflate with a 32k window
+    zlib.push_back(0x01);   // no dictionary, header check bits
+    Deflate(filtered.data(), filtered.size(), zlib);
+    PutBigEndian(zlib, Adler32(filtered.data(), filtered.size()));
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)width);
+    PutBigEndian(header, (uint32_t)height);
+    header.push_back(8);                        // bits per channel
+    header.push_back(channels == 4 ? 6 : 2);    // RGBA or RGB
+    header.push_back(0);                        // deflate
+    header.push_back(0);                        // adaptive filtering
+    header.push_back(0);                        // not interlaced
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> png(signature, signature + 8);
+    PutChunk(png, "IHDR", header.data(), header.size());
+    PutChunk(png, "IDAT", zlib.data(), zlib.size());
+    PutChunk(png, "IEND", NULL, 0);
+    return png;
+}
+
+bool WritePng(const std::string& path, const unsigned char* pixels, int width, int height, size_t stride, int channels, bool bottomUp)
+{
+    std::vector<unsigned char> png = EncodePng(pixels, width, height, stride, channels, bottomUp);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    file.write((const char*)png.data(), (std::streamsize)png.size());
+    return (bool)file;
+}
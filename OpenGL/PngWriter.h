@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// minimal PNG encoder for screenshots and captured frames: 8 bit RGB or RGBA, the Sub filter on
+// every row and a single deflate block with the fixed Huffman codes of the format, fed by a greedy
+// single-probe matcher like the one in LZ4Block.h. the files are larger than zlib would make them,
+// the point is that there is no dependency and the encoder is quick.
+
+// encodes channels (3 or 4) bytes per pixel, rows stride bytes apart.
+// bottomUp takes the rows in the order glReadPixels returns them.
+std::vector<unsigned char> EncodePng(const unsigned char* pixels, int width, int height, size_t stride, int channels, bool bottomUp);
+
+// EncodePng into a file, false if it could not be written
+bool WritePng(const std::string& path, const unsigned char* pixels, int width, int height, size_t stride, int channels, bool bottomUp);
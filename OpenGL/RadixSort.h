@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// maps a float to an unsigned key that sorts the same way (negative numbers included)
+inline uint32_t FloatToRadixKey(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// LSD radix sort with 8 bits per pass for unsigned integer keys (uint32_t, uint64_t).
+// the sort is stable and applies the same permutation to a value per key (usually the index
+// of the draw the key belongs to). all histograms are counted in one read of the keys and passes
+// in which every key has the same byte are skipped, so short keys in wide types cost nothing extra.
+// the scratch buffers are kept between calls, sorting every frame doesn't allocate.
+template <typename Key>
+class RadixSorter
+{
+public:
+    void sort(std::vector<Key>& keys, std::vector<uint32_t>& values)
+    {
+        const size_t count = keys.size();
+        const int passes = (int)sizeof(Key);
+        if (count < 2)
+            return;
+
+        size_t histograms[sizeof(Key)][256] = {};
+        for (size_t i = 0; i < count; i++)
+        {
+            Key key = keys[i];
+            for (int pass = 0; pass < passes; pass++)
+                histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+
+        keyScratch_.resize(count);
+        valueScratch_.resize(count);
+        for (int pass = 0; pass < passes; pass++)
+        {
+            size_t* histogram = histograms[pass];
+            if (histogram[(keys[0] >> (pass * 8)) & 0xFF] == count)
+                continue;
+
+            // bucket counts to bucket start offsets
+            size_t offset = 0;
+            for (int bucket = 0; bucket < 256; bucket++)
+            {
+                size_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t target = histogram[(keys[i] >> (pass * 8)) & 0xFF]++;
+                keyScratch_[target] = keys[i];
+                valueScratch_[target] = values[i];
+            }
+            keys.swap(keyScratch_);
+            values.swap(valueScratch_);
+        }
+    }
+
+private:
+    std::vector<Key> keyScratch_;
+    std::vector<uint32_t> valueScratch_;
+};
@@ -0,0 +1,129 @@
+#include "RenderTarget.h"
+#include "GLResources.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+static GLenum DepthAttachment(GLenum depthFormat)
+{
+    return depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+static bool CheckFramebuffer(const char* name)
+{
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status == GL_FRAMEBUFFER_COMPLETE)
+        return true;
+    std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE " << name << " status 0x" << std::hex << status << std::dec << std::endl;
+    return false;
+}
+
+// a single sampled color texture, sampled with linear filtering and without mipmaps
+static GLuint CreateColorTexture(GLenum format, int width, int height)
+{
+    GLuint texture = CreateTexture2D(1, format, width, height);
+    SetTextureParameter(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    SetTextureParameter(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    SetTextureParameter(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    SetTextureParameter(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+RenderTarget::RenderTarget(int width, int height, int samples, GLenum colorFormat, GLenum depthFormat)
+    : width_(width), height_(height), samples_(samples)
+{
+    GLint maxSamples = 1;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    if (samples_ > maxSamples)
+        samples_ = maxSamples;
+    if (samples_ < 1)
+        samples_ = 1;
+    bool multisampled = samples_ > 1;
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    if (colorFormat == GL_NONE)
+    {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    else if (multisampled)
+    {
+        glGenRenderbuffers(1, &colorRenderbuffer_);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer_);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, colorFormat, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer_);
+    }
+    else
+    {
+        colorTexture_ = CreateColorTexture(colorFormat, width, height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_, 0);
+    }
+    if (depthFormat != GL_NONE)
+    {
+        glGenRenderbuffers(1, &depthRenderbuffer_);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer_);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, multisampled ? samples_ : 0, depthFormat, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, DepthAttachment(depthFormat), GL_RENDERBUFFER, depthRenderbuffer_);
+    }
+    complete_ = CheckFramebuffer("render target");
+
+    // the texture the multisampled color is resolved into
+    if (multisampled && colorFormat != GL_NONE)
+    {
+        colorTexture_ = CreateColorTexture(colorFormat, width, height);
+        glGenFramebuffers(1, &resolveFramebuffer_);
+        glBindFramebuffer(GL_FRAMEBUFFER, resolveFramebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_, 0);
+        complete_ = CheckFramebuffer("resolve target") && complete_;
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTarget::~RenderTarget()
+{
+    glDeleteFramebuffers(1, &framebuffer_);
+    if (resolveFramebuffer_ != 0)
+        glDeleteFramebuffers(1, &resolveFramebuffer_);
+    if (colorRenderbuffer_ != 0)
+        glDeleteRenderbuffers(1, &colorRenderbuffer_);
+    if (depthRenderbuffer_ != 0)
+        glDeleteRenderbuffers(1, &depthRenderbuffer_);
+    if (colorTexture_ != 0)
+        GLState().deleteTextures(1, &colorTexture_);
+}
+
+void RenderTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    GLState().viewport(0, 0, width_, height_);
+}
+
+void RenderTarget::bindDefault(int width, int height)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState().viewport(0, 0, width, height);
+}
+
+void RenderTarget::resolve()
+{
+    if (resolveFramebuffer_ == 0)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+        return;
+    }
+    // the sizes match, so the blit only averages the samples of every pixel
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFramebuffer_);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFramebuffer_);
+}
+
+void RenderTarget::blitToDefault(int width, int height)
+{
+    resolve();
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    GLenum filter = width == width_ && height == height_ ? GL_NEAREST : GL_LINEAR;
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width, height, GL_COLOR_BUFFER_BIT, filter);
+}
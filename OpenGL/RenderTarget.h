@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+
+// an offscreen framebuffer with a color and a depth attachment.
+//
+// single sampled, the color attachment is a texture that can be sampled once rendering is done.
+// multisampled, both attachments are multisampled renderbuffers and resolve() blits the color into
+// a single sampled texture with glBlitFramebuffer, which is what colorTexture() returns then.
+// only the color is resolved, the multisampled depth stays with the target.
+class RenderTarget
+{
+public:
+    // colorFormat GL_NONE renders depth only, depthFormat GL_NONE leaves out the depth buffer.
+    // samples is clamped to GL_MAX_SAMPLES, 1 is no multisampling.
+    RenderTarget(int width, int height, int samples = 1, GLenum colorFormat = GL_RGBA8, GLenum depthFormat = GL_DEPTH_COMPONENT24);
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    // false if the driver refused the combination of formats, the status is printed
+    bool complete() const { return complete_; }
+
+    // binds the framebuffer for drawing and reading and sets the viewport to its size
+    void bind();
+
+    // binds the window's framebuffer again with a viewport of the given size
+    static void bindDefault(int width, int height);
+
+    // multisampled: resolves the color into colorTexture(). either way the single sampled color
+    // is bound as GL_READ_FRAMEBUFFER afterwards, for glReadPixels or a FrameReadback.
+    void resolve();
+
+    // resolves and copies the color to the window's framebuffer, scaled to width x height. like
+    // resolve() it leaves the single sampled color bound as GL_READ_FRAMEBUFFER, so a
+    // FrameReadback can read the frame right after it was presented.
+    void blitToDefault(int width, int height);
+
+    unsigned int colorTexture() const { return colorTexture_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int samples() const { return samples_; }
+
+private:
+    int width_;
+    int height_;
+    int samples_;
+    bool complete_ = false;
+    unsigned int framebuffer_ = 0;          // drawn into
+    unsigned int resolveFramebuffer_ = 0;   // multisampled only, holds colorTexture_
+    unsigned int colorTexture_ = 0;
+    unsigned int colorRenderbuffer_ = 0;    // multisampled only
+    unsigned int depthRenderbuffer_ = 0;
+};
@@ -0,0 +1,269 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+#include "Scene.h"
+#include "PipelineBuilder.h"
+#include "RenderTarget.h"
+#include "FrameReadback.h"
+#include "FrameCapture.h"
+
+// offscreen rendering with MSAA and frame capture.
+//
+// usage: RenderTargets [png <directory> | yuv "<command>"]
+//   png writes every captured frame to <directory>/frame_00000.png, ... (the directory has to exist)
+//   yuv pipes raw I420 frames into the command, e.g.
+//       RenderTargets yuv "ffmpeg -y -f rawvideo -pix_fmt yuv420p -s 800x600 -r 60 -i - capture.mp4"
+//
+// the cube scene is rendered into a multisampled RenderTarget of SCR_WIDTH x SCR_HEIGHT, resolved
+// and blitted to the window. while capturing, every resolved frame is read back through the PBO
+// ring of a FrameReadback and handed to a FrameCapture, which encodes and writes on its own thread.
+// once a second the frame time, the readback stalls and the frames written are printed.
+//
+// keys: M cycles the samples of the target (1, 4, 8)
+//       C starts and stops capturing
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const int SAMPLE_COUNTS[] = { 1, 4, 8 };
+
+int sampleIndex = 1;
+bool targetChanged = true;
+bool captureToggled = false;
+
+int main(int argc, char** argv)
+{
+    CaptureFormat captureFormat = CAPTURE_PNG;
+    std::string captureTarget;
+    if (argc == 3 && (strcmp(argv[1], "png") == 0 || strcmp(argv[1], "yuv") == 0))
+    {
+        captureFormat = strcmp(argv[1], "png") == 0 ? CAPTURE_PNG : CAPTURE_YUV;
+        captureTarget = argv[2];
+    }
+    else if (argc != 1)
+    {
+        std::cout << "usage: RenderTargets [png <directory> | yuv \"<command>\"]" << std::endl;
+        return -1;
+    }
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+
+    {
+        Scene scene = CreateCubeScene();
+        Shader shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+        // set every draw, so resolved once
+        UniformHandle modelUniform = shader.uniform("model"_u);
+        UniformHandle viewUniform = shader.uniform("view"_u);
+        UniformHandle projectionUniform = shader.uniform("projection"_u);
+        GLuint VBO = CreateBuffer((GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data());
+        GLsizei vertexCount = (GLsizei)(scene.vertices.size() / 5);
+
+        stbi_set_flip_vertically_on_load(true);
+        GLuint textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        SamplerCache samplers;
+        SamplerState trilinear;
+        trilinear.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        GLuint sampler = samplers.get(trilinear);
+
+        VertexLayout layout(5 * sizeof(float));
+        layout.add("aPos", 3, GL_FLOAT, 0).add("aTexCoord", 2, GL_FLOAT, 3 * sizeof(float));
+        Pipeline cubes(PipelineBuilder(shader).vertexBuffer(VBO, layout)
+            .texture("ourTexture", GL_TEXTURE_2D, textures[0], sampler).texture("texture2", GL_TEXTURE_2D, textures[1], sampler));
+
+        std::unique_ptr<RenderTarget> target;
+        std::unique_ptr<FrameCapture> capture;
+        std::unique_ptr<FrameReadback> readback;
+
+        int frames = 0;
+        double frameMilliseconds = 0.0;
+        auto reportStart = std::chrono::steady_clock::now();
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            auto frameStart = std::chrono::steady_clock::now();
+
+            // input
+            // -----
+            processInput(window);
+
+            if (targetChanged)
+            {
+                targetChanged = false;
+                target.reset(new RenderTarget(SCR_WIDTH, SCR_HEIGHT, SAMPLE_COUNTS[sampleIndex]));
+                std::cout << "render target " << target->width() << "x" << target->height() << ", " << target->samples() << " samples"
+                    << (target->complete() ? "" : ", incomplete") << std::endl;
+            }
+            if (captureToggled)
+            {
+                captureToggled = false;
+                if (readback)
+                {
+                    // the frames still in flight belong to the capture as well
+                    readback->finish();
+                    std::cout << "capture stopped, readback stalls: " << readback->stalls() << std::endl;
+                    readback.reset();
+                    capture.reset();
+                }
+                else if (captureTarget.empty())
+                {
+                    std::cout << "nothing to capture to, see the usage at the top of RenderTargets.cpp" << std::endl;
+                }
+                else
+                {
+                    capture.reset(new FrameCapture(captureFormat, captureTarget, SCR_WIDTH, SCR_HEIGHT));
+                    FrameCapture* writer = capture.get();
+                    readback.reset(new FrameReadback(SCR_WIDTH, SCR_HEIGHT, [writer](const unsigned char* pixels, unsigned long long) {
+                        writer->submit(pixels);
+                    }));
+                    std::cout << "capturing to " << captureTarget << std::endl;
+                }
+            }
+
+            // render
+            // ------
+            target->bind();
+            glClearColor(scene.clearColor.x, scene.clearColor.y, scene.clearColor.z, scene.clearColor.w);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            cubes.bind();
+            glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            shader.set(viewUniform, view);
+            shader.set(projectionUniform, projection);
+            for (size_t i = 0; i < scene.models.size(); i++)
+            {
+                glm::mat4 model = glm::rotate(scene.models[i], (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
+                shader.set(modelUniform, model);
+                glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+            }
+
+            // the resolve leaves the single sampled color bound for reading, the readback takes it from there
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            target->blitToDefault(width, height);
+            if (readback)
+            {
+                readback->read();
+                readback->poll();
+            }
+            RenderTarget::bindDefault(width, height);
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            frames++;
+            frameMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (std::chrono::steady_clock::now() - reportStart >= std::chrono::seconds(1))
+            {
+                std::cout << frameMilliseconds / frames << " ms per frame";
+                if (readback)
+                    std::cout << ", readback stalls " << readback->stalls() << ", " << capture->written() << " frames written, writer waits "
+                        << capture->waits() << (capture->ok() ? "" : ", capture failed");
+                std::cout << std::endl;
+                frames = 0;
+                frameMilliseconds = 0.0;
+                reportStart = std::chrono::steady_clock::now();
+            }
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        if (readback)
+            readback->finish();
+        GLState().deleteProgram(shader.ID);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // react on the key press only, not every frame the key is down
+    static bool mWasPressed = false, cWasPressed = false;
+    bool mPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+    bool cPressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+    if (mPressed && !mWasPressed)
+    {
+        sampleIndex = (sampleIndex + 1) % (int)(sizeof(SAMPLE_COUNTS) / sizeof(SAMPLE_COUNTS[0]));
+        targetChanged = true;
+    }
+    if (cPressed && !cWasPressed)
+        captureToggled = true;
+    mWasPressed = mPressed;
+    cWasPressed = cPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // the render loop sets the viewport of the window every frame, the target has its own
+}
@@ -0,0 +1,260 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+#include "Scene.h"
+#include "PipelineBuilder.h"
+
+// resource creation benchmark, bind-to-edit against direct state access.
+//
+// usage: ResourceCreation [objects]
+//
+// creates objects (256 by default) cube meshes and textures the way a level load would: a vertex
+// buffer, a vertex array and a 256x256 texture with its mip chain, wrap and filter parameters per
+// object. first on the 3.3 path of GLResources, then with direct state access if the context has
+// it. a 4.5 context is asked for first, the samples' 3.3 context is the fallback.
+// the GL calls per object, the CPU time and the time until glFinish returns are printed; R runs
+// the benchmark again. the cubes are drawn through a Pipeline made from the same functions.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const int TEXTURE_SIZE = 256;
+const int TEXTURE_LEVELS = 9;       // 256 down to 1
+
+bool benchmarkRequested = true;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// creates and deletes objectCount meshes and textures on the current path of GLResources
+static void RunBenchmark(const char* name, int objectCount, const Scene& scene, const std::vector<unsigned char>& pixels)
+{
+    const VertexAttribFormat attributes[] = {
+        { 0, 3, GL_FLOAT, GL_FALSE, false, 0 },
+        { 1, 2, GL_FLOAT, GL_FALSE, false, 3 * sizeof(float) },
+    };
+    std::vector<GLuint> buffers, vertexArrays, textures;
+
+    GLState().setStatistics(true);
+    ResetResourceStats();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < objectCount; i++)
+    {
+        GLuint buffer = CreateBuffer((GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data());
+        GLuint vao = CreateVertexArray();
+        SetVertexBuffer(vao, 0, buffer, 5 * sizeof(float), attributes, 2);
+
+        GLuint texture = CreateTexture2D(TEXTURE_LEVELS, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE);
+        UploadTexture2D(texture, 0, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        SetTextureParameter(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        SetTextureParameter(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        SetTextureParameter(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        SetTextureParameter(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GenerateMipmaps(texture);
+
+        buffers.push_back(buffer);
+        vertexArrays.push_back(vao);
+        textures.push_back(texture);
+    }
+    double cpu = MillisecondsSince(start);
+    glFinish();
+    double finished = MillisecondsSince(start);
+    GLState().endFrame();
+    GLState().setStatistics(false);
+
+    const GLResourceStats& stats = ResourceStats();
+    std::cout << name << ": " << stats.objects << " objects, " << stats.calls << " GL calls ("
+        << (double)stats.calls / objectCount << " per mesh and texture, " << GLState().lastFrame().elided
+        << " binds dropped by the state cache), " << cpu << " ms CPU, " << finished << " ms until finished" << std::endl;
+
+    GLState().deleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data());
+    GLState().deleteBuffers((GLsizei)buffers.size(), buffers.data());
+    GLState().deleteTextures((GLsizei)textures.size(), textures.data());
+}
+
+int main(int argc, char** argv)
+{
+    int objectCount = argc > 1 ? std::atoi(argv[1]) : 256;
+    if (objectCount < 1)
+    {
+        std::cout << "usage: ResourceCreation [objects]" << std::endl;
+        return -1;
+    }
+
+    // glfw: initialize and configure
+    // ------------------------------
+    // 4.5 for direct state access, the samples' 3.3 if the driver has no 4.5
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    }
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+    if (!HasDirectStateAccess())
+        std::cout << "no direct state access in this context, only the 3.3 path is measured" << std::endl;
+
+    {
+        Scene scene = CreateCubeScene();
+
+        // a checkerboard, the content doesn't matter for the upload
+        std::vector<unsigned char> pixels((size_t)TEXTURE_SIZE * TEXTURE_SIZE * 4);
+        for (int y = 0; y < TEXTURE_SIZE; y++)
+            for (int x = 0; x < TEXTURE_SIZE; x++)
+            {
+                unsigned char value = ((x / 32 + y / 32) & 1) ? 255 : 64;
+                unsigned char* pixel = &pixels[((size_t)y * TEXTURE_SIZE + x) * 4];
+                pixel[0] = pixel[1] = pixel[2] = value;
+                pixel[3] = 255;
+            }
+
+        // the drawn cubes, created through the same functions
+        // ---------------------------------------------------
+        Shader shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+        // set every draw, so resolved once
+        UniformHandle modelUniform = shader.uniform("model"_u);
+        UniformHandle viewUniform = shader.uniform("view"_u);
+        UniformHandle projectionUniform = shader.uniform("projection"_u);
+        GLuint VBO = CreateBuffer((GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data());
+        GLsizei vertexCount = (GLsizei)(scene.vertices.size() / 5);
+
+        stbi_set_flip_vertically_on_load(true);
+        GLuint textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+
+        VertexLayout layout(5 * sizeof(float));
+        layout.add("aPos", 3, GL_FLOAT, 0).add("aTexCoord", 2, GL_FLOAT, 3 * sizeof(float));
+        Pipeline cubes(PipelineBuilder(shader).vertexBuffer(VBO, layout)
+            .texture("ourTexture", GL_TEXTURE_2D, textures[0], sampler).texture("texture2", GL_TEXTURE_2D, textures[1], sampler));
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+
+            if (benchmarkRequested)
+            {
+                benchmarkRequested = false;
+                SetDirectStateAccess(false);
+                RunBenchmark("bind to edit", objectCount, scene, pixels);
+                SetDirectStateAccess(true);
+                if (HasDirectStateAccess())
+                    RunBenchmark("direct state access", objectCount, scene, pixels);
+            }
+
+            // render
+            // ------
+            glClearColor(scene.clearColor.x, scene.clearColor.y, scene.clearColor.z, scene.clearColor.w);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            cubes.bind();
+            glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            shader.set(viewUniform, view);
+            shader.set(projectionUniform, projection);
+            for (size_t i = 0; i < scene.models.size(); i++)
+            {
+                glm::mat4 model = glm::rotate(scene.models[i], (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
+                shader.set(modelUniform, model);
+                glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteProgram(shader.ID);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // run on the key press only, not every frame the key is down
+    static bool rWasPressed = false;
+    bool rPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+    if (rPressed && !rWasPressed)
+        benchmarkRequested = true;
+    rWasPressed = rPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
@@ -0,0 +1,46 @@
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+
+bool operator==(const SamplerState& a, const SamplerState& b)
+{
+    return a.minFilter == b.minFilter && a.magFilter == b.magFilter && a.wrapS == b.wrapS
+        && a.wrapT == b.wrapT && a.maxAnisotropy == b.maxAnisotropy && a.lodBias == b.lodBias;
+}
+
+SamplerCache::~SamplerCache()
+{
+    for (const Entry& entry : entries_)
+        GLState().deleteSamplers(1, &entry.sampler);
+}
+
+GLuint SamplerCache::get(const SamplerState& state)
+{
+    // clamped first, so states that only differ above the limit share a sampler
+    SamplerState key = state;
+    float maxAnisotropy = MaxTextureAnisotropy();
+    if (key.maxAnisotropy > maxAnisotropy)
+        key.maxAnisotropy = maxAnisotropy;
+    if (key.maxAnisotropy < 1.0f)
+        key.maxAnisotropy = 1.0f;
+
+    for (const Entry& entry : entries_)
+    {
+        if (entry.state == key)
+            return entry.sampler;
+    }
+
+    GLuint sampler;
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, key.minFilter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, key.magFilter);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, key.wrapS);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, key.wrapT);
+    // without the extension the parameter doesn't exist, and 1 is what the sampler has anyway
+    if (key.maxAnisotropy > 1.0f)
+        glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, key.maxAnisotropy);
+    if (key.lodBias != 0.0f)
+        glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, key.lodBias);
+    entries_.push_back({ key, sampler });
+    return sampler;
+}
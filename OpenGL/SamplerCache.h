@@ -0,0 +1,44 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+// how a texture is filtered and wrapped, kept in a sampler object instead of the texture so the
+// same texture can be read in different ways and the parameters aren't set per texture
+struct SamplerState
+{
+    GLenum minFilter = GL_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    float maxAnisotropy = 1.0f;     // 1 is off, clamped to MaxTextureAnisotropy()
+    float lodBias = 0.0f;           // added to the mip level the lookup picks
+};
+
+bool operator==(const SamplerState& a, const SamplerState& b);
+
+// one sampler object per distinct SamplerState, created the first time the state is asked for.
+// a scene only has a handful, so they are found by comparing. bind them with
+// GLState().bindSampler next to the texture. needs LoadGLExtensions first.
+class SamplerCache
+{
+public:
+    SamplerCache() = default;
+    // deletes the samplers, so it has to go before the context does
+    ~SamplerCache();
+
+    SamplerCache(const SamplerCache&) = delete;
+    SamplerCache& operator=(const SamplerCache&) = delete;
+
+    GLuint get(const SamplerState& state);
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry
+    {
+        SamplerState state;
+        GLuint sampler;
+    };
+    std::vector<Entry> entries_;
+};
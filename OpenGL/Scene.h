@@ -0,0 +1,21 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// renderer independent description of the textured cube samples (CoordinateSystem_Z_Buffer.cpp,
+// Camera.cpp), so the same scene can go through GL or the software rasterizer (see SceneRenderer.h).
+struct Scene
+{
+    std::vector<float> vertices;        // triangle list, x y z u v per vertex
+    std::vector<glm::mat4> models;      // the vertices are drawn once per model matrix
+    std::string texturePaths[2];        // ourTexture and texture2 of fragmentCoordianteSystem.shader
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    float textureMix = 0.2f;            // hardcoded in fragmentCoordianteSystem.shader
+    glm::vec4 clearColor = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+};
+
+// the ten rotated cubes, with the assets below the working directory
+Scene CreateCubeScene();
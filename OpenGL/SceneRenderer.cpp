@@ -0,0 +1,118 @@
+#include "SceneRenderer.h"
+#include "TextureLoad.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+#include "shaderLoad.h"
+
+GLSceneRenderer::GLSceneRenderer(const Scene& scene)
+    : shader_(new Shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str()))
+{
+    vertexCount_ = (int)scene.vertices.size() / 5;
+
+    glGenVertexArrays(1, &VAO_);
+    glGenBuffers(1, &VBO_);
+    GLState().bindVertexArray(VAO_);
+    GLState().bindBuffer(GL_ARRAY_BUFFER, VBO_);
+    glBufferData(GL_ARRAY_BUFFER, scene.vertices.size() * sizeof(float), scene.vertices.data(), GL_STATIC_DRAW);
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // 4 channels like the software backend
+    for (int i = 0; i < 2; i++)
+        textures_[i] = LoadImmutableTexture2D(scene.texturePaths[i], 4);
+    // bilinear from the first level, which is what the software backend does too
+    sampler_ = samplers_.get(SamplerState());
+
+    shader_->use();
+    shader_->setInt("ourTexture", 0);
+    shader_->setInt("texture2", 1);
+}
+
+GLSceneRenderer::~GLSceneRenderer()
+{
+    GLState().deleteVertexArrays(1, &VAO_);
+    GLState().deleteBuffers(1, &VBO_);
+    GLState().deleteTextures(2, textures_);
+    GLState().deleteProgram(shader_->ID);
+}
+
+void GLSceneRenderer::render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width, int height)
+{
+    GLState().viewport(0, 0, width, height);
+    GLState().enable(GL_DEPTH_TEST);
+    glClearColor(scene.clearColor.x, scene.clearColor.y, scene.clearColor.z, scene.clearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures_[0]);
+    GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures_[1]);
+    GLState().bindSampler(0, sampler_);
+    GLState().bindSampler(1, sampler_);
+
+    shader_->use();
+    shader_->setMat4("view", view);
+    shader_->setMat4("projection", projection);
+
+    GLState().bindVertexArray(VAO_);
+    for (const glm::mat4& model : scene.models)
+    {
+        shader_->setMat4("model", model);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount_);
+    }
+}
+
+SoftwareSceneRenderer::SoftwareSceneRenderer(const Scene& scene, unsigned int threads)
+    : jobs_(threads), rasterizer_(1, 1, jobs_)
+{
+    for (int i = 0; i < 2; i++)
+        LoadRasterTexture(scene.texturePaths[i], textures_[i]);
+    rasterizer_.bindTextures(&textures_[0], &textures_[1], scene.textureMix);
+
+    glGenTextures(1, &presentTexture_);
+    glGenFramebuffers(1, &presentFramebuffer_);
+}
+
+SoftwareSceneRenderer::~SoftwareSceneRenderer()
+{
+    glDeleteFramebuffers(1, &presentFramebuffer_);
+    GLState().deleteTextures(1, &presentTexture_);
+}
+
+void SoftwareSceneRenderer::render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width, int height)
+{
+    if (width != rasterizer_.width() || height != rasterizer_.height())
+        rasterizer_.resize(width, height);
+
+    rasterizer_.clear(scene.clearColor);
+    glm::mat4 viewProjection = projection * view;
+    for (const glm::mat4& model : scene.models)
+        rasterizer_.drawTriangles(scene.vertices.data(), (int)scene.vertices.size() / 5, viewProjection * model);
+    rasterizer_.finish();
+
+    // present: the color buffer already has the GL layout (bottom row first, RGBA8)
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, presentTexture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (width != presentWidth_ || height != presentHeight_)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rasterizer_.colorBuffer());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, presentFramebuffer_);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, presentTexture_, 0);
+        presentWidth_ = width;
+        presentHeight_ = height;
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rasterizer_.colorBuffer());
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, presentFramebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+
+#include "Scene.h"
+#include "SamplerCache.h"
+#include "SoftwareRasterizer.h"
+
+class Shader;
+
+// draws a Scene into the default framebuffer of the current GL context.
+// the GL backend renders it with the sample shaders, the software backend rasterizes it on
+// the CPU and only uses GL to put the finished image on screen, so both can be timed per frame
+// in the same program (see SoftwareRendering.cpp).
+class SceneRenderer
+{
+public:
+    virtual ~SceneRenderer() {}
+    virtual const char* name() const = 0;
+    virtual void render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width, int height) = 0;
+};
+
+class GLSceneRenderer : public SceneRenderer
+{
+public:
+    explicit GLSceneRenderer(const Scene& scene);
+    ~GLSceneRenderer();
+
+    const char* name() const { return "OpenGL"; }
+    void render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width, int height);
+
+private:
+    std::unique_ptr<Shader> shader_;
+    unsigned int VAO_ = 0;
+    unsigned int VBO_ = 0;
+    unsigned int textures_[2] = {};
+    SamplerCache samplers_;
+    unsigned int sampler_ = 0;
+    int vertexCount_ = 0;
+};
+
+class SoftwareSceneRenderer : public SceneRenderer
+{
+public:
+    // threads = 0 uses all hardware threads
+    SoftwareSceneRenderer(const Scene& scene, unsigned int threads = 0);
+    ~SoftwareSceneRenderer();
+
+    const char* name() const { return rasterizer_.usesAVX2() ? "software (AVX2)" : "software"; }
+    void render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width, int height);
+
+    const SoftwareRasterizer& rasterizer() const { return rasterizer_; }
+
+private:
+    JobPool jobs_;
+    SoftwareRasterizer rasterizer_;
+    RasterTexture textures_[2];
+
+    // the finished image goes to the screen through a texture and a framebuffer blit
+    unsigned int presentTexture_ = 0;
+    unsigned int presentFramebuffer_ = 0;
+    int presentWidth_ = 0;
+    int presentHeight_ = 0;
+};
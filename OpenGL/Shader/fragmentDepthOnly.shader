@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth pre-pass: color writes are off, the fragment shader only has to exist
+void main()
+{
+}
\ No newline at end of file
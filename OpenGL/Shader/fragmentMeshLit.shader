@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 Normal;
+
+uniform sampler2D ourTexture;
+uniform sampler2D texture2;
+uniform vec3 lightDirection;
+
+void main()
+{
+    vec4 color = mix(texture(ourTexture, TexCoord), texture(texture2, TexCoord), 0.2);
+    // meshes without normals have zero normals, those are drawn unlit
+    float lambert = dot(Normal, Normal) > 0.0 ? max(dot(normalize(Normal), -lightDirection), 0.0) : 1.0;
+    FragColor = vec4(color.rgb * (0.25 + 0.75 * lambert), color.a);
+}
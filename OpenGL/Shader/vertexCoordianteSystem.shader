@@ -3,6 +3,8 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
+// the depth pre-pass uses this shader too, GL_EQUAL needs bit identical depths in both passes
+invariant gl_Position;
 uniform mat4 transform;
 
 uniform mat4 model;
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// index of the draw, see GeometryPool.h
+layout (location = 2) in uint aDrawId;
+
+out vec2 TexCoord;
+
+// four texels per draw, the columns of its model matrix
+uniform samplerBuffer models;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    int base = int(aDrawId) * 4;
+    mat4 model = mat4(texelFetch(models, base), texelFetch(models, base + 1),
+        texelFetch(models, base + 2), texelFetch(models, base + 3));
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    TexCoord = aTexCoord;
+}
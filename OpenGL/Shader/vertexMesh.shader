@@ -0,0 +1,38 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+#ifdef QUANTIZED_VERTEX
+// the 16 byte vertex of MeshCache.h: unorm16 or half position, 16 bit uv, octahedral normal
+layout (location = 2) in vec2 aNormal;
+#else
+layout (location = 2) in vec3 aNormal;
+#endif
+
+out vec2 TexCoord;
+out vec3 Normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+#ifdef QUANTIZED_VERTEX
+// CookedMesh::positionScale and positionOffset
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+#include "octahedral.glsl"
+#endif
+
+void main()
+{
+#ifdef QUANTIZED_VERTEX
+    vec3 position = aPos * positionScale + positionOffset;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    TexCoord = aTexCoord;
+    Normal = mat3(model) * decodeOctahedral(aNormal);
+#else
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    TexCoord = aTexCoord;
+    Normal = mat3(model) * aNormal;
+#endif
+}
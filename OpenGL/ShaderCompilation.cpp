@@ -0,0 +1,275 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Scene.h"
+#include "ShaderCompiler.h"
+
+// parallel shader compilation benchmark.
+//
+// usage: ShaderCompilation [programs]
+//
+// builds programs variants (48 by default) of the cube shaders, each with a different define so
+// the driver's shader cache can't help. first one after the other like the Shader constructor
+// does, then all submitted at once through ShaderCompiler. the cubes show up as their programs
+// finish; with KHR_parallel_shader_compile the frames keep coming while the driver compiles.
+// R builds all programs again with new variants. the time to the first and the last program
+// and the longest frame while compiling are printed.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+bool rebuildRequested = false;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string ReadFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+// puts a define behind the #version line, which has to stay the first one
+static std::string MakeVariant(const std::string& source, int variant)
+{
+    size_t lineEnd = source.find('\n');
+    if (lineEnd == std::string::npos)
+        return source;
+    return source.substr(0, lineEnd + 1) + "#define VARIANT " + std::to_string(variant) + "\n" + source.substr(lineEnd + 1);
+}
+
+int main(int argc, char** argv)
+{
+    int programCount = argc > 1 ? std::atoi(argv[1]) : 48;
+    if (programCount < 1)
+    {
+        std::cout << "usage: ShaderCompilation [programs]" << std::endl;
+        return -1;
+    }
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+    if (!HasParallelShaderCompile())
+        std::cout << "no GL_KHR_parallel_shader_compile, the programs are finished all at once" << std::endl;
+
+    {
+        Scene scene = CreateCubeScene();
+        std::string vertexCode = ReadFile(scene.vertexShaderPath);
+        std::string fragmentCode = ReadFile(scene.fragmentShaderPath);
+        int nextVariant = 0;
+
+        // one after the other, every program waits for its compile and link
+        // -----------------------------------------------------------------
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < programCount; i++, nextVariant++)
+        {
+            std::string vertexVariant = MakeVariant(vertexCode, nextVariant);
+            std::string fragmentVariant = MakeVariant(fragmentCode, nextVariant);
+            unsigned int program = Shader::compileProgram(vertexVariant.c_str(), (int)vertexVariant.size(), fragmentVariant.c_str(), (int)fragmentVariant.size());
+            GLState().deleteProgram(program);
+        }
+        std::cout << "serial: " << programCount << " programs in " << MillisecondsSince(start) << " ms" << std::endl;
+
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        GLState().bindVertexArray(VAO);
+        GLState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, scene.vertices.size() * sizeof(float), scene.vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        GLsizei vertexCount = (GLsizei)(scene.vertices.size() / 5);
+
+        stbi_set_flip_vertically_on_load(true);
+        unsigned int textures[2];
+        for (int i = 0; i < 2; i++)
+            textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+        // filtering and wrapping come from a sampler object instead of parameters per texture
+        SamplerCache samplers;
+        GLuint sampler = samplers.get(SamplerState());
+        GLState().bindSampler(0, sampler);
+        GLState().bindSampler(1, sampler);
+
+        // all at once, the cubes are drawn as their programs finish
+        // ---------------------------------------------------------
+        ShaderCompiler compiler;
+        std::vector<Shader> shaders(programCount);               // sized once, the compiler keeps references
+        std::vector<unsigned int> configured(programCount, 0);   // program the texture units were set for
+        rebuildRequested = true;
+
+        auto buildStart = std::chrono::steady_clock::now();
+        double firstReady = -1.0;
+        double longestFrame = 0.0;
+
+        int columns = 1;
+        while (columns * columns < programCount)
+            columns++;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            if (rebuildRequested && compiler.pending() == 0)
+            {
+                rebuildRequested = false;
+                buildStart = std::chrono::steady_clock::now();
+                for (int i = 0; i < programCount; i++, nextVariant++)
+                    compiler.submitSources(shaders[i], MakeVariant(vertexCode, nextVariant), MakeVariant(fragmentCode, nextVariant));
+                std::cout << "parallel: " << programCount << " programs submitted in " << MillisecondsSince(buildStart) << " ms" << std::endl;
+                firstReady = -1.0;
+                longestFrame = 0.0;
+            }
+            bool building = compiler.pending() > 0;
+            if (building && compiler.poll() > 0)
+            {
+                if (firstReady < 0.0)
+                    firstReady = MillisecondsSince(buildStart);
+                if (compiler.pending() == 0)
+                    std::cout << "parallel: first program after " << firstReady << " ms, all after " << MillisecondsSince(buildStart)
+                        << " ms, longest frame " << longestFrame << " ms" << std::endl;
+            }
+
+            // render
+            // ------
+            glClearColor(scene.clearColor.x, scene.clearColor.y, scene.clearColor.z, scene.clearColor.w);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[0]);
+            GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, textures[1]);
+            GLState().bindVertexArray(VAO);
+
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, columns * 1.6f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            for (int i = 0; i < programCount; i++)
+            {
+                Shader& shader = shaders[i];
+                if (!ShaderCompiler::ready(shader))
+                    continue;
+                shader.use();
+                if (configured[i] != shader.ID)
+                {
+                    shader.setInt("ourTexture", 0);
+                    shader.setInt("texture2", 1);
+                    configured[i] = shader.ID;
+                }
+                glm::vec3 position((i % columns - (columns - 1) * 0.5f) * 1.5f, ((columns - 1) * 0.5f - i / columns) * 1.5f, 0.0f);
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+                model = glm::rotate(model, (float)glfwGetTime() + i * 0.3f, glm::vec3(1.0f, 0.3f, 0.5f));
+                shader.set("model"_u, model);
+                shader.set("view"_u, view);
+                shader.set("projection"_u, projection);
+                glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+            }
+            glFinish();
+
+            double frameTime = MillisecondsSince(frameStart);
+            if (building && frameTime > longestFrame)
+                longestFrame = frameTime;
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        for (Shader& shader : shaders)
+            GLState().deleteProgram(shader.ID);
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, textures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // toggle on the key press only, not every frame the key is down
+    static bool rWasPressed = false;
+    bool rPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+    if (rPressed && !rWasPressed)
+        rebuildRequested = true;
+    rWasPressed = rPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
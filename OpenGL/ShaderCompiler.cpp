@@ -0,0 +1,89 @@
+#include "ShaderCompiler.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shaderLoad.h"
+#include "GLExtensions.h"
+#include "ShaderPreprocessor.h"
+
+ShaderCompiler::ShaderCompiler()
+{
+    parallel_ = HasParallelShaderCompile();
+    // 0xFFFFFFFF leaves the number of threads to the driver, which is also the default of most
+    // drivers that have the extension, but some only compile in parallel once asked
+    if (parallel_)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    finish();
+}
+
+void ShaderCompiler::submit(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& defines)
+{
+    // the preprocessor reports what it couldn't read
+    std::string vertexCode, fragmentCode;
+    PreprocessShader(vertexPath, defines, vertexCode);
+    PreprocessShader(fragmentPath, defines, fragmentCode);
+    submitSources(shader, vertexCode, fragmentCode);
+    shader.vertexPath = vertexPath;
+    shader.fragmentPath = fragmentPath;
+    shader.defines = defines;
+}
+
+void ShaderCompiler::submitSources(Shader& shader, const std::string& vertexCode, const std::string& fragmentCode)
+{
+    Pending pending;
+    pending.shader = &shader;
+    pending.program = Shader::submitProgram(vertexCode.c_str(), (int)vertexCode.size(), fragmentCode.c_str(), (int)fragmentCode.size());
+    pending_.push_back(pending);
+}
+
+int ShaderCompiler::poll()
+{
+    if (!parallel_)
+    {
+        int count = (int)pending_.size();
+        finish();
+        return count;
+    }
+
+    int count = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < pending_.size(); i++)
+    {
+        int done = 0;
+        glGetProgramiv(pending_[i].program, GL_COMPLETION_STATUS_KHR, &done);
+        if (done)
+        {
+            complete(pending_[i]);
+            count++;
+        }
+        else
+        {
+            pending_[kept++] = pending_[i];
+        }
+    }
+    pending_.resize(kept);
+    return count;
+}
+
+void ShaderCompiler::finish()
+{
+    // in submission order, the driver most likely finishes them in that order too
+    for (const Pending& pending : pending_)
+        complete(pending);
+    pending_.clear();
+}
+
+bool ShaderCompiler::ready(const Shader& shader)
+{
+    return shader.ID != 0;
+}
+
+void ShaderCompiler::complete(const Pending& pending)
+{
+    Shader::finishProgram(pending.program);
+    pending.shader->replaceProgram(pending.program);
+}
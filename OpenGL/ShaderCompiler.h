@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class Shader;
+
+// builds many programs at once instead of one after the other.
+// submit() hands the sources to the driver and returns without asking for a result. with
+// KHR_parallel_shader_compile the driver compiles on its own threads and poll() asks
+// GL_COMPLETION_STATUS_KHR, which never blocks, so every program becomes usable the frame it is
+// done and the slowest one doesn't hold up the rest. without the extension poll() finishes
+// everything at once, the driver still got all the work up front.
+//
+// a submitted Shader keeps ID 0 until its program is done; check ready() before using it.
+// a program that failed to link is handed over anyway, like the Shader constructor does, and
+// its errors go to std::cout.
+class ShaderCompiler
+{
+public:
+    // asks the driver for as many compiler threads as it likes, if it has the extension
+    ShaderCompiler();
+    // programs still building are finished, the shaders have to outlive the compiler
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    // reads the two files through PreprocessShader; the shader remembers them and the defines,
+    // so ShaderReloader can watch it later
+    void submit(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath,
+        const std::vector<std::string>& defines = std::vector<std::string>());
+    // sources already in memory, the shader has no files
+    void submitSources(Shader& shader, const std::string& vertexCode, const std::string& fragmentCode);
+
+    // hands the finished programs to their shaders, returns how many
+    int poll();
+    // waits for everything still building
+    void finish();
+
+    static bool ready(const Shader& shader);
+    size_t pending() const { return pending_.size(); }
+
+private:
+    struct Pending
+    {
+        Shader* shader;
+        unsigned int program;
+    };
+
+    static void complete(const Pending& pending);
+
+    std::vector<Pending> pending_;
+    bool parallel_ = false;
+};
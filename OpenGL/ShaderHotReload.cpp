@@ -0,0 +1,501 @@
+#include "ShaderHotReload.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shaderLoad.h"
+#include "GLStateCache.h"
+#include "ShaderPreprocessor.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    const int WAIT_MILLISECONDS = 100;
+    // editors save in several steps (truncate, write, rename), give them time to finish
+    const int SETTLE_MILLISECONDS = 50;
+
+    bool FileState(const std::string& path, time_t& time, long long& size)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            time = 0;
+            size = -1;
+            return false;
+        }
+        time = info.st_mtime;
+        size = (long long)info.st_size;
+        return true;
+    }
+
+    std::string DirectoryOf(const std::string& path)
+    {
+        size_t slash = path.find_last_of("\\/");
+        return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+    }
+
+    // waits for files to be written in a set of directories. only tells that something changed,
+    // the reloader compares the files it knows to find out what.
+    class DirectoryWatcher
+    {
+    public:
+        DirectoryWatcher();
+        ~DirectoryWatcher();
+
+        void add(const std::string& directory);
+        // true when a file in one of the directories changed within timeout
+        bool wait(int timeoutMilliseconds);
+
+    private:
+        std::vector<std::string> directories_;
+#ifdef _WIN32
+        struct Directory
+        {
+            HANDLE handle;
+            OVERLAPPED overlapped;
+            DWORD changes[1024];
+        };
+        void arm(Directory& directory);
+        std::vector<std::unique_ptr<Directory>> watched_;
+#else
+        int inotify_ = -1;
+#endif
+    };
+
+#ifdef _WIN32
+
+    const DWORD NOTIFY_FILTER = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+
+    DirectoryWatcher::DirectoryWatcher()
+    {
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        for (std::unique_ptr<Directory>& directory : watched_)
+        {
+            // the read has to be finished before its buffer goes away
+            DWORD bytes;
+            CancelIo(directory->handle);
+            GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, TRUE);
+            CloseHandle(directory->overlapped.hEvent);
+            CloseHandle(directory->handle);
+        }
+    }
+
+    void DirectoryWatcher::arm(Directory& directory)
+    {
+        ResetEvent(directory.overlapped.hEvent);
+        ReadDirectoryChangesW(directory.handle, directory.changes, sizeof(directory.changes), FALSE, NOTIFY_FILTER, NULL, &directory.overlapped, NULL);
+    }
+
+    void DirectoryWatcher::add(const std::string& directory)
+    {
+        for (const std::string& known : directories_)
+            if (known == directory)
+                return;
+        directories_.push_back(directory);
+
+        HANDLE handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            std::cout << "ERROR::SHADER::CANNOT_WATCH " << directory << std::endl;
+            return;
+        }
+        std::unique_ptr<Directory> watched(new Directory());
+        watched->handle = handle;
+        watched->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+        arm(*watched);
+        watched_.push_back(std::move(watched));
+    }
+
+    bool DirectoryWatcher::wait(int timeoutMilliseconds)
+    {
+        if (watched_.empty())
+        {
+            Sleep(timeoutMilliseconds);
+            return false;
+        }
+        std::vector<HANDLE> events;
+        for (std::unique_ptr<Directory>& directory : watched_)
+            events.push_back(directory->overlapped.hEvent);
+
+        DWORD signaled = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, timeoutMilliseconds);
+        if (signaled < WAIT_OBJECT_0 || signaled >= WAIT_OBJECT_0 + events.size())
+            return false;
+        // the others stay signaled and are picked up by the next wait
+        Directory& directory = *watched_[signaled - WAIT_OBJECT_0];
+        DWORD bytes;
+        GetOverlappedResult(directory.handle, &directory.overlapped, &bytes, FALSE);
+        arm(directory);
+        return true;
+    }
+
+#else
+
+    DirectoryWatcher::DirectoryWatcher()
+    {
+        inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_ < 0)
+            std::cout << "ERROR::SHADER::INOTIFY_INIT_FAILED" << std::endl;
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        if (inotify_ >= 0)
+            ::close(inotify_);
+    }
+
+    void DirectoryWatcher::add(const std::string& directory)
+    {
+        for (const std::string& known : directories_)
+            if (known == directory)
+                return;
+        directories_.push_back(directory);
+
+        if (inotify_ < 0 || inotify_add_watch(inotify_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY) < 0)
+            std::cout << "ERROR::SHADER::CANNOT_WATCH " << directory << std::endl;
+    }
+
+    bool DirectoryWatcher::wait(int timeoutMilliseconds)
+    {
+        pollfd descriptor = { inotify_, POLLIN, 0 };
+        if (inotify_ < 0 || poll(&descriptor, 1, timeoutMilliseconds) <= 0)
+        {
+            if (inotify_ < 0)
+                usleep(timeoutMilliseconds * 1000);
+            return false;
+        }
+        // the events themselves don't matter, empty the queue
+        alignas(inotify_event) char events[4096];
+        while (read(inotify_, events, sizeof(events)) > 0)
+        {
+        }
+        return true;
+    }
+
+#endif
+
+    bool IsFloatUniform(GLenum type)
+    {
+        return type == GL_FLOAT || type == GL_FLOAT_VEC2 || type == GL_FLOAT_VEC3 || type == GL_FLOAT_VEC4 ||
+            type == GL_FLOAT_MAT2 || type == GL_FLOAT_MAT3 || type == GL_FLOAT_MAT4;
+    }
+
+    int IntComponents(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_INT_VEC2: case GL_BOOL_VEC2: case GL_UNSIGNED_INT_VEC2: return 2;
+        case GL_INT_VEC3: case GL_BOOL_VEC3: case GL_UNSIGNED_INT_VEC3: return 3;
+        case GL_INT_VEC4: case GL_BOOL_VEC4: case GL_UNSIGNED_INT_VEC4: return 4;
+        default: return 1;      // int, bool, unsigned int and the samplers
+        }
+    }
+
+    bool IsUnsignedUniform(GLenum type)
+    {
+        return type == GL_UNSIGNED_INT || type == GL_UNSIGNED_INT_VEC2 || type == GL_UNSIGNED_INT_VEC3 || type == GL_UNSIGNED_INT_VEC4;
+    }
+
+    // non-square matrices and doubles, none of our shaders use them
+    bool IsUnsupportedUniform(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2:
+        case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+        case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // writes the value of one uniform of source into the same uniform of the bound program
+    void CopyUniform(unsigned int source, GLint sourceLocation, GLint location, GLenum type)
+    {
+        if (IsFloatUniform(type))
+        {
+            GLfloat value[16];
+            glGetUniformfv(source, sourceLocation, value);
+            switch (type)
+            {
+            case GL_FLOAT: glUniform1fv(location, 1, value); break;
+            case GL_FLOAT_VEC2: glUniform2fv(location, 1, value); break;
+            case GL_FLOAT_VEC3: glUniform3fv(location, 1, value); break;
+            case GL_FLOAT_VEC4: glUniform4fv(location, 1, value); break;
+            case GL_FLOAT_MAT2: glUniformMatrix2fv(location, 1, GL_FALSE, value); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(location, 1, GL_FALSE, value); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, value); break;
+            }
+        }
+        else if (IsUnsignedUniform(type))
+        {
+            GLuint value[4];
+            glGetUniformuiv(source, sourceLocation, value);
+            switch (IntComponents(type))
+            {
+            case 1: glUniform1uiv(location, 1, value); break;
+            case 2: glUniform2uiv(location, 1, value); break;
+            case 3: glUniform3uiv(location, 1, value); break;
+            case 4: glUniform4uiv(location, 1, value); break;
+            }
+        }
+        else
+        {
+            GLint value[4];
+            glGetUniformiv(source, sourceLocation, value);
+            switch (IntComponents(type))
+            {
+            case 1: glUniform1iv(location, 1, value); break;
+            case 2: glUniform2iv(location, 1, value); break;
+            case 3: glUniform3iv(location, 1, value); break;
+            case 4: glUniform4iv(location, 1, value); break;
+            }
+        }
+    }
+
+    // carries the uniform values and block bindings of the old program over to its replacement.
+    // uniforms that were added, removed or changed their type keep the defaults of the new program.
+    void CopyUniforms(unsigned int source, const ShaderReflection& sourceReflection, unsigned int destination)
+    {
+        ShaderReflection destinationReflection = ReflectProgram(destination);
+
+        GLState().useProgram(destination);
+        for (const ShaderUniform& uniform : destinationReflection.uniforms)
+        {
+            const ShaderUniform* found = sourceReflection.findUniform(uniform.name);
+            if (found == nullptr || found->type != uniform.type || IsUnsupportedUniform(uniform.type))
+                continue;
+
+            GLint size = uniform.size < found->size ? uniform.size : found->size;
+            for (GLint element = 0; element < size; element++)
+            {
+                std::string name = uniform.name;
+                if (uniform.size > 1)
+                    name += "[" + std::to_string(element) + "]";
+                GLint sourceLocation = glGetUniformLocation(source, name.c_str());
+                GLint location = glGetUniformLocation(destination, name.c_str());
+                if (sourceLocation >= 0 && location >= 0)
+                    CopyUniform(source, sourceLocation, location, uniform.type);
+            }
+        }
+        // the binding points of the uniform blocks belong to the program as well
+        for (const ShaderUniformBlock& block : destinationReflection.uniformBlocks)
+        {
+            const ShaderUniformBlock* found = sourceReflection.findUniformBlock(block.name);
+            if (found == nullptr)
+                continue;
+            GLint binding = 0;
+            glGetActiveUniformBlockiv(source, found->index, GL_UNIFORM_BLOCK_BINDING, &binding);
+            glUniformBlockBinding(destination, block.index, (GLuint)binding);
+        }
+    }
+}
+
+ShaderReloader::ShaderReloader(GLFWwindow* mainWindow)
+    : stopping_(false)
+{
+    // a context can only be current on one thread, the reload thread gets its own that shares
+    // the objects of the main one. glfw wants windows created on the main thread.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context_ = glfwCreateWindow(1, 1, "shader reload", NULL, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (context_ == NULL)
+    {
+        std::cout << "ERROR::SHADER::RELOAD_CONTEXT_FAILED" << std::endl;
+        return;
+    }
+    reloader_ = std::thread(&ShaderReloader::reloadLoop, this);
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    stopping_ = true;
+    if (reloader_.joinable())
+        reloader_.join();
+
+    for (Result& result : finished_)
+    {
+        glDeleteSync(result.fence);
+        glDeleteProgram(result.program);
+    }
+    if (context_ != NULL)
+        glfwDestroyWindow(context_);
+}
+
+void ShaderReloader::watch(Shader& shader)
+{
+    if (shader.vertexPath.empty() || shader.fragmentPath.empty())
+        return;
+
+    Entry entry;
+    entry.shader = &shader;
+    entry.vertexPath = shader.vertexPath;
+    entry.fragmentPath = shader.fragmentPath;
+    entry.defines = shader.defines;
+    std::string vertexCode, fragmentCode;
+    std::vector<std::string> vertexFiles, fragmentFiles;
+    PreprocessShader(entry.vertexPath, entry.defines, vertexCode, &vertexFiles);
+    PreprocessShader(entry.fragmentPath, entry.defines, fragmentCode, &fragmentFiles);
+    entry.files = watchFiles(vertexFiles, fragmentFiles);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back(entry);
+    entriesChanged_ = true;
+}
+
+int ShaderReloader::update()
+{
+    std::vector<Result> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_.empty())
+            return 0;
+        // the fence tells the program is complete in the shared context, asking doesn't wait
+        std::vector<Result> pending;
+        for (Result& result : finished_)
+        {
+            GLenum status = glClientWaitSync(result.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                ready.push_back(result);
+            else
+                pending.push_back(result);
+        }
+        finished_.swap(pending);
+    }
+
+    for (Result& result : ready)
+    {
+        glDeleteSync(result.fence);
+        CopyUniforms(result.shader->ID, result.shader->reflection, result.program);
+        result.shader->replaceProgram(result.program);
+        std::cout << "SHADER::RELOADED " << result.shader->vertexPath << " " << result.shader->fragmentPath << std::endl;
+    }
+    return (int)ready.size();
+}
+
+std::vector<ShaderReloader::WatchedFile> ShaderReloader::watchFiles(const std::vector<std::string>& vertexFiles, const std::vector<std::string>& fragmentFiles)
+{
+    std::vector<WatchedFile> files;
+    for (const std::vector<std::string>* stage : { &vertexFiles, &fragmentFiles })
+    {
+        for (const std::string& path : *stage)
+        {
+            bool known = false;
+            for (const WatchedFile& file : files)
+                known = known || file.path == path;
+            if (known)
+                continue;
+            WatchedFile file;
+            file.path = path;
+            FileState(path, file.time, file.size);
+            files.push_back(file);
+        }
+    }
+    return files;
+}
+
+void ShaderReloader::reloadLoop()
+{
+    glfwMakeContextCurrent(context_);
+    DirectoryWatcher watcher;
+
+    while (!stopping_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (entriesChanged_)
+            {
+                for (const Entry& entry : entries_)
+                    for (const WatchedFile& file : entry.files)
+                        watcher.add(DirectoryOf(file.path));
+                entriesChanged_ = false;
+            }
+        }
+        if (!watcher.wait(WAIT_MILLISECONDS))
+            continue;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MILLISECONDS));
+        recompileChanged();
+    }
+    glfwMakeContextCurrent(NULL);
+}
+
+void ShaderReloader::recompileChanged()
+{
+    struct Job
+    {
+        Shader* shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::vector<std::string> defines;
+    };
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Entry& entry : entries_)
+        {
+            bool changed = false;
+            for (const WatchedFile& file : entry.files)
+            {
+                time_t time;
+                long long size;
+                // a file that is missing for the moment (an editor replacing it) counts once it is back
+                if (FileState(file.path, time, size) && (time != file.time || size != file.size))
+                    changed = true;
+            }
+            if (changed)
+                jobs.push_back({ entry.shader, entry.vertexPath, entry.fragmentPath, entry.defines });
+        }
+    }
+
+    // compiling happens outside the lock, update() on the main thread never waits for it
+    for (Job& job : jobs)
+    {
+        std::string vertexCode, fragmentCode;
+        std::vector<std::string> vertexFiles, fragmentFiles;
+        bool read = PreprocessShader(job.vertexPath, job.defines, vertexCode, &vertexFiles);
+        read = PreprocessShader(job.fragmentPath, job.defines, fragmentCode, &fragmentFiles) && read;
+        // the includes may have changed, from now on the files of this version are watched
+        std::vector<WatchedFile> files = watchFiles(vertexFiles, fragmentFiles);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (Entry& entry : entries_)
+                if (entry.shader == job.shader)
+                    entry.files = files;
+            entriesChanged_ = true;
+        }
+        if (!read)
+            continue;
+
+        bool linked = false;
+        unsigned int program = Shader::compileProgram(vertexCode.c_str(), (int)vertexCode.size(), fragmentCode.c_str(), (int)fragmentCode.size(), &linked);
+        if (!linked)
+        {
+            glDeleteProgram(program);
+            std::cout << "ERROR::SHADER::RELOAD_FAILED " << job.vertexPath << " " << job.fragmentPath << " keeps the old program" << std::endl;
+            continue;
+        }
+
+        // the main thread may only use the program once this context finished building it
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.push_back({ job.shader, program, fence });
+    }
+}
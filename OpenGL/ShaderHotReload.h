@@ -0,0 +1,78 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Shader;
+
+// recompiles shaders in the background when their source files or the files they include change.
+// a thread with a hidden window sharing the context of the main window waits for changes in the
+// directories of the watched files (ReadDirectoryChangesW on Windows, inotify elsewhere), then
+// compiles and links the changed shaders. update() swaps the new programs in between two frames,
+// after their fence signaled, so the main thread never waits for the driver to compile.
+// a shader that fails to compile or link keeps its old program, the errors go to std::cout.
+class ShaderReloader
+{
+public:
+    // on the main thread, with the context of mainWindow current
+    explicit ShaderReloader(GLFWwindow* mainWindow);
+    ~ShaderReloader();
+
+    ShaderReloader(const ShaderReloader&) = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    // shaders loaded from an asset pack have no files and are ignored.
+    // the shader has to stay alive until the reloader is deleted.
+    void watch(Shader& shader);
+
+    // call once per frame on the main thread before drawing. swaps in the programs that are
+    // ready and copies the values of their uniforms over from the old program, so the texture
+    // units and everything else set once at the start stay. returns the number of swaps.
+    int update();
+
+private:
+    struct WatchedFile
+    {
+        std::string path;
+        time_t time;
+        long long size;
+    };
+
+    struct Entry
+    {
+        Shader* shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::vector<std::string> defines;
+        // both stages and everything they include, as they were when compiled last
+        std::vector<WatchedFile> files;
+    };
+
+    struct Result
+    {
+        Shader* shader;
+        unsigned int program;
+        GLsync fence;
+    };
+
+    // the state of the files of both stages, each file once
+    static std::vector<WatchedFile> watchFiles(const std::vector<std::string>& vertexFiles, const std::vector<std::string>& fragmentFiles);
+    void reloadLoop();
+    // compiles the entries whose files changed since the last look, on the reload thread
+    void recompileChanged();
+
+    GLFWwindow* context_ = nullptr;
+    std::thread reloader_;
+    std::atomic<bool> stopping_;
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;     // guarded by mutex_
+    std::vector<Result> finished_;   // guarded by mutex_
+    bool entriesChanged_ = false;    // guarded by mutex_, the reload thread watches new directories
+};
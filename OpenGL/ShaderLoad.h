@@ -9,77 +9,57 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+
+#include "AssetPack.h"
+#include "GLStateCache.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+#include "ShaderUniforms.h"
 
 class Shader
 {
 public:
     unsigned int ID;
+    // the source files, empty for shaders from an asset pack. ShaderReloader watches them.
+    std::string vertexPath;
+    std::string fragmentPath;
+    // given to PreprocessShader for both stages, see ShaderVariantCache
+    std::vector<std::string> defines;
+    // the active attributes, uniforms and uniform blocks of the program, see PipelineBuilder
+    ShaderReflection reflection;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = std::vector<std::string>())
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
+        // 1. retrieve the vertex/fragment source code from filePath, with the #includes resolved
         std::string vertexCode;
         std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        // the preprocessor reports what it couldn't read
+        PreprocessShader(vertexPath, defines, vertexCode);
+        PreprocessShader(fragmentPath, defines, fragmentCode);
+        compile(vertexCode.c_str(), (int)vertexCode.size(), fragmentCode.c_str(), (int)fragmentCode.size());
+    }
+    // an empty shader without a program, ShaderCompiler builds it in the background
+    // ------------------------------------------------------------------------
+    Shader() : ID(0)
+    {
+    }
+    // generates the shader from sources inside an asset pack, the mapped bytes are handed to GL as they are
+    // ------------------------------------------------------------------------
+    Shader(const AssetView& vertexSource, const AssetView& fragmentSource)
+    {
+        if (!vertexSource.valid() || !fragmentSource.valid())
+            std::cout << "ERROR::SHADER::ASSET_NOT_FOUND" << std::endl;
+        compile((const char*)vertexSource.data, (int)vertexSource.size, (const char*)fragmentSource.data, (int)fragmentSource.size);
     }
     // activate the shader
     // ------------------------------------------------------------------------
+    // goes through the state cache, using the program that is already current costs nothing
     void use()
     {
-        glUseProgram(ID);
+        GLState().useProgram(ID);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
@@ -97,15 +77,195 @@ public:
     {
         glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
     }
-    void setMat4(const std::string& name, glm::mat4 matrix) const
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string& name, const glm::vec3& value) const
+    {
+        glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
+    }
+    void setMat4(const std::string& name, const glm::mat4& matrix) const
     {
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()),1 ,GL_FALSE, glm::value_ptr(matrix));
     }
+    // typed setters for compile time names, e.g. set("model"_u, model). the location is binary
+    // searched in the reflection instead of asking glGetUniformLocation. like with GL, names the
+    // program doesn't use are ignored. debug builds check the type against the reflected one.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(UniformName name, const T& value) const
+    {
+        setArray(name, &value, 1);
+    }
+    template <typename T, size_t N>
+    void set(UniformName name, const T (&values)[N]) const
+    {
+        setArray(name, values, (GLsizei)N);
+    }
+    template <typename T>
+    void setArray(UniformName name, const T* values, GLsizei count) const
+    {
+        const ShaderUniform* uniform = reflection.findUniform(name.hash);
+        if (uniform == nullptr)
+            return;
+#ifndef NDEBUG
+        if (!checkUniform(*uniform, name, UniformTraits<T>::type, count))
+            return;
+#endif
+        UniformTraits<T>::set(uniform->location, count, values);
+    }
+    // resolves a uniform set every draw once, set(handle, value) then only makes the glUniform*
+    // call. asking again for the same name gives the same handle.
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(UniformName name)
+    {
+        for (size_t i = 0; i < handles_.size(); i++)
+            if (handles_[i].name.hash == name.hash)
+                return UniformHandle{ i };
+        ResolvedUniform resolved;
+        resolved.name = name;
+        resolve(resolved);
+        handles_.push_back(resolved);
+        return UniformHandle{ handles_.size() - 1 };
+    }
+    template <typename T>
+    void set(UniformHandle handle, const T& value) const
+    {
+        setArray(handle, &value, 1);
+    }
+    template <typename T, size_t N>
+    void set(UniformHandle handle, const T (&values)[N]) const
+    {
+        setArray(handle, values, (GLsizei)N);
+    }
+    template <typename T>
+    void setArray(UniformHandle handle, const T* values, GLsizei count) const
+    {
+        const ResolvedUniform& resolved = handles_[handle.index];
+        if (resolved.location < 0)
+            return;
+#ifndef NDEBUG
+        if (!checkUniform(reflection.uniforms[resolved.uniform], resolved.name, UniformTraits<T>::type, count))
+            return;
+#endif
+        UniformTraits<T>::set(resolved.location, count, values);
+    }
+    // takes over a program linked from the same sources, the old one is deleted
+    // ------------------------------------------------------------------------
+    void replaceProgram(unsigned int program)
+    {
+        GLState().deleteProgram(ID);
+        ID = program;
+        reflection = ReflectProgram(ID);
+        // the handles keep their index, the uniform behind it may have moved or gone
+        for (ResolvedUniform& resolved : handles_)
+            resolve(resolved);
+    }
+    // compiles and links a program without touching any Shader, e.g. on another thread with a
+    // shared context. the errors go to std::cout, linked tells whether the program can be used.
+    // ------------------------------------------------------------------------
+    static unsigned int compileProgram(const char* vShaderCode, int vShaderLength, const char* fShaderCode, int fShaderLength, bool* linked = nullptr)
+    {
+        unsigned int program = submitProgram(vShaderCode, vShaderLength, fShaderCode, fShaderLength);
+        bool success = finishProgram(program);
+        if (linked)
+            *linked = success;
+        return program;
+    }
+    // hands the sources to the driver without asking for any result, so a driver that compiles
+    // on its own threads (KHR_parallel_shader_compile) is not forced to finish here
+    // ------------------------------------------------------------------------
+    static unsigned int submitProgram(const char* vShaderCode, int vShaderLength, const char* fShaderCode, int fShaderLength)
+    {
+        unsigned int vertex, fragment;
+
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, &vShaderLength);
+        glCompileShader(vertex);
+
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, &fShaderLength);
+        glCompileShader(fragment);
+
+        // shader Program
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+
+        // the shaders are only flagged for deletion, they live on while attached so finishProgram
+        // can still read their logs
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        return program;
+    }
+    // waits for a program from submitProgram and reports its errors, true if it linked
+    // ------------------------------------------------------------------------
+    static bool finishProgram(unsigned int program)
+    {
+        int linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            // the link error is usually just the consequence of a compile error, show those first
+            unsigned int shaders[2];
+            GLsizei count = 0;
+            glGetAttachedShaders(program, 2, &count, shaders);
+            for (GLsizei i = 0; i < count; i++)
+            {
+                int type;
+                glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+                checkCompileErrors(shaders[i], type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT");
+            }
+        }
+        return checkCompileErrors(program, "PROGRAM");
+    }
 
     private:
+        // what a UniformHandle stands for, resolved against the current program
+        struct ResolvedUniform
+        {
+            UniformName name;
+            GLint location;     // -1 if the program doesn't use it
+            size_t uniform;     // into reflection.uniforms, for the debug check
+        };
+        std::vector<ResolvedUniform> handles_;
+
+        void resolve(ResolvedUniform& resolved) const
+        {
+            const ShaderUniform* uniform = reflection.findUniform(resolved.name.hash);
+            resolved.location = uniform ? uniform->location : -1;
+            resolved.uniform = uniform ? (size_t)(uniform - reflection.uniforms.data()) : 0;
+        }
+        // 2. compile shaders; the sources don't need to be zero terminated
+        // ------------------------------------------------------------------------
+        void compile(const char* vShaderCode, int vShaderLength, const char* fShaderCode, int fShaderLength)
+        {
+            ID = compileProgram(vShaderCode, vShaderLength, fShaderCode, fShaderLength);
+            reflection = ReflectProgram(ID);
+        }
+        // debug check of set(): same name behind the hash, the GLSL type the C++ type is for
+        // (samplers are set as int), not more elements than the uniform has
+        // ------------------------------------------------------------------------
+        static bool checkUniform(const ShaderUniform& uniform, UniformName name, GLenum type, GLsizei count)
+        {
+            if (uniform.name != name.name)
+            {
+                std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION " << name.name << " " << uniform.name << std::endl;
+                return false;
+            }
+            bool typeMatches = uniform.type == type || (type == GL_INT && uniform.sampler);
+            if (!typeMatches || count > uniform.size)
+            {
+                std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH " << name.name << " type 0x" << std::hex << uniform.type
+                    << " set as 0x" << type << std::dec << ", " << count << " of " << uniform.size << " elements" << std::endl;
+                return false;
+            }
+            return true;
+        }
         // utility function for checking shader compilation/linking errors.
         // ------------------------------------------------------------------------
-        void checkCompileErrors(unsigned int shader, std::string type)
+        static bool checkCompileErrors(unsigned int shader, std::string type)
         {
             int success;
             char infoLog[1024];
@@ -127,6 +287,7 @@ public:
                     std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
                 }
             }
+            return success != 0;
         }
 };
 #endif
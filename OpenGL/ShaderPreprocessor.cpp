@@ -0,0 +1,125 @@
+#include "ShaderPreprocessor.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    struct Preprocessor
+    {
+        const std::vector<std::string>* defines;
+        std::vector<std::string> files;
+        std::string output;
+        bool versionSeen = false;
+        bool failed = false;
+
+        void appendLineDirective(int nextLine, int fileIndex)
+        {
+            output += "#line " + std::to_string(nextLine) + " " + std::to_string(fileIndex) + "\n";
+        }
+
+        void appendDefines()
+        {
+            for (const std::string& define : *defines)
+            {
+                size_t equals = define.find('=');
+                if (equals == std::string::npos)
+                    output += "#define " + define + "\n";
+                else
+                    output += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
+            }
+        }
+
+        void process(const std::string& path, const std::string& includedFrom);
+    };
+
+    std::string DirectoryOf(const std::string& path)
+    {
+        size_t slash = path.find_last_of("\\/");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // the name of an #include "name" line, empty if the line is something else
+    std::string IncludeName(const std::string& line)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+            return std::string();
+        size_t open = line.find('"', start + 8);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            return std::string();
+        return line.substr(open + 1, close - open - 1);
+    }
+
+    bool IsVersionLine(const std::string& line)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        return start != std::string::npos && line.compare(start, 8, "#version") == 0;
+    }
+
+    void Preprocessor::process(const std::string& path, const std::string& includedFrom)
+    {
+        for (const std::string& file : files)
+            if (file == path)
+                return;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            if (includedFrom.empty())
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            else
+                std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND " << path << " in " << includedFrom << std::endl;
+            failed = true;
+            return;
+        }
+        int fileIndex = (int)files.size();
+        files.push_back(path);
+        if (versionSeen)
+            appendLineDirective(1, fileIndex);
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            std::string include = IncludeName(line);
+            if (!include.empty())
+            {
+                process(DirectoryOf(path) + include, path);
+                // nothing may come before #version, not even #line
+                if (versionSeen)
+                    appendLineDirective(lineNumber + 1, fileIndex);
+            }
+            else if (!versionSeen && IsVersionLine(line))
+            {
+                versionSeen = true;
+                output += line + "\n";
+                appendDefines();
+                appendLineDirective(lineNumber + 1, fileIndex);
+            }
+            else
+            {
+                output += line + "\n";
+            }
+        }
+    }
+}
+
+bool PreprocessShader(const std::string& path, const std::vector<std::string>& defines, std::string& source, std::vector<std::string>* files)
+{
+    Preprocessor preprocessor;
+    preprocessor.defines = &defines;
+    preprocessor.process(path, std::string());
+    if (!preprocessor.versionSeen && !preprocessor.failed && !defines.empty())
+        std::cout << "ERROR::SHADER::NO_VERSION_FOR_DEFINES " << path << std::endl;
+
+    source.swap(preprocessor.output);
+    if (files)
+        files->swap(preprocessor.files);
+    return !preprocessor.failed;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// reads a GLSL file and resolves its #include "file" lines, the names are relative to the
+// including file. every file is included once, like with #pragma once, so shared code can
+// include what it needs without guards. includes inside #if blocks are resolved all the same.
+//
+// defines go right behind the #version line, which has to stay the first line of the result:
+// "NAME" becomes "#define NAME", "NAME=VALUE" becomes "#define NAME VALUE".
+// #line directives keep the line numbers in compile errors right, the source string number in
+// them is the index of the file in files (0 is path itself).
+//
+// errors go to std::cout, false if path or one of its includes can't be read.
+bool PreprocessShader(const std::string& path, const std::vector<std::string>& defines, std::string& source,
+    std::vector<std::string>* files = nullptr);
@@ -0,0 +1,132 @@
+#include "ShaderReflection.h"
+#include "ShaderUniforms.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    // the reported name without the "[0]" of arrays
+    std::string BaseName(const char* name, GLsizei length)
+    {
+        std::string base(name, length);
+        if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0)
+            base.resize(base.size() - 3);
+        return base;
+    }
+
+    template <typename T>
+    const T* FindByName(const std::vector<T>& items, const std::string& name)
+    {
+        for (const T& item : items)
+            if (item.name == name)
+                return &item;
+        return nullptr;
+    }
+}
+
+const ShaderAttribute* ShaderReflection::findAttribute(const std::string& name) const
+{
+    return FindByName(attributes, name);
+}
+
+const ShaderUniform* ShaderReflection::findUniform(const std::string& name) const
+{
+    return FindByName(uniforms, name);
+}
+
+const ShaderUniformBlock* ShaderReflection::findUniformBlock(const std::string& name) const
+{
+    return FindByName(uniformBlocks, name);
+}
+
+GLint ShaderReflection::uniformLocation(const std::string& name) const
+{
+    const ShaderUniform* uniform = findUniform(name);
+    return uniform ? uniform->location : -1;
+}
+
+ShaderReflection ReflectProgram(GLuint program)
+{
+    ShaderReflection reflection;
+    char name[256];
+    GLsizei length = 0;
+
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        ShaderAttribute attribute;
+        glGetActiveAttrib(program, (GLuint)i, sizeof(name), &length, &attribute.size, &attribute.type, name);
+        attribute.name = BaseName(name, length);
+        attribute.location = glGetAttribLocation(program, name);
+        // built-ins have no location
+        if (attribute.location >= 0)
+            reflection.attributes.push_back(attribute);
+    }
+
+    count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    std::vector<std::pair<uint32_t, ShaderUniform>> hashed;
+    for (GLint i = 0; i < count; i++)
+    {
+        ShaderUniform uniform;
+        glGetActiveUniform(program, (GLuint)i, sizeof(name), &length, &uniform.size, &uniform.type, name);
+        uniform.name = BaseName(name, length);
+        uniform.location = glGetUniformLocation(program, name);
+        uniform.sampler = IsSamplerType(uniform.type);
+        // members of uniform blocks have no location, their block is reflected below
+        if (uniform.location < 0)
+            continue;
+        hashed.push_back(std::make_pair(HashUniformName(uniform.name.c_str(), uniform.name.size()), uniform));
+    }
+    // sorted, so findUniform can binary search the hashes
+    std::sort(hashed.begin(), hashed.end(), [](const std::pair<uint32_t, ShaderUniform>& a, const std::pair<uint32_t, ShaderUniform>& b) {
+        return a.first < b.first;
+    });
+    for (size_t i = 0; i < hashed.size(); i++)
+    {
+        if (i > 0 && hashed[i].first == hashed[i - 1].first)
+            std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION " << hashed[i - 1].second.name << " " << hashed[i].second.name << std::endl;
+        reflection.uniforms.push_back(hashed[i].second);
+        reflection.uniformHashes.push_back(hashed[i].first);
+    }
+
+    count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        ShaderUniformBlock block;
+        glGetActiveUniformBlockName(program, (GLuint)i, sizeof(name), &length, name);
+        block.name = std::string(name, length);
+        block.index = (GLuint)i;
+        glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+        reflection.uniformBlocks.push_back(block);
+    }
+    return reflection;
+}
+
+bool IsSamplerType(GLenum type)
+{
+    switch (type)
+    {
+    case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_SAMPLER_CUBE_MAP_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+    case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT: case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+        return true;
+    default:
+        return false;
+    }
+}
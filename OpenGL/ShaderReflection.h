@@ -0,0 +1,67 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// what a linked program expects from the outside, read back from GL once after linking.
+// array names lose their "[0]", size is the number of elements.
+
+struct ShaderAttribute
+{
+    std::string name;
+    GLint location;
+    GLenum type;            // GL_FLOAT_VEC3, GL_UNSIGNED_INT, ...
+    GLint size;
+};
+
+// uniforms of the default block, samplers included
+struct ShaderUniform
+{
+    std::string name;
+    GLint location;
+    GLenum type;
+    GLint size;
+    bool sampler;
+};
+
+struct ShaderUniformBlock
+{
+    std::string name;
+    GLuint index;
+    GLint dataSize;         // bytes the buffer bound to it needs at least
+};
+
+struct ShaderReflection
+{
+    std::vector<ShaderAttribute> attributes;
+    std::vector<ShaderUniform> uniforms;        // ordered by the hash of their name
+    std::vector<ShaderUniformBlock> uniformBlocks;
+    // HashUniformName of every entry of uniforms, in the same (ascending) order. kept apart so a
+    // lookup only binary searches a few packed integers
+    std::vector<uint32_t> uniformHashes;
+
+    // nullptr if the program has no such active input
+    const ShaderAttribute* findAttribute(const std::string& name) const;
+    const ShaderUniform* findUniform(const std::string& name) const;
+    const ShaderUniform* findUniform(uint32_t hash) const
+    {
+        auto found = std::lower_bound(uniformHashes.begin(), uniformHashes.end(), hash);
+        if (found == uniformHashes.end() || *found != hash)
+            return nullptr;
+        return &uniforms[found - uniformHashes.begin()];
+    }
+    const ShaderUniformBlock* findUniformBlock(const std::string& name) const;
+
+    // -1 like glGetUniformLocation for uniforms that aren't active
+    GLint uniformLocation(const std::string& name) const;
+};
+
+// queries the active attributes, uniforms and uniform blocks of a linked program.
+// built-in inputs like gl_VertexID and the members of uniform blocks are left out.
+ShaderReflection ReflectProgram(GLuint program);
+
+// true for the sampler types of GL 4.0 core
+bool IsSamplerType(GLenum type);
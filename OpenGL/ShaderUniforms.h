@@ -0,0 +1,135 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// uniform names hashed at compile time, so setting a uniform doesn't build a std::string and
+// doesn't ask GL for the location:
+//   shader.set("model"_u, model);
+// Shader looks the hash up in the reflection of its program, see Shader::set. uniforms set every
+// draw are resolved once instead, the handle then leads straight to the location:
+//   UniformHandle model = shader.uniform("model"_u);
+//   shader.set(model, modelMatrix);
+
+// 32 bit FNV-1a
+constexpr uint32_t HashUniformName(const char* name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct UniformName
+{
+    const char* name;       // kept for the error messages and the debug check of the hash
+    uint32_t hash;
+};
+
+constexpr UniformName operator"" _u(const char* name, size_t length)
+{
+    return UniformName{ name, HashUniformName(name, length) };
+}
+
+// a uniform resolved by Shader::uniform, only valid with the shader that handed it out.
+// it stays valid when the shader gets a new program, see Shader::replaceProgram.
+struct UniformHandle
+{
+    size_t index;           // into the resolved uniforms of the shader
+};
+
+// the glUniform* call and the GLSL type of each C++ type that can be set
+template <typename T> struct UniformTraits;
+
+template <> struct UniformTraits<float>
+{
+    static const GLenum type = GL_FLOAT;
+    static void set(GLint location, GLsizei count, const float* value) { glUniform1fv(location, count, value); }
+};
+
+template <> struct UniformTraits<int>
+{
+    static const GLenum type = GL_INT;     // samplers are set as int as well
+    static void set(GLint location, GLsizei count, const int* value) { glUniform1iv(location, count, value); }
+};
+
+template <> struct UniformTraits<unsigned int>
+{
+    static const GLenum type = GL_UNSIGNED_INT;
+    static void set(GLint location, GLsizei count, const unsigned int* value) { glUniform1uiv(location, count, value); }
+};
+
+template <> struct UniformTraits<bool>
+{
+    static const GLenum type = GL_BOOL;
+    // GL wants ints for bools, small arrays are converted on the stack
+    static void set(GLint location, GLsizei count, const bool* value)
+    {
+        GLint small[16];
+        std::vector<GLint> large;
+        GLint* buffer = small;
+        if (count > 16)
+        {
+            large.resize(count);
+            buffer = large.data();
+        }
+        for (GLsizei i = 0; i < count; i++)
+            buffer[i] = value[i] ? 1 : 0;
+        glUniform1iv(location, count, buffer);
+    }
+};
+
+template <> struct UniformTraits<glm::vec2>
+{
+    static const GLenum type = GL_FLOAT_VEC2;
+    static void set(GLint location, GLsizei count, const glm::vec2* value) { glUniform2fv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::vec3>
+{
+    static const GLenum type = GL_FLOAT_VEC3;
+    static void set(GLint location, GLsizei count, const glm::vec3* value) { glUniform3fv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::vec4>
+{
+    static const GLenum type = GL_FLOAT_VEC4;
+    static void set(GLint location, GLsizei count, const glm::vec4* value) { glUniform4fv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::ivec2>
+{
+    static const GLenum type = GL_INT_VEC2;
+    static void set(GLint location, GLsizei count, const glm::ivec2* value) { glUniform2iv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::ivec3>
+{
+    static const GLenum type = GL_INT_VEC3;
+    static void set(GLint location, GLsizei count, const glm::ivec3* value) { glUniform3iv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::ivec4>
+{
+    static const GLenum type = GL_INT_VEC4;
+    static void set(GLint location, GLsizei count, const glm::ivec4* value) { glUniform4iv(location, count, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::mat3>
+{
+    static const GLenum type = GL_FLOAT_MAT3;
+    static void set(GLint location, GLsizei count, const glm::mat3* value) { glUniformMatrix3fv(location, count, GL_FALSE, glm::value_ptr(*value)); }
+};
+
+template <> struct UniformTraits<glm::mat4>
+{
+    static const GLenum type = GL_FLOAT_MAT4;
+    static void set(GLint location, GLsizei count, const glm::mat4* value) { glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(*value)); }
+};
@@ -0,0 +1,65 @@
+#include "ShaderVariantCache.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shaderLoad.h"
+#include "ShaderCompiler.h"
+
+#include <iostream>
+
+ShaderVariantCache::ShaderVariantCache(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& features)
+    : vertexPath_(vertexPath), fragmentPath_(fragmentPath), features_(features)
+{
+    if (features_.size() > 32)
+    {
+        std::cout << "ERROR::SHADER::TOO_MANY_FEATURES " << features_.size() << " in " << vertexPath << std::endl;
+        features_.resize(32);
+    }
+}
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+    for (auto& variant : variants_)
+        GLState().deleteProgram(variant.second->ID);
+}
+
+uint32_t ShaderVariantCache::feature(const std::string& name) const
+{
+    for (size_t i = 0; i < features_.size(); i++)
+        if (features_[i] == name)
+            return 1u << i;
+    return 0;
+}
+
+Shader& ShaderVariantCache::get(uint32_t key, ShaderCompiler* compiler)
+{
+    // bits that aren't features would only make copies of the same variant
+    key &= features_.size() == 32 ? 0xFFFFFFFFu : (1u << features_.size()) - 1;
+    auto found = variants_.find(key);
+    if (found != variants_.end())
+        return *found->second;
+
+    std::vector<std::string> defines = definesFor(key);
+    std::unique_ptr<Shader> shader;
+    if (compiler)
+    {
+        shader.reset(new Shader());
+        compiler->submit(*shader, vertexPath_, fragmentPath_, defines);
+    }
+    else
+    {
+        shader.reset(new Shader(vertexPath_.c_str(), fragmentPath_.c_str(), defines));
+    }
+    Shader& variant = *shader;
+    variants_[key] = std::move(shader);
+    return variant;
+}
+
+std::vector<std::string> ShaderVariantCache::definesFor(uint32_t key) const
+{
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < features_.size(); i++)
+        if (key & (1u << i))
+            defines.push_back(features_[i]);
+    return defines;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+class ShaderCompiler;
+
+// the permutations of one vertex and fragment shader pair, compiled when a draw first asks for
+// them. every feature is one bit of the key and a #define of its name in both stages (see
+// PreprocessShader), so a draw that doesn't need a feature gets a program without its code
+// instead of branching over it on a uniform.
+class ShaderVariantCache
+{
+public:
+    // at most 32 features
+    ShaderVariantCache(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& features);
+    // deletes the programs of all variants
+    ~ShaderVariantCache();
+
+    ShaderVariantCache(const ShaderVariantCache&) = delete;
+    ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+    // the key bit of a feature, 0 for names that aren't features of this cache
+    uint32_t feature(const std::string& name) const;
+
+    // the variant for the key, compiled right away on its first use. with a compiler it is only
+    // submitted, its ID stays 0 until ShaderCompiler::poll hands the program over.
+    Shader& get(uint32_t key, ShaderCompiler* compiler = nullptr);
+
+    // number of variants compiled so far
+    size_t variantCount() const { return variants_.size(); }
+
+private:
+    std::vector<std::string> definesFor(uint32_t key) const;
+
+    std::string vertexPath_;
+    std::string fragmentPath_;
+    std::vector<std::string> features_;
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants_;
+};
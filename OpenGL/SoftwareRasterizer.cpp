@@ -0,0 +1,453 @@
+#include "SoftwareRasterizer.h"
+#include "stb_image.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+#include <iostream>
+
+static uint32_t PackRGBA(float r, float g, float b, float a)
+{
+    auto channel = [](float value) {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return (uint32_t)(value * 255.0f + 0.5f);
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+}
+
+// std::floor is a library call without SSE4.1, this is on the per pixel path
+static inline int FloorToInt(float value)
+{
+    int truncated = (int)value;
+    return truncated - (value < (float)truncated ? 1 : 0);
+}
+
+// a + (b - a) * t / 256 for all four channels at once, two channels per 32 bit multiply
+static inline uint32_t LerpRGBA(uint32_t a, uint32_t b, uint32_t t)
+{
+    uint32_t redBlue = (((a & 0x00FF00FF) * (256 - t) + (b & 0x00FF00FF) * t) >> 8) & 0x00FF00FF;
+    uint32_t greenAlpha = (((a >> 8) & 0x00FF00FF) * (256 - t) + ((b >> 8) & 0x00FF00FF) * t) & 0xFF00FF00;
+    return redBlue | greenAlpha;
+}
+
+// GL_LINEAR with GL_REPEAT on both axes, with 8 bit filter weights
+static uint32_t SampleBilinear(const RasterTexture* texture, float u, float v)
+{
+    if (texture == nullptr || texture->texels.empty())
+        return 0xFF000000; // what GL returns for an incomplete texture
+
+    // repeat first, so the texel coordinates stay small for any u and v
+    int x = FloorToInt(((u - (float)FloorToInt(u)) * texture->width - 0.5f) * 256.0f);
+    int y = FloorToInt(((v - (float)FloorToInt(v)) * texture->height - 0.5f) * 256.0f);
+    int x0 = x >> 8, y0 = y >> 8;
+    int x1 = x0 + 1, y1 = y0 + 1;
+    if (x0 < 0) x0 += texture->width;
+    if (y0 < 0) y0 += texture->height;
+    if (x1 >= texture->width) x1 -= texture->width;
+    if (y1 >= texture->height) y1 -= texture->height;
+
+    const uint32_t* row0 = &texture->texels[(size_t)y0 * texture->width];
+    const uint32_t* row1 = &texture->texels[(size_t)y1 * texture->width];
+    uint32_t bottom = LerpRGBA(row0[x0], row0[x1], x & 255);
+    uint32_t top = LerpRGBA(row1[x0], row1[x1], x & 255);
+    return LerpRGBA(bottom, top, y & 255);
+}
+
+bool LoadRasterTexture(const std::string& path, RasterTexture& texture)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data)
+    {
+        std::cout << "ERROR::RASTERIZER::TEXTURE_NOT_LOADED " << path << std::endl;
+        return false;
+    }
+    texture.width = width;
+    texture.height = height;
+    texture.texels.resize((size_t)width * height);
+    memcpy(texture.texels.data(), data, texture.texels.size() * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, JobPool& jobs)
+    : jobs_(jobs), avx2_(CpuHasAVX2())
+{
+    resize(width, height);
+    bindTextures(nullptr, nullptr, 0.0f);
+}
+
+void SoftwareRasterizer::resize(int width, int height)
+{
+    width_ = std::max(width, 1);
+    height_ = std::max(height, 1);
+    tilesX_ = (width_ + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    tilesY_ = (height_ + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    color_.assign((size_t)width_ * height_, 0);
+    depth_.assign((size_t)width_ * height_, 1.0f);
+    bins_.assign((size_t)tilesX_ * tilesY_, std::vector<uint32_t>());
+    triangles_.clear();
+}
+
+void SoftwareRasterizer::clear(const glm::vec4& color)
+{
+    // drawing before the clear would be overwritten anyway
+    triangles_.clear();
+    for (std::vector<uint32_t>& bin : bins_)
+        bin.clear();
+    clearPending_ = true;
+    clearColor_ = PackRGBA(color.x, color.y, color.z, color.w);
+}
+
+void SoftwareRasterizer::bindTextures(const RasterTexture* texture0, const RasterTexture* texture1, float mixFactor)
+{
+    Material material;
+    material.textures[0] = texture0;
+    material.textures[1] = texture1;
+    material.mixWeight = (uint32_t)(std::min(std::max(mixFactor, 0.0f), 1.0f) * 256.0f + 0.5f);
+    materials_.push_back(material);
+}
+
+void SoftwareRasterizer::drawTriangles(const float* vertices, int vertexCount, const glm::mat4& mvp)
+{
+    enum { CLIP_LEFT = 1, CLIP_RIGHT = 2, CLIP_BOTTOM = 4, CLIP_TOP = 8, CLIP_NEAR = 16, CLIP_FAR = 32 };
+    auto outcode = [](const glm::vec4& p) {
+        int code = 0;
+        if (p.x < -p.w) code |= CLIP_LEFT;
+        if (p.x > p.w) code |= CLIP_RIGHT;
+        if (p.y < -p.w) code |= CLIP_BOTTOM;
+        if (p.y > p.w) code |= CLIP_TOP;
+        if (p.z < -p.w) code |= CLIP_NEAR;
+        if (p.z > p.w) code |= CLIP_FAR;
+        return code;
+    };
+
+    for (int i = 0; i + 2 < vertexCount; i += 3)
+    {
+        ClipVertex v[3];
+        int codes[3];
+        for (int k = 0; k < 3; k++)
+        {
+            const float* source = vertices + (size_t)(i + k) * 5;
+            v[k].position = mvp * glm::vec4(source[0], source[1], source[2], 1.0f);
+            v[k].u = source[3];
+            v[k].v = source[4];
+            codes[k] = outcode(v[k].position);
+        }
+
+        // all vertices outside of the same plane
+        if (codes[0] & codes[1] & codes[2])
+            continue;
+
+        if (((codes[0] | codes[1] | codes[2]) & CLIP_NEAR) == 0)
+        {
+            // everything else is left to the guard band: the bounds are clamped to the viewport
+            setupTriangle(v[0], v[1], v[2]);
+            continue;
+        }
+
+        // clip against the near plane (z = -w), one triangle becomes up to two
+        ClipVertex polygon[4];
+        int count = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            const ClipVertex& a = v[k];
+            const ClipVertex& b = v[(k + 1) % 3];
+            float da = a.position.z + a.position.w;
+            float db = b.position.z + b.position.w;
+            if (da >= 0.0f)
+                polygon[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da / (da - db);
+                ClipVertex& clipped = polygon[count++];
+                clipped.position = a.position + (b.position - a.position) * t;
+                clipped.u = a.u + (b.u - a.u) * t;
+                clipped.v = a.v + (b.v - a.v) * t;
+            }
+        }
+        for (int k = 1; k + 1 < count; k++)
+            setupTriangle(polygon[0], polygon[k], polygon[k + 1]);
+    }
+}
+
+void SoftwareRasterizer::setupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2)
+{
+    const ClipVertex* v[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3], invW[3], uOverW[3], vOverW[3];
+    for (int k = 0; k < 3; k++)
+    {
+        const glm::vec4& p = v[k]->position;
+        invW[k] = 1.0f / p.w;
+        // viewport transform, y points up like the GL window coordinates
+        x[k] = (p.x * invW[k] * 0.5f + 0.5f) * width_;
+        y[k] = (p.y * invW[k] * 0.5f + 0.5f) * height_;
+        z[k] = p.z * invW[k] * 0.5f + 0.5f;
+        uOverW[k] = v[k]->u * invW[k];
+        vOverW[k] = v[k]->v * invW[k];
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area != 0.0f) || !std::isfinite(area))
+        return;
+    // no face culling, clockwise triangles are turned around
+    int order[3] = { 0, 1, 2 };
+    if (area < 0.0f)
+    {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    float minX = std::min(std::min(x[0], x[1]), x[2]);
+    float maxX = std::max(std::max(x[0], x[1]), x[2]);
+    float minY = std::min(std::min(y[0], y[1]), y[2]);
+    float maxY = std::max(std::max(y[0], y[1]), y[2]);
+    if (maxX < 0.0f || maxY < 0.0f || minX > (float)width_ || minY > (float)height_)
+        return;
+
+    Triangle triangle;
+    triangle.minX = std::max((int)std::floor(std::max(minX, 0.0f)), 0);
+    triangle.minY = std::max((int)std::floor(std::max(minY, 0.0f)), 0);
+    triangle.maxX = std::min((int)std::ceil(std::min(maxX, (float)width_)), width_ - 1);
+    triangle.maxY = std::min((int)std::ceil(std::min(maxY, (float)height_)), height_ - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        return;
+
+    // edge e lies opposite of vertex e, it is positive inside and equals area at that vertex
+    for (int e = 0; e < 3; e++)
+    {
+        int a = order[(e + 1) % 3];
+        int b = order[(e + 2) % 3];
+        triangle.edgeA[e] = y[a] - y[b];
+        triangle.edgeB[e] = x[b] - x[a];
+        triangle.edgeC[e] = x[a] * y[b] - x[b] * y[a];
+        triangle.edgeInclusive[e] = triangle.edgeA[e] > 0.0f || (triangle.edgeA[e] == 0.0f && triangle.edgeB[e] > 0.0f);
+    }
+
+    // f(x, y) = sum(f_i * edge_i(x, y)) / area
+    auto plane = [&](const float* values, float* out) {
+        out[0] = out[1] = out[2] = 0.0f;
+        for (int e = 0; e < 3; e++)
+        {
+            float value = values[order[e]] / area;
+            out[0] += value * triangle.edgeA[e];
+            out[1] += value * triangle.edgeB[e];
+            out[2] += value * triangle.edgeC[e];
+        }
+    };
+    plane(z, triangle.z);
+    plane(invW, triangle.invW);
+    plane(uOverW, triangle.uOverW);
+    plane(vOverW, triangle.vOverW);
+    triangle.material = (int)materials_.size() - 1;
+
+    triangles_.push_back(triangle);
+    binTriangle((int)triangles_.size() - 1);
+}
+
+void SoftwareRasterizer::binTriangle(int index)
+{
+    const Triangle& triangle = triangles_[index];
+    int tileX0 = triangle.minX / RASTER_TILE_SIZE;
+    int tileY0 = triangle.minY / RASTER_TILE_SIZE;
+    int tileX1 = triangle.maxX / RASTER_TILE_SIZE;
+    int tileY1 = triangle.maxY / RASTER_TILE_SIZE;
+    bool singleTile = tileX0 == tileX1 && tileY0 == tileY1;
+
+    for (int tileY = tileY0; tileY <= tileY1; tileY++)
+    {
+        for (int tileX = tileX0; tileX <= tileX1; tileX++)
+        {
+            if (!singleTile)
+            {
+                // skip tiles of the bounding box the triangle doesn't reach: an edge that is
+                // negative even at the tile's pixel center where it is largest
+                float left = tileX * RASTER_TILE_SIZE + 0.5f;
+                float bottom = tileY * RASTER_TILE_SIZE + 0.5f;
+                float right = left + RASTER_TILE_SIZE - 1.0f;
+                float top = bottom + RASTER_TILE_SIZE - 1.0f;
+                bool outside = false;
+                for (int e = 0; e < 3 && !outside; e++)
+                {
+                    float px = triangle.edgeA[e] >= 0.0f ? right : left;
+                    float py = triangle.edgeB[e] >= 0.0f ? top : bottom;
+                    outside = triangle.edgeA[e] * px + triangle.edgeB[e] * py + triangle.edgeC[e] < 0.0f;
+                }
+                if (outside)
+                    continue;
+            }
+            bins_[(size_t)tileY * tilesX_ + tileX].push_back((uint32_t)index);
+        }
+    }
+}
+
+void SoftwareRasterizer::finish()
+{
+    jobs_.parallelFor(tilesX_ * tilesY_, [this](int tile) { rasterizeTile(tile); });
+
+    for (std::vector<uint32_t>& bin : bins_)
+        bin.clear();
+    triangles_.clear();
+    clearPending_ = false;
+    // the last bound textures stay bound for the next frame
+    Material current = materials_.back();
+    materials_.assign(1, current);
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile)
+{
+    int x0 = (tile % tilesX_) * RASTER_TILE_SIZE;
+    int y0 = (tile / tilesX_) * RASTER_TILE_SIZE;
+    int x1 = std::min(x0 + RASTER_TILE_SIZE, width_);
+    int y1 = std::min(y0 + RASTER_TILE_SIZE, height_);
+
+    if (clearPending_)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            std::fill(color_.begin() + (size_t)y * width_ + x0, color_.begin() + (size_t)y * width_ + x1, clearColor_);
+            std::fill(depth_.begin() + (size_t)y * width_ + x0, depth_.begin() + (size_t)y * width_ + x1, 1.0f);
+        }
+    }
+
+    for (uint32_t index : bins_[tile])
+    {
+        const Triangle& triangle = triangles_[index];
+        int left = std::max(x0, triangle.minX);
+        int bottom = std::max(y0, triangle.minY);
+        int right = std::min(x1, triangle.maxX + 1);
+        int top = std::min(y1, triangle.maxY + 1);
+        if (left >= right || bottom >= top)
+            continue;
+        rasterizeTriangle(triangle, left, bottom, right, top);
+    }
+}
+
+uint32_t SoftwareRasterizer::shade(const Material& material, float u, float v) const
+{
+    // FragColor = mix(texture(ourTexture, TexCoord), texture(texture2, TexCoord), mixFactor)
+    return LerpRGBA(SampleBilinear(material.textures[0], u, v), SampleBilinear(material.textures[1], u, v), material.mixWeight);
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const Triangle& triangle, int x0, int y0, int x1, int y1)
+{
+    const Material& material = materials_[triangle.material];
+    int visibleX[RASTER_TILE_SIZE];
+    float visibleU[RASTER_TILE_SIZE];
+    float visibleV[RASTER_TILE_SIZE];
+    for (int y = y0; y < y1; y++)
+    {
+        // the depth test runs first (and writes the depth), only what is left gets shaded
+        int visible = avx2_ ? coverRowAVX2(triangle, y, x0, x1, visibleX, visibleU, visibleV)
+                            : coverRowScalar(triangle, y, x0, x1, visibleX, visibleU, visibleV);
+        uint32_t* colorRow = &color_[(size_t)y * width_];
+        for (int i = 0; i < visible; i++)
+            colorRow[visibleX[i]] = shade(material, visibleU[i], visibleV[i]);
+    }
+}
+
+int SoftwareRasterizer::coverRowScalar(const Triangle& triangle, int y, int x0, int x1, int* visibleX, float* visibleU, float* visibleV)
+{
+    float py = y + 0.5f;
+    float* depthRow = &depth_[(size_t)y * width_];
+    int visible = 0;
+    for (int x = x0; x < x1; x++)
+    {
+        float px = x + 0.5f;
+        bool inside = true;
+        for (int e = 0; e < 3 && inside; e++)
+        {
+            float value = triangle.edgeA[e] * px + triangle.edgeB[e] * py + triangle.edgeC[e];
+            inside = triangle.edgeInclusive[e] ? value >= 0.0f : value > 0.0f;
+        }
+        if (!inside)
+            continue;
+
+        float z = triangle.z[0] * px + triangle.z[1] * py + triangle.z[2];
+        if (!(z < depthRow[x]))
+            continue;
+        depthRow[x] = z;
+
+        float w = 1.0f / (triangle.invW[0] * px + triangle.invW[1] * py + triangle.invW[2]);
+        visibleX[visible] = x;
+        visibleU[visible] = (triangle.uOverW[0] * px + triangle.uOverW[1] * py + triangle.uOverW[2]) * w;
+        visibleV[visible] = (triangle.vOverW[0] * px + triangle.vOverW[1] * py + triangle.vOverW[2]) * w;
+        visible++;
+    }
+    return visible;
+}
+
+// nothing but coverage and depth in here: calling the (not AVX) shading from AVX code
+// would pay for the ymm state transitions on every call
+AVX2_TARGET
+int SoftwareRasterizer::coverRowAVX2(const Triangle& triangle, int y, int x0, int x1, int* visibleX, float* visibleU, float* visibleV)
+{
+    const __m256 laneCenters = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 end = _mm256_set1_ps((float)x1);
+
+    // the y part of every plane is constant along the row
+    float py = y + 0.5f;
+    __m256 edgeA[3], rowEdge[3];
+    for (int e = 0; e < 3; e++)
+    {
+        edgeA[e] = _mm256_set1_ps(triangle.edgeA[e]);
+        rowEdge[e] = _mm256_set1_ps(triangle.edgeB[e] * py + triangle.edgeC[e]);
+    }
+    const __m256 zA = _mm256_set1_ps(triangle.z[0]);
+    const __m256 rowZ = _mm256_set1_ps(triangle.z[1] * py + triangle.z[2]);
+    const __m256 invWA = _mm256_set1_ps(triangle.invW[0]);
+    const __m256 rowInvW = _mm256_set1_ps(triangle.invW[1] * py + triangle.invW[2]);
+    const __m256 uA = _mm256_set1_ps(triangle.uOverW[0]);
+    const __m256 rowU = _mm256_set1_ps(triangle.uOverW[1] * py + triangle.uOverW[2]);
+    const __m256 vA = _mm256_set1_ps(triangle.vOverW[0]);
+    const __m256 rowV = _mm256_set1_ps(triangle.vOverW[1] * py + triangle.vOverW[2]);
+
+    float* depthRow = &depth_[(size_t)y * width_];
+    alignas(32) float spanU[8];
+    alignas(32) float spanV[8];
+    int visible = 0;
+
+    for (int x = x0; x < x1; x += 8)
+    {
+        // 8 pixels of the row, lanes past the right end of the span are masked off
+        __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), laneCenters);
+        __m256 mask = _mm256_cmp_ps(px, end, _CMP_LT_OQ);
+        for (int e = 0; e < 3; e++)
+        {
+            __m256 value = _mm256_fmadd_ps(edgeA[e], px, rowEdge[e]);
+            if (triangle.edgeInclusive[e])
+                mask = _mm256_and_ps(mask, _mm256_cmp_ps(value, zero, _CMP_GE_OQ));
+            else
+                mask = _mm256_and_ps(mask, _mm256_cmp_ps(value, zero, _CMP_GT_OQ));
+        }
+        if (_mm256_movemask_ps(mask) == 0)
+            continue;
+
+        // masked loads and stores, the pixels next to the span may belong to another tile's thread
+        __m256 z = _mm256_fmadd_ps(zA, px, rowZ);
+        __m256 depth = _mm256_maskload_ps(depthRow + x, _mm256_castps_si256(mask));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, depth, _CMP_LT_OQ));
+        int covered = _mm256_movemask_ps(mask);
+        if (covered == 0)
+            continue;
+        _mm256_maskstore_ps(depthRow + x, _mm256_castps_si256(mask), z);
+
+        __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_fmadd_ps(invWA, px, rowInvW));
+        _mm256_store_ps(spanU, _mm256_mul_ps(_mm256_fmadd_ps(uA, px, rowU), w));
+        _mm256_store_ps(spanV, _mm256_mul_ps(_mm256_fmadd_ps(vA, px, rowV), w));
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (covered & (1 << lane))
+            {
+                visibleX[visible] = x + lane;
+                visibleU[visible] = spanU[lane];
+                visibleV[visible] = spanV[lane];
+                visible++;
+            }
+        }
+    }
+    return visible;
+}
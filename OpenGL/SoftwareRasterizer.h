@@ -0,0 +1,115 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "JobPool.h"
+
+// CPU rendering backend for the textured cube samples.
+//
+// drawTriangles only transforms, clips (near plane) and sets up the triangles and sorts them
+// into RASTER_TILE_SIZE x RASTER_TILE_SIZE screen tiles. finish() then rasterizes the tiles in
+// parallel on a JobPool, every tile runs through its triangles in submission order, so no two
+// threads ever touch the same pixel.
+//
+// coverage and depth are evaluated for 8 pixels of a row at once with AVX2 where the CPU has it.
+// depth is a 32 bit float buffer with GL_LESS, texture coordinates are interpolated perspective
+// correct and the shading matches fragmentCoordianteSystem.shader: two bilinear filtered, repeating
+// textures mixed by a constant factor (filtering and mixing in 8 bit fixed point). the buffers use
+// the GL conventions (row 0 is the bottom row, RGBA8 color), so the color buffer can be uploaded to
+// a texture as it is.
+
+const int RASTER_TILE_SIZE = 64;
+
+// RGBA8 texels, row 0 is t = 0 like a GL texture
+struct RasterTexture
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> texels;
+};
+
+// loads an image file as 4 channels (honours stbi_set_flip_vertically_on_load like the GL samples)
+bool LoadRasterTexture(const std::string& path, RasterTexture& texture);
+
+class SoftwareRasterizer
+{
+public:
+    SoftwareRasterizer(int width, int height, JobPool& jobs);
+
+    void resize(int width, int height);
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // color and depth (1.0) are cleared by the tiles in finish(), like glClear
+    void clear(const glm::vec4& color);
+
+    // textures of the following draws, the result is mix(texture0, texture1, mixFactor)
+    void bindTextures(const RasterTexture* texture0, const RasterTexture* texture1, float mixFactor);
+
+    // triangle list with x y z u v per vertex (attribute 0 and 1 of the GL samples)
+    void drawTriangles(const float* vertices, int vertexCount, const glm::mat4& mvp);
+
+    // rasterizes everything drawn since the last finish()
+    void finish();
+
+    const uint32_t* colorBuffer() const { return color_.data(); }
+    const float* depthBuffer() const { return depth_.data(); }
+
+    // whether the AVX2 span code is used on this CPU
+    bool usesAVX2() const { return avx2_; }
+
+private:
+    struct ClipVertex
+    {
+        glm::vec4 position;
+        float u, v;
+    };
+
+    // edge functions and attribute planes: f(x, y) = a * x + b * y + c at pixel centers
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        bool edgeInclusive[3];      // of two triangles sharing an edge exactly one owns the pixels on it
+        float z[3];
+        float invW[3];
+        float uOverW[3];
+        float vOverW[3];
+        int minX, minY, maxX, maxY; // inclusive pixel bounds inside the viewport
+        int material;
+    };
+
+    struct Material
+    {
+        const RasterTexture* textures[2];
+        uint32_t mixWeight;         // mixFactor in 1/256
+    };
+
+    void setupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+    void binTriangle(int index);
+    void rasterizeTile(int tile);
+    void rasterizeTriangle(const Triangle& triangle, int x0, int y0, int x1, int y1);
+    // coverage and depth test of one row of a triangle, returns the pixels left to shade
+    int coverRowScalar(const Triangle& triangle, int y, int x0, int x1, int* visibleX, float* visibleU, float* visibleV);
+    int coverRowAVX2(const Triangle& triangle, int y, int x0, int x1, int* visibleX, float* visibleU, float* visibleV);
+    uint32_t shade(const Material& material, float u, float v) const;
+
+    JobPool& jobs_;
+    int width_ = 0;
+    int height_ = 0;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    bool avx2_ = false;
+
+    std::vector<uint32_t> color_;
+    std::vector<float> depth_;
+
+    bool clearPending_ = false;
+    uint32_t clearColor_ = 0;
+
+    std::vector<Material> materials_;
+    std::vector<Triangle> triangles_;
+    std::vector<std::vector<uint32_t>> bins_;   // triangle indices per tile
+};
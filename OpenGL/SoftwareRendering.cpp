@@ -0,0 +1,251 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include "stb_image.h"
+#include "Utility.h"
+#include "GLExtensions.h"
+#include "SceneRenderer.h"
+
+// renders the cube scene of CoordinateSystem_Z_Buffer.cpp / Camera.cpp either with GL or with the
+// tile based software rasterizer and prints the average frame time every 100 frames.
+//
+// usage: SoftwareRendering [gl|cpu] [camera|zbuffer] [frames] [threads]
+//   camera  - fly camera of Camera.cpp (WASD + mouse), zbuffer - fixed view of CoordinateSystem_Z_Buffer.cpp
+//   frames  - quit after that many frames (0 = run until the window is closed)
+//   threads - worker threads of the software rasterizer (0 = all hardware threads)
+//
+// for the comparison against llvmpipe run "gl" with Mesa's opengl32.dll next to the executable
+// (GALLIUM_DRIVER=llvmpipe), GL_RENDERER is printed at startup. a frame is timed from the start
+// of rendering until glFinish returns, so both backends include getting the image on screen.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = SCR_WIDTH / 2.0;
+float lastY = SCR_HEIGHT / 2.0;
+float fov = 45.0f;
+
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+int main(int argc, char** argv)
+{
+    bool software = argc > 1 && std::string(argv[1]) == "cpu";
+    bool flyCamera = !(argc > 2 && std::string(argv[2]) == "zbuffer");
+    int maxFrames = argc > 3 ? std::stoi(argv[3]) : 0;
+    unsigned int threads = argc > 4 ? (unsigned int)std::stoul(argv[4]) : 0;
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    if (flyCamera)
+    {
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+    // no vsync, the frame times should show the renderer and not the display
+    glfwSwapInterval(0);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << std::endl;
+
+    {
+        // one scene, two ways to draw it
+        // ------------------------------
+        stbi_set_flip_vertically_on_load(true);
+        Scene scene = CreateCubeScene();
+        scene.clearColor = flyCamera ? glm::vec4(0.2f, 0.7f, 0.7f, 1.0f) : glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+        std::unique_ptr<SceneRenderer> renderer;
+        if (software)
+            renderer.reset(new SoftwareSceneRenderer(scene, threads));
+        else
+            renderer.reset(new GLSceneRenderer(scene));
+        std::cout << "backend: " << renderer->name() << std::endl;
+
+        double frameTimeSum = 0.0;
+        int framesMeasured = 0;
+        int frame = 0;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window) && (maxFrames == 0 || frame < maxFrames))
+        {
+            // per-frame time logic
+            // --------------------
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            processInput(window);
+
+            glm::mat4 view = glm::mat4(1.0f);
+            glm::mat4 projection = glm::mat4(1.0f);
+            if (flyCamera)
+            {
+                view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+                projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            }
+            else
+            {
+                view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+                projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            }
+
+            // render
+            // ------
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            auto start = std::chrono::steady_clock::now();
+            renderer->render(scene, view, projection, width, height);
+            glFinish();
+            auto end = std::chrono::steady_clock::now();
+
+            frameTimeSum += std::chrono::duration<double, std::milli>(end - start).count();
+            framesMeasured++;
+            frame++;
+            if (framesMeasured == 100)
+            {
+                std::cout << renderer->name() << ": " << frameTimeSum / framesMeasured << " ms per frame" << std::endl;
+                frameTimeSum = 0.0;
+                framesMeasured = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        if (framesMeasured > 0)
+            std::cout << renderer->name() << ": " << frameTimeSum / framesMeasured << " ms per frame" << std::endl;
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    float cameraSpeed = 2.5f * deltaTime;
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // the renderers set the viewport from the framebuffer size every frame
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // to avoid a camera jump causing by mouse focus on game start
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+    lastX = xpos;
+    lastY = ypos;
+
+    const float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
@@ -0,0 +1,393 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "TextureQuality.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+#include "RenderTarget.h"
+#include "Scene.h"
+
+// texture filter presets and lod bias against their cost.
+//
+// the cubes of the cube scene float over a floor of cubes that is seen at a flat angle, where
+// the plain GL_LINEAR the other samples use shimmers and the difference between the presets shows.
+// the floor and the floating cubes are two materials with a TextureQuality each.
+//
+// keys: 1..7 filter preset of the floor (linear, bilinear, trilinear, anisotropic 2x..16x)
+//       UP/DOWN lod bias of the floor in steps of 0.5
+//       T sweeps the presets for both materials: GPU time of the frame (GL_TIME_ELAPSED) and the
+//         PSNR against a 4x4 supersampled frame with the best filter the context has. the cheapest
+//         preset close to the best PSNR is a good default for a machine like this one.
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const int FLOOR_SIZE = 48;          // cubes along each side of the floor
+const int SUPERSAMPLING = 4;        // of the reference frame, per axis
+const int WARMUP_FRAMES = 5;
+const int TIMED_FRAMES = 30;
+
+struct Material
+{
+    TextureQuality quality;
+    GLuint sampler;
+};
+
+TextureFilter floorFilter = TEXTURE_FILTER_LINEAR;
+float floorLodBias = 0.0f;
+bool qualityChanged = true;
+bool sweepRequested = false;
+
+// the rgb of the bound framebuffer, averaged over blocks of factor x factor pixels
+static std::vector<float> ReadImage(int width, int height, int factor)
+{
+    std::vector<unsigned char> pixels((size_t)width * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    int outWidth = width / factor, outHeight = height / factor;
+    std::vector<float> image((size_t)outWidth * outHeight * 3, 0.0f);
+    float weight = 1.0f / (factor * factor);
+    for (int y = 0; y < outHeight * factor; y++)
+    {
+        for (int x = 0; x < outWidth * factor; x++)
+        {
+            const unsigned char* pixel = &pixels[((size_t)y * width + x) * 4];
+            float* out = &image[((size_t)(y / factor) * outWidth + x / factor) * 3];
+            out[0] += pixel[0] * weight;
+            out[1] += pixel[1] * weight;
+            out[2] += pixel[2] * weight;
+        }
+    }
+    return image;
+}
+
+// peak signal to noise ratio in dB, higher is closer to the reference
+static double Psnr(const std::vector<float>& image, const std::vector<float>& reference)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        double difference = image[i] - reference[i];
+        sum += difference * difference;
+    }
+    double mse = sum / image.size();
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+struct SceneDraw
+{
+    Shader* shader;
+    UniformHandle model, view, projection;
+    GLuint vertexArray;
+    GLsizei vertexCount;
+    GLuint textures[2];
+    const Scene* scene;
+};
+
+static void DrawScene(const SceneDraw& draw, const Material& floor, const Material& cubes, float time, float aspect)
+{
+    const Scene& scene = *draw.scene;
+    glClearColor(scene.clearColor.x, scene.clearColor.y, scene.clearColor.z, scene.clearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    draw.shader->use();
+    GLState().bindVertexArray(draw.vertexArray);
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, draw.textures[0]);
+    GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, draw.textures[1]);
+
+    // low over the floor, looking along it
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, -1.2f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+    draw.shader->set(draw.view, view);
+    draw.shader->set(draw.projection, projection);
+
+    GLState().bindSampler(0, floor.sampler);
+    GLState().bindSampler(1, floor.sampler);
+    for (int z = 0; z < FLOOR_SIZE; z++)
+    {
+        for (int x = 0; x < FLOOR_SIZE; x++)
+        {
+            glm::vec3 position(x - FLOOR_SIZE * 0.5f + 0.5f, -3.5f, 3.0f - z);
+            draw.shader->set(draw.model, glm::translate(glm::mat4(1.0f), position));
+            glDrawArrays(GL_TRIANGLES, 0, draw.vertexCount);
+        }
+    }
+
+    GLState().bindSampler(0, cubes.sampler);
+    GLState().bindSampler(1, cubes.sampler);
+    for (size_t i = 0; i < scene.models.size(); i++)
+    {
+        glm::mat4 model = glm::rotate(scene.models[i], time, glm::vec3(0.5f, 1.0f, 0.0f));
+        draw.shader->set(draw.model, model);
+        glDrawArrays(GL_TRIANGLES, 0, draw.vertexCount);
+    }
+}
+
+// renders every case into a target of the window size and compares it with the supersampled
+// reference. the scene is frozen at the same time for all frames so the images are comparable.
+static void RunSweep(const SceneDraw& draw, SamplerCache& samplers)
+{
+    struct SweepCase
+    {
+        TextureFilter filter;
+        float lodBias;
+    };
+    const SweepCase cases[] = {
+        { TEXTURE_FILTER_LINEAR, 0.0f }, { TEXTURE_FILTER_BILINEAR, 0.0f }, { TEXTURE_FILTER_TRILINEAR, 0.0f },
+        { TEXTURE_FILTER_TRILINEAR, -1.0f }, { TEXTURE_FILTER_TRILINEAR, 1.0f },
+        { TEXTURE_FILTER_ANISOTROPIC_2X, 0.0f }, { TEXTURE_FILTER_ANISOTROPIC_4X, 0.0f },
+        { TEXTURE_FILTER_ANISOTROPIC_8X, 0.0f }, { TEXTURE_FILTER_ANISOTROPIC_16X, 0.0f },
+        { TEXTURE_FILTER_ANISOTROPIC_16X, 1.0f },
+    };
+    const int caseCount = sizeof(cases) / sizeof(cases[0]);
+    const float time = 1.0f;
+    const float aspect = (float)SCR_WIDTH / (float)SCR_HEIGHT;
+
+    // reference
+    // ---------
+    Material reference;
+    reference.quality.filter = TEXTURE_FILTER_ANISOTROPIC_16X;
+    reference.sampler = samplers.get(reference.quality.samplerState());
+    std::vector<float> referenceImage;
+    {
+        RenderTarget large(SCR_WIDTH * SUPERSAMPLING, SCR_HEIGHT * SUPERSAMPLING);
+        large.bind();
+        DrawScene(draw, reference, reference, time, aspect);
+        referenceImage = ReadImage(large.width(), large.height(), SUPERSAMPLING);
+    }
+
+    // the cases
+    // ---------
+    RenderTarget target(SCR_WIDTH, SCR_HEIGHT);
+    target.bind();
+    GLuint query;
+    glGenQueries(1, &query);
+
+    std::cout << "reference: " << TextureFilterName(SupportedTextureFilter(TEXTURE_FILTER_ANISOTROPIC_16X)) << " at "
+        << SUPERSAMPLING << "x" << SUPERSAMPLING << " supersampling" << std::endl;
+    double times[caseCount], psnrs[caseCount];
+    double bestPsnr = 0.0;
+    for (int i = 0; i < caseCount; i++)
+    {
+        Material material;
+        material.quality.filter = cases[i].filter;
+        material.quality.lodBias = cases[i].lodBias;
+        material.sampler = samplers.get(material.quality.samplerState());
+
+        for (int frame = 0; frame < WARMUP_FRAMES; frame++)
+            DrawScene(draw, material, material, time, aspect);
+        GLuint64 total = 0;
+        for (int frame = 0; frame < TIMED_FRAMES; frame++)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            DrawScene(draw, material, material, time, aspect);
+            glEndQuery(GL_TIME_ELAPSED);
+            // waits for the frame, which is fine here: the frames are measured one by one
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            total += elapsed;
+        }
+        times[i] = total / 1e6 / TIMED_FRAMES;
+        psnrs[i] = Psnr(ReadImage(target.width(), target.height(), 1), referenceImage);
+        if (psnrs[i] > bestPsnr)
+            bestPsnr = psnrs[i];
+
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-16s bias %+.1f: %6.3f ms GPU, %5.2f dB", TextureFilterName(SupportedTextureFilter(cases[i].filter)),
+            cases[i].lodBias, times[i], psnrs[i]);
+        std::cout << line << std::endl;
+    }
+
+    // the cheapest case that gives away at most half a dB
+    int pick = -1;
+    for (int i = 0; i < caseCount; i++)
+    {
+        if (psnrs[i] >= bestPsnr - 0.5 && (pick < 0 || times[i] < times[pick]))
+            pick = i;
+    }
+    std::cout << "cheapest within 0.5 dB of the best: " << TextureFilterName(SupportedTextureFilter(cases[pick].filter))
+        << ", bias " << cases[pick].lodBias << " (" << samplers.size() << " sampler objects)" << std::endl;
+
+    glDeleteQueries(1, &query);
+    // the render loop sets the viewport of the window again
+    RenderTarget::bindDefault(SCR_WIDTH, SCR_HEIGHT);
+}
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+    std::cout << "max anisotropy " << MaxTextureAnisotropy() << std::endl;
+
+    {
+        Scene scene = CreateCubeScene();
+        Shader shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+
+        const VertexAttribFormat attributes[] = {
+            { 0, 3, GL_FLOAT, GL_FALSE, false, 0 },
+            { 1, 2, GL_FLOAT, GL_FALSE, false, 3 * sizeof(float) },
+        };
+        GLuint VBO = CreateBuffer((GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data());
+        GLuint VAO = CreateVertexArray();
+        SetVertexBuffer(VAO, 0, VBO, 5 * sizeof(float), attributes, 2);
+
+        stbi_set_flip_vertically_on_load(true);
+        SceneDraw draw;
+        draw.shader = &shader;
+        draw.model = shader.uniform("model"_u);
+        draw.view = shader.uniform("view"_u);
+        draw.projection = shader.uniform("projection"_u);
+        draw.vertexArray = VAO;
+        draw.vertexCount = (GLsizei)(scene.vertices.size() / 5);
+        draw.scene = &scene;
+        for (int i = 0; i < 2; i++)
+            draw.textures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+
+        shader.use();
+        shader.set("ourTexture"_u, 0);
+        shader.set("texture2"_u, 1);
+
+        SamplerCache samplers;
+        Material floor, cubes;
+        cubes.sampler = samplers.get(cubes.quality.samplerState());
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+
+            if (sweepRequested)
+            {
+                sweepRequested = false;
+                RunSweep(draw, samplers);
+            }
+            if (qualityChanged)
+            {
+                qualityChanged = false;
+                floor.quality.filter = floorFilter;
+                floor.quality.lodBias = floorLodBias;
+                floor.sampler = samplers.get(floor.quality.samplerState());
+                std::cout << "floor: " << TextureFilterName(SupportedTextureFilter(floorFilter)) << ", lod bias " << floorLodBias << std::endl;
+            }
+
+            // render
+            // ------
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            GLState().viewport(0, 0, width, height);
+            DrawScene(draw, floor, cubes, (float)glfwGetTime(), height > 0 ? (float)width / (float)height : 1.0f);
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteVertexArrays(1, &VAO);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, draw.textures);
+        GLState().deleteProgram(shader.ID);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    for (int i = 0; i < TEXTURE_FILTER_COUNT; i++)
+    {
+        if (glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS && floorFilter != (TextureFilter)i)
+        {
+            floorFilter = (TextureFilter)i;
+            qualityChanged = true;
+        }
+    }
+
+    // react on the key press only, not every frame the key is down
+    static bool upWasPressed = false, downWasPressed = false, tWasPressed = false;
+    bool upPressed = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+    bool downPressed = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+    bool tPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+    if (upPressed && !upWasPressed)
+    {
+        floorLodBias += 0.5f;
+        qualityChanged = true;
+    }
+    if (downPressed && !downWasPressed)
+    {
+        floorLodBias -= 0.5f;
+        qualityChanged = true;
+    }
+    if (tPressed && !tWasPressed)
+        sweepRequested = true;
+    upWasPressed = upPressed;
+    downWasPressed = downPressed;
+    tWasPressed = tPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // the render loop sets the viewport of the window every frame, the sweep changes it
+}
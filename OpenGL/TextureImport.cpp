@@ -0,0 +1,285 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//for mathematics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "shaderLoad.h"
+#include "stb_image.h"
+#include "Utility.h"
+#include "TextureLoad.h"
+#include "SamplerCache.h"
+#include "HalfFloat.h"
+#include "CpuFeatures.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "GLResources.h"
+#include "Scene.h"
+#include "PipelineBuilder.h"
+
+// sRGB correct textures and half float HDR import.
+//
+// usage: TextureImport [image.hdr]
+//
+// the cube scene twice: with the textures uploaded as linear GL_RGB/GL_RGBA the way the other
+// samples do it, and imported with ImportTexture2D as GL_SRGB8_ALPHA8 into an sRGB default
+// framebuffer, so the shader mixes and filters linear values. an .hdr file given on the command
+// line is imported as GL_R11F_G11F_B10F and GL_RGBA16F and replaces the container (no tone
+// mapping, values above 1 are clipped).
+// the float to half conversion is timed with and without F16C on a 2048x1024 rgb image.
+//
+// keys: S switches between the linear upload and the sRGB import
+//       H switches the hdr image between GL_R11F_G11F_B10F and GL_RGBA16F
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+bool srgb = true;
+bool compactHdr = true;
+bool modeChanged = true;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char* FormatName(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_SRGB8_ALPHA8: return "GL_SRGB8_ALPHA8";
+    case GL_R11F_G11F_B10F: return "GL_R11F_G11F_B10F";
+    case GL_RGBA16F: return "GL_RGBA16F";
+    case GL_R8: return "GL_R8";
+    case GL_RG8: return "GL_RG8";
+    case GL_RGB8: return "GL_RGB8";
+    case GL_RGBA8: return "GL_RGBA8";
+    case GL_R16: return "GL_R16";
+    case GL_RG16: return "GL_RG16";
+    case GL_RGB16: return "GL_RGB16";
+    case GL_RGBA16: return "GL_RGBA16";
+    default: return "other";
+    }
+}
+
+// the clear color is given in sRGB, with GL_FRAMEBUFFER_SRGB it has to be linear
+static float SrgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static ImportedTexture Import(const std::string& path, TextureUsage usage, GLenum hdrFormat = GL_R11F_G11F_B10F)
+{
+    auto start = std::chrono::steady_clock::now();
+    ImportedTexture imported = ImportTexture2D(path, usage, hdrFormat);
+    if (imported.texture != 0)
+        std::cout << path << ": " << imported.width << "x" << imported.height << " " << FormatName(imported.internalFormat)
+            << ", " << MillisecondsSince(start) << " ms" << std::endl;
+    return imported;
+}
+
+// FloatsToHalves against FloatToHalf one value at a time, on the size of a small HDR panorama
+static void BenchmarkHalfConversion()
+{
+    const size_t count = 2048 * 1024 * 3;
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; i++)
+        values[i] = (float)(i % 4096) / 256.0f;
+    std::vector<uint16_t> halves(count), reference(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+        reference[i] = FloatToHalf(values[i]);
+    double scalar = MillisecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    FloatsToHalves(values.data(), halves.data(), count);
+    double bulk = MillisecondsSince(start);
+
+    std::cout << "float to half, 2048x1024 rgb: " << scalar << " ms one by one, " << bulk << " ms FloatsToHalves ("
+        << (CpuHasF16C() ? "F16C" : "no F16C, plain C++") << ")" << (halves == reference ? "" : ", results differ") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const char* hdrPath = argc > 1 ? argv[1] : NULL;
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // GL_FRAMEBUFFER_SRGB only encodes on a default framebuffer that is sRGB capable
+    glfwWindowHint(GLFW_SRGB_CAPABLE, GL_TRUE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLState().enable(GL_DEPTH_TEST);
+
+    BenchmarkHalfConversion();
+
+    {
+        Scene scene = CreateCubeScene();
+        Shader shader(scene.vertexShaderPath.c_str(), scene.fragmentShaderPath.c_str());
+        // set every draw, so resolved once
+        UniformHandle modelUniform = shader.uniform("model"_u);
+        UniformHandle viewUniform = shader.uniform("view"_u);
+        UniformHandle projectionUniform = shader.uniform("projection"_u);
+        GLuint VBO = CreateBuffer((GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data());
+        GLsizei vertexCount = (GLsizei)(scene.vertices.size() / 5);
+
+        // the textures: linear as before, imported as sRGB, and the optional hdr image in both formats
+        // -------------------------------------------------------------------------------------------
+        stbi_set_flip_vertically_on_load(true);
+        GLuint linearTextures[2], srgbTextures[2];
+        for (int i = 0; i < 2; i++)
+        {
+            linearTextures[i] = LoadImmutableTexture2D(scene.texturePaths[i]);
+            srgbTextures[i] = Import(scene.texturePaths[i], TEXTURE_USAGE_COLOR).texture;
+        }
+        GLuint hdrTextures[2] = { 0, 0 };
+        if (hdrPath != NULL)
+        {
+            hdrTextures[0] = Import(hdrPath, TEXTURE_USAGE_COLOR, GL_R11F_G11F_B10F).texture;
+            hdrTextures[1] = Import(hdrPath, TEXTURE_USAGE_COLOR, GL_RGBA16F).texture;
+        }
+
+        SamplerCache samplers;
+        SamplerState trilinear;
+        trilinear.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        GLuint sampler = samplers.get(trilinear);
+
+        VertexLayout layout(5 * sizeof(float));
+        layout.add("aPos", 3, GL_FLOAT, 0).add("aTexCoord", 2, GL_FLOAT, 3 * sizeof(float));
+        std::unique_ptr<Pipeline> cubes;
+
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+
+            // the pipeline holds the textures, so it is built again when they change
+            if (modeChanged)
+            {
+                modeChanged = false;
+                const GLuint* textures = srgb ? srgbTextures : linearTextures;
+                GLuint first = hdrTextures[compactHdr ? 0 : 1] != 0 ? hdrTextures[compactHdr ? 0 : 1] : textures[0];
+                cubes.reset(new Pipeline(PipelineBuilder(shader).vertexBuffer(VBO, layout)
+                    .texture("ourTexture", GL_TEXTURE_2D, first, sampler).texture("texture2", GL_TEXTURE_2D, textures[1], sampler)));
+                if (srgb)
+                    GLState().enable(GL_FRAMEBUFFER_SRGB);
+                else
+                    GLState().disable(GL_FRAMEBUFFER_SRGB);
+                std::cout << (srgb ? "sRGB import, sRGB framebuffer" : "linear upload") << (hdrPath != NULL ? (compactHdr ? ", hdr GL_R11F_G11F_B10F" : ", hdr GL_RGBA16F") : "") << std::endl;
+            }
+
+            // render
+            // ------
+            glm::vec4 clear = scene.clearColor;
+            if (srgb)
+                clear = glm::vec4(SrgbToLinear(clear.x), SrgbToLinear(clear.y), SrgbToLinear(clear.z), clear.w);
+            glClearColor(clear.x, clear.y, clear.z, clear.w);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            cubes->bind();
+            glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            shader.set(viewUniform, view);
+            shader.set(projectionUniform, projection);
+            for (size_t i = 0; i < scene.models.size(); i++)
+            {
+                glm::mat4 model = glm::rotate(scene.models[i], (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
+                shader.set(modelUniform, model);
+                glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        GLState().deleteProgram(shader.ID);
+        GLState().deleteBuffers(1, &VBO);
+        GLState().deleteTextures(2, linearTextures);
+        GLState().deleteTextures(2, srgbTextures);
+        GLState().deleteTextures(2, hdrTextures);
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // react on the key press only, not every frame the key is down
+    static bool sWasPressed = false, hWasPressed = false;
+    bool sPressed = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+    bool hPressed = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+    if (sPressed && !sWasPressed)
+    {
+        srgb = !srgb;
+        modeChanged = true;
+    }
+    if (hPressed && !hWasPressed)
+    {
+        compactHdr = !compactHdr;
+        modeChanged = true;
+    }
+    sWasPressed = sPressed;
+    hWasPressed = hPressed;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    GLState().viewport(0, 0, width, height);
+}
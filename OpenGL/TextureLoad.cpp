@@ -0,0 +1,295 @@
+#include "TextureLoad.h"
+#include "stb_image.h"
+#include "ImageArena.h"
+#include "GLExtensions.h"
+#include "GLResources.h"
+#include "GLStateCache.h"
+#include "HalfFloat.h"
+
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+// GL pixel format that matches a tightly packed image with the given channel count
+static GLenum PixelFormatFromChannels(int channels)
+{
+    switch (channels)
+    {
+    case 1: return GL_RED;
+    case 2: return GL_RG;
+    case 3: return GL_RGB;
+    default: return GL_RGBA;
+    }
+}
+
+// sized internal format for the storage of a texture with the given metadata
+static GLenum InternalFormatFromInfo(const TextureInfo& info)
+{
+    static const GLenum formats8[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    static const GLenum formats16[] = { GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+    static const GLenum formatsFloat[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+    int index = (info.channels < 1 ? 1 : info.channels > 4 ? 4 : info.channels) - 1;
+    if (info.isHdr)
+        return formatsFloat[index];
+    return info.is16Bit ? formats16[index] : formats8[index];
+}
+
+// true if the texture bound to GL_TEXTURE_2D was created with glTexStorage2D
+static bool BoundTextureIsImmutable()
+{
+    if (!HasTextureStorage())
+        return false;
+    GLint immutable = GL_FALSE;
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+    return immutable == GL_TRUE;
+}
+
+unsigned int CreateTextureStorage(const TextureInfo* info)
+{
+    unsigned int texture;
+    if (info == NULL)
+        glGenTextures(1, &texture);
+    else
+        texture = CreateTexture2D(info->levels, InternalFormatFromInfo(*info), info->width, info->height);
+    // LoadTexture2D uploads to the bound texture. unit 0 like GLResources, so the state cache
+    // knows the unit and the binding
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture);
+    return texture;
+}
+
+// the encoded image either comes from a file (memory == NULL) or from memory, e.g. an asset pack entry
+static bool UploadImage(const std::string& path, const unsigned char* memory, size_t length, int desiredChannels)
+{
+    // stb_image takes the memory size as int
+    int memoryLength = length > (size_t)INT_MAX ? INT_MAX : (int)length;
+
+    // only the header is read here, so we know how large the pixel buffer has to be
+    int width, height, nrChannels;
+    int probed = memory != NULL ? stbi_info_from_memory(memory, memoryLength, &width, &height, &nrChannels)
+                                : stbi_info(path.c_str(), &width, &height, &nrChannels);
+    if (!probed)
+    {
+        std::cout << "Failed to load texture " << path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    int channels = desiredChannels ? desiredChannels : nrChannels;
+
+    // keep every row 4 byte aligned, that is the default GL_UNPACK_ALIGNMENT
+    // so RGB images with odd widths are uploaded correctly without touching pixel store state
+    int stride = (width * channels + 3) & ~3;
+    GLsizeiptr size = (GLsizeiptr)stride * height;
+
+    // stb_image decodes straight into the mapped buffer, so there is no client side
+    // copy of the image and glTexImage2D reads from the buffer object instead
+    unsigned int pbo;
+    glGenBuffers(1, &pbo);
+    GLState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+    unsigned char* pixels = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    bool decoded = false;
+    if (pixels != NULL)
+    {
+        // the decoder's temporary buffers come from this thread's image arena and are dropped at the end of the scope
+        ImageArenaScope arenaScope;
+        if (memory != NULL)
+            decoded = stbi_load_into_from_memory(memory, memoryLength, pixels, (size_t)size, stride, &width, &height, &nrChannels, channels) != 0;
+        else
+            decoded = stbi_load_into(path.c_str(), pixels, (size_t)size, stride, &width, &height, &nrChannels, channels) != 0;
+    }
+    // the buffer content is undefined if unmapping fails (e.g. display mode change), so don't upload it
+    bool unmapped = pixels != NULL && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+
+    if (decoded && unmapped)
+    {
+        GLenum format = PixelFormatFromChannels(channels);
+        // the last parameter is an offset into the bound pixel unpack buffer now
+        if (BoundTextureIsImmutable())
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, (void*)0);
+        else
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, (void*)0);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        const char* reason = pixels == NULL ? "could not map pixel buffer" : !decoded ? stbi_failure_reason() : "pixel buffer lost";
+        std::cout << "Failed to load texture " << path << ": " << reason << std::endl;
+    }
+
+    GLState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    GLState().deleteBuffers(1, &pbo);
+    return decoded && unmapped;
+}
+
+bool LoadTexture2D(const std::string& path, int desiredChannels)
+{
+    return UploadImage(path, NULL, 0, desiredChannels);
+}
+
+bool LoadTexture2D(const AssetView& file, int desiredChannels)
+{
+    if (!file.valid())
+    {
+        std::cout << "Failed to load texture: asset not found" << std::endl;
+        return false;
+    }
+    return UploadImage("(asset pack)", file.data, file.size, desiredChannels);
+}
+
+unsigned int LoadImmutableTexture2D(const std::string& path, int desiredChannels)
+{
+    TextureInfo info = TextureInfo();
+    if (!stbi_info(path.c_str(), &info.width, &info.height, &info.channels))
+    {
+        std::cout << "Failed to load texture " << path << ": " << stbi_failure_reason() << std::endl;
+        return 0;
+    }
+    // UploadImage decodes 8 bits per channel, the storage matches that
+    if (desiredChannels)
+        info.channels = desiredChannels;
+    info.levels = MipLevelCount(info.width, info.height);
+
+    unsigned int texture = CreateTextureStorage(&info);
+    if (!LoadTexture2D(path, desiredChannels))
+    {
+        // CreateTextureStorage bound it through the state cache
+        GLState().deleteTextures(1, &texture);
+        return 0;
+    }
+    return texture;
+}
+
+// maps a pixel unpack buffer of stride * height bytes, lets fill write the image into it and
+// uploads it to level 0 of the texture, then generates the mipmaps.
+// fill(pixels, size) returns false if decoding failed.
+template <typename Fill>
+static bool UploadThroughPixelBuffer(const std::string& path, GLuint texture, int width, int height, int stride, GLenum format, GLenum type, Fill fill)
+{
+    GLsizeiptr size = (GLsizeiptr)stride * height;
+    unsigned int pbo;
+    glGenBuffers(1, &pbo);
+    GLState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+    unsigned char* pixels = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    bool filled = pixels != NULL && fill(pixels, (size_t)size);
+    bool unmapped = pixels != NULL && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+
+    if (filled && unmapped)
+    {
+        UploadTexture2D(texture, 0, 0, 0, width, height, format, type, (void*)0);
+        GenerateMipmaps(texture);
+    }
+    else
+    {
+        const char* reason = pixels == NULL ? "could not map pixel buffer" : !filled ? stbi_failure_reason() : "pixel buffer lost";
+        std::cout << "Failed to load texture " << path << ": " << reason << std::endl;
+    }
+
+    GLState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    GLState().deleteBuffers(1, &pbo);
+    return filled && unmapped;
+}
+
+ImportedTexture ImportTexture2D(const std::string& path, TextureUsage usage, GLenum hdrFormat)
+{
+    ImportedTexture result = ImportedTexture();
+    TextureInfo info = TextureInfo();
+    if (!stbi_info(path.c_str(), &info.width, &info.height, &info.channels))
+    {
+        std::cout << "Failed to load texture " << path << ": " << stbi_failure_reason() << std::endl;
+        return result;
+    }
+    info.isHdr = stbi_is_hdr(path.c_str()) != 0;
+    // 16 bit color is decoded to 8 bits, there is no 16 bit sRGB format
+    info.is16Bit = !info.isHdr && usage == TEXTURE_USAGE_DATA && stbi_is_16_bit(path.c_str()) != 0;
+    info.levels = MipLevelCount(info.width, info.height);
+
+    int channels = info.channels;
+    int bytesPerChannel = 1;
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLenum internalFormat;
+    if (info.isHdr)
+    {
+        if (hdrFormat != GL_R11F_G11F_B10F && hdrFormat != GL_RGBA16F)
+        {
+            std::cout << "ERROR::TEXTURE::UNSUPPORTED_HDR_FORMAT 0x" << std::hex << hdrFormat << std::dec << ", using GL_RGBA16F" << std::endl;
+            hdrFormat = GL_RGBA16F;
+        }
+        internalFormat = hdrFormat;
+        channels = hdrFormat == GL_R11F_G11F_B10F ? 3 : 4;
+        bytesPerChannel = 2;
+        type = GL_HALF_FLOAT;
+    }
+    else if (usage == TEXTURE_USAGE_COLOR)
+    {
+        internalFormat = GL_SRGB8_ALPHA8;
+        channels = 4;
+    }
+    else
+    {
+        internalFormat = InternalFormatFromInfo(info);
+        if (info.is16Bit)
+        {
+            bytesPerChannel = 2;
+            type = GL_UNSIGNED_SHORT;
+        }
+    }
+
+    int width = info.width, height = info.height;
+    int rowBytes = width * channels * bytesPerChannel;
+    // rows 4 byte aligned, the default GL_UNPACK_ALIGNMENT
+    int stride = (rowBytes + 3) & ~3;
+    GLuint texture = CreateTexture2D(info.levels, internalFormat, width, height);
+    GLenum format = PixelFormatFromChannels(channels);
+
+    bool uploaded;
+    if (info.isHdr)
+    {
+        // the float image is 4 times the size of an 8 bit one and may not fit the image arena,
+        // so it comes from the heap. rows are converted to halves straight into the mapped buffer.
+        uploaded = UploadThroughPixelBuffer(path, texture, width, height, stride, format, type, [&](unsigned char* pixels, size_t) {
+            int fileChannels;
+            float* image = stbi_loadf(path.c_str(), &width, &height, &fileChannels, channels);
+            if (image == NULL)
+                return false;
+            for (int y = 0; y < height; y++)
+                FloatsToHalves(image + (size_t)y * width * channels, (uint16_t*)(pixels + (size_t)y * stride), (size_t)width * channels);
+            stbi_image_free(image);
+            return true;
+        });
+    }
+    else if (info.is16Bit)
+    {
+        uploaded = UploadThroughPixelBuffer(path, texture, width, height, stride, format, type, [&](unsigned char* pixels, size_t) {
+            ImageArenaScope arenaScope;
+            int fileChannels;
+            stbi_us* image = stbi_load_16(path.c_str(), &width, &height, &fileChannels, channels);
+            if (image == NULL)
+                return false;
+            for (int y = 0; y < height; y++)
+                memcpy(pixels + (size_t)y * stride, image + (size_t)y * width * channels, rowBytes);
+            stbi_image_free(image);
+            return true;
+        });
+    }
+    else
+    {
+        uploaded = UploadThroughPixelBuffer(path, texture, width, height, stride, format, type, [&](unsigned char* pixels, size_t size) {
+            ImageArenaScope arenaScope;
+            int fileChannels;
+            return stbi_load_into(path.c_str(), pixels, size, stride, &width, &height, &fileChannels, channels) != 0;
+        });
+    }
+
+    if (!uploaded)
+    {
+        GLState().deleteTextures(1, &texture);
+        return result;
+    }
+    result.texture = texture;
+    result.internalFormat = internalFormat;
+    result.width = width;
+    result.height = height;
+    return result;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+#include "TextureManifest.h"
+#include "AssetPack.h"
+
+// decodes an image file straight into a pixel buffer object and uploads it to the
+// texture currently bound to GL_TEXTURE_2D, then generates the mipmaps.
+// desiredChannels works like the last parameter of stbi_load (0 = keep the file's channels).
+// if the bound texture has immutable storage (see CreateTextureStorage) the pixels are
+// written into it, so desiredChannels has to match the storage format then.
+// returns false if the file could not be read or decoded.
+bool LoadTexture2D(const std::string& path, int desiredChannels = 0);
+
+// same as above, but decodes an encoded image that is already in memory (e.g. mapped from an asset pack)
+bool LoadTexture2D(const AssetView& file, int desiredChannels = 0);
+
+// creates a texture with storage for the whole mip chain described by the manifest entry, before
+// any pixels are decoded, and binds it to GL_TEXTURE_2D of unit 0 through the state cache.
+// immutable storage (glTexStorage2D) is used where the context has it.
+// with info == NULL this only creates and binds an empty texture.
+unsigned int CreateTextureStorage(const TextureInfo* info);
+
+// creates a texture with immutable storage for the full mip chain of the image (sized from the file
+// header), loads the image into it and generates the mipmaps. the texture stays bound to
+// GL_TEXTURE_2D of unit 0 and has no filter or wrap parameters of its own, those come from a sampler object
+// (see SamplerCache.h). returns 0 if the file could not be read or decoded.
+unsigned int LoadImmutableTexture2D(const std::string& path, int desiredChannels = 0);
+
+// what the pixels of an imported texture mean, which decides whether they are gamma encoded
+enum TextureUsage
+{
+    TEXTURE_USAGE_COLOR,    // albedo, decals, ui: sRGB encoded, the sampler returns linear values
+    TEXTURE_USAGE_DATA      // normal, roughness, height maps: linear, 16 bits are kept if the file has them
+};
+
+struct ImportedTexture
+{
+    unsigned int texture;   // 0 if the import failed
+    GLenum internalFormat;
+    int width;
+    int height;
+};
+
+// imports an image with the internal format chosen by its content:
+//   radiance .hdr files  hdrFormat: GL_R11F_G11F_B10F (4 bytes a texel, no sign, no alpha) or
+//                        GL_RGBA16F (8 bytes). the floats are converted to halves on the CPU
+//                        (FloatsToHalves), so only half of the decoded data is uploaded
+//   color                GL_SRGB8_ALPHA8, also for grey and rgb files
+//   data                 GL_R8 .. GL_RGBA8 like the file, GL_R16 .. GL_RGBA16 for 16 bit files
+// like LoadImmutableTexture2D the storage holds the full mip chain (immutable where the context
+// has it), the mipmaps are generated and filtering comes from a sampler object. everything goes
+// through GLResources, so with direct state access the texture is never bound.
+ImportedTexture ImportTexture2D(const std::string& path, TextureUsage usage, GLenum hdrFormat = GL_R11F_G11F_B10F);
@@ -0,0 +1,255 @@
+#include "TextureManifest.h"
+#include "MappedFile.h"
+#include "Utility.h"
+#include "stb_image.h"
+#include <sys/stat.h>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+static const char MANIFEST_MAGIC[4] = { 'T', 'X', 'M', 'F' };
+static const uint32_t MANIFEST_VERSION = 2;
+
+struct ManifestHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t stringBytes;   // size of the string table following the records
+};
+
+struct ManifestRecord
+{
+    uint32_t nameOffset;    // into the string table, names are zero terminated
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+    uint8_t flags;
+    uint8_t levels;
+    uint8_t reserved;
+    uint64_t fileSize;
+    uint64_t fileTime;
+};
+
+static_assert(sizeof(ManifestRecord) == 32, "manifest records are expected to be 32 bytes");
+
+enum ManifestFlags
+{
+    MANIFEST_FLAG_16_BIT = 1,
+    MANIFEST_FLAG_HDR = 2
+};
+
+int MipLevelCount(int width, int height)
+{
+    int size = width > height ? width : height;
+    int levels = 1;
+    while (size > 1)
+    {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+// size and modification time of a file, both 0 if it doesn't exist
+static void FileStamp(const std::string& path, uint64_t& size, uint64_t& time)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        size = 0;
+        time = 0;
+        return;
+    }
+    size = (uint64_t)info.st_size;
+    time = (uint64_t)info.st_mtime;
+}
+
+// stb_image only looks at the first bytes for these, so only the header pages of the mapping get read
+static bool ProbeTexture(const std::string& path, TextureInfo& info)
+{
+    FileStamp(path, info.fileSize, info.fileTime);
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    int length = file.size() > (size_t)INT_MAX ? INT_MAX : (int)file.size();
+    if (!stbi_info_from_memory(file.data(), length, &info.width, &info.height, &info.channels))
+        return false;
+
+    info.is16Bit = stbi_is_16_bit_from_memory(file.data(), length) != 0;
+    info.isHdr = stbi_is_hdr_from_memory(file.data(), length) != 0;
+    info.levels = MipLevelCount(info.width, info.height);
+    return true;
+}
+
+static std::string JoinPath(const std::string& directory, const std::string& name)
+{
+    if (directory.empty() || directory.back() == '\\' || directory.back() == '/')
+        return directory + name;
+    return directory + '\\' + name;
+}
+
+std::vector<TextureInfo> ScanTextureFiles(const std::string& directory, const std::vector<std::string>& names, unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+    if (threadCount > names.size())
+        threadCount = (unsigned int)names.size();
+
+    std::vector<TextureInfo> probed(names.size());
+    std::vector<char> valid(names.size(), 0);
+
+    // the work items are tiny, so the threads just grab the next file index until all are done
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < names.size(); i = next++)
+        {
+            probed[i].name = names[i];
+            valid[i] = ProbeTexture(JoinPath(directory, names[i]), probed[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::vector<TextureInfo> textures;
+    textures.reserve(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+        if (valid[i])
+            textures.push_back(probed[i]);
+    return textures;
+}
+
+std::vector<TextureInfo> ScanTextureDirectory(const std::string& directory, unsigned int threadCount)
+{
+    return ScanTextureFiles(directory, ListDirectoryFiles(directory), threadCount);
+}
+
+bool WriteTextureManifest(const std::string& path, const std::vector<TextureInfo>& textures)
+{
+    std::vector<ManifestRecord> records;
+    std::string strings;
+    records.reserve(textures.size());
+    for (const TextureInfo& texture : textures)
+    {
+        ManifestRecord record = {};
+        record.nameOffset = (uint32_t)strings.size();
+        record.width = (uint32_t)texture.width;
+        record.height = (uint32_t)texture.height;
+        record.channels = (uint8_t)texture.channels;
+        record.flags = (texture.is16Bit ? MANIFEST_FLAG_16_BIT : 0) | (texture.isHdr ? MANIFEST_FLAG_HDR : 0);
+        record.levels = (uint8_t)texture.levels;
+        record.fileSize = texture.fileSize;
+        record.fileTime = texture.fileTime;
+        records.push_back(record);
+        strings.append(texture.name.c_str(), texture.name.size() + 1);
+    }
+
+    ManifestHeader header;
+    std::memcpy(header.magic, MANIFEST_MAGIC, sizeof(header.magic));
+    header.version = MANIFEST_VERSION;
+    header.count = (uint32_t)records.size();
+    header.stringBytes = (uint32_t)strings.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)records.data(), records.size() * sizeof(ManifestRecord));
+    file.write(strings.data(), strings.size());
+    return file.good();
+}
+
+bool ReadTextureManifest(const std::string& path, std::vector<TextureInfo>& textures)
+{
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(ManifestHeader))
+        return false;
+
+    ManifestHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MANIFEST_MAGIC, sizeof(header.magic)) != 0 || header.version != MANIFEST_VERSION)
+        return false;
+
+    size_t recordBytes = (size_t)header.count * sizeof(ManifestRecord);
+    if (file.size() < sizeof(ManifestHeader) + recordBytes + header.stringBytes)
+        return false;
+
+    const unsigned char* recordData = file.data() + sizeof(ManifestHeader);
+    const char* strings = (const char*)(recordData + recordBytes);
+
+    textures.clear();
+    textures.reserve(header.count);
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        ManifestRecord record;
+        std::memcpy(&record, recordData + i * sizeof(ManifestRecord), sizeof(record));
+        if (record.nameOffset >= header.stringBytes)
+            return false;
+
+        TextureInfo info;
+        info.name.assign(strings + record.nameOffset, strnlen(strings + record.nameOffset, header.stringBytes - record.nameOffset));
+        info.width = (int)record.width;
+        info.height = (int)record.height;
+        info.channels = record.channels;
+        info.is16Bit = (record.flags & MANIFEST_FLAG_16_BIT) != 0;
+        info.isHdr = (record.flags & MANIFEST_FLAG_HDR) != 0;
+        info.levels = record.levels;
+        info.fileSize = record.fileSize;
+        info.fileTime = record.fileTime;
+        textures.push_back(info);
+    }
+    return true;
+}
+
+std::vector<TextureInfo> LoadOrBuildTextureManifest(const std::string& manifestPath, const std::string& directory)
+{
+    // an older version or a broken file leaves nothing cached, so everything is probed
+    std::vector<TextureInfo> cached;
+    if (!ReadTextureManifest(manifestPath, cached))
+        cached.clear();
+    std::unordered_map<std::string, const TextureInfo*> byName;
+    for (const TextureInfo& info : cached)
+        byName[info.name] = &info;
+
+    // entries whose file still has the size and time it was probed with are kept
+    std::vector<TextureInfo> textures;
+    std::vector<std::string> changed;
+    for (const std::string& name : ListDirectoryFiles(directory))
+    {
+        auto found = byName.find(name);
+        uint64_t size, time;
+        FileStamp(JoinPath(directory, name), size, time);
+        if (found != byName.end() && found->second->fileSize == size && found->second->fileTime == time)
+            textures.push_back(*found->second);
+        else
+            changed.push_back(name);
+    }
+
+    // files that aren't textures (the manifest itself) are probed every time but change nothing
+    std::vector<TextureInfo> probed = ScanTextureFiles(directory, changed);
+    bool stale = !probed.empty() || textures.size() != cached.size();
+    textures.insert(textures.end(), probed.begin(), probed.end());
+    if (stale)
+        WriteTextureManifest(manifestPath, textures);
+    return textures;
+}
+
+const TextureInfo* FindTextureInfo(const std::vector<TextureInfo>& textures, const std::string& name)
+{
+    for (const TextureInfo& texture : textures)
+        if (texture.name == name)
+            return &texture;
+    return NULL;
+}
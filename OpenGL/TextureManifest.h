@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// metadata of one texture file, everything the renderer needs to allocate storage
+// before a single pixel is decoded
+struct TextureInfo
+{
+    std::string name;   // file name relative to the scanned directory
+    int width;
+    int height;
+    int channels;       // channels in the file (1 grey, 2 grey/alpha, 3 rgb, 4 rgba)
+    bool is16Bit;       // 16 bits per channel (png/psd)
+    bool isHdr;         // radiance .hdr, float data
+    int levels;         // length of the full mip chain down to 1x1
+    uint64_t fileSize;  // size and modification time of the file when it was probed,
+    uint64_t fileTime;  // the manifest entry is rebuilt once either changes
+};
+
+// reads only the headers of the given files (relative to directory) through memory mappings,
+// spread over threadCount threads (0 = one per hardware thread).
+// files stb_image can't identify are skipped.
+std::vector<TextureInfo> ScanTextureFiles(const std::string& directory, const std::vector<std::string>& names, unsigned int threadCount = 0);
+
+// ScanTextureFiles over all files in a directory (not recursive)
+std::vector<TextureInfo> ScanTextureDirectory(const std::string& directory, unsigned int threadCount = 0);
+
+// the manifest is a small binary file: a header, one 32 byte record per texture and a string table
+bool WriteTextureManifest(const std::string& path, const std::vector<TextureInfo>& textures);
+bool ReadTextureManifest(const std::string& path, std::vector<TextureInfo>& textures);
+
+// reads the manifest and probes again only the files that are new or changed since it was written,
+// the manifest is written back if anything differs (or there was none yet)
+std::vector<TextureInfo> LoadOrBuildTextureManifest(const std::string& manifestPath, const std::string& directory);
+
+// NULL if there is no texture with that name
+const TextureInfo* FindTextureInfo(const std::vector<TextureInfo>& textures, const std::string& name);
+
+// number of mip levels of a full chain down to 1x1
+int MipLevelCount(int width, int height);
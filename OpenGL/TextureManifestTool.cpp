@@ -0,0 +1,38 @@
+#include <chrono>
+#include <iostream>
+#include "TextureManifest.h"
+#include "Utility.h"
+
+// offline tool: scans the headers of every texture in a directory and writes the manifest
+// the samples use to allocate texture storage up front.
+// usage: TextureManifestTool [directory] [manifest] [threads]
+// defaults: <working dir>\Textures, <directory>\textures.manifest, one thread per core
+
+int main(int argc, char** argv)
+{
+    std::string directory = argc > 1 ? argv[1] : GetWorkingDir() + "Textures";
+    std::string manifestPath = argc > 2 ? argv[2] : directory + "\\textures.manifest";
+    unsigned int threads = argc > 3 ? (unsigned int)std::stoul(argv[3]) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> files = ListDirectoryFiles(directory);
+    std::vector<TextureInfo> textures = ScanTextureFiles(directory, files, threads);
+    auto end = std::chrono::steady_clock::now();
+
+    for (const TextureInfo& texture : textures)
+    {
+        std::cout << texture.name << ": " << texture.width << " x " << texture.height
+            << ", " << texture.channels << " channels, " << texture.levels << " levels"
+            << (texture.is16Bit ? ", 16 bit" : "") << (texture.isHdr ? ", hdr" : "") << std::endl;
+    }
+    std::cout << textures.size() << " of " << files.size() << " files probed in "
+        << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+    if (!WriteTextureManifest(manifestPath, textures))
+    {
+        std::cout << "Failed to write manifest " << manifestPath << std::endl;
+        return -1;
+    }
+    std::cout << "written " << manifestPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "TextureQuality.h"
+#include "GLExtensions.h"
+
+// samples along the footprint of the anisotropic presets, 1 for the others
+static float AnisotropyOf(TextureFilter filter)
+{
+    switch (filter)
+    {
+    case TEXTURE_FILTER_ANISOTROPIC_2X: return 2.0f;
+    case TEXTURE_FILTER_ANISOTROPIC_4X: return 4.0f;
+    case TEXTURE_FILTER_ANISOTROPIC_8X: return 8.0f;
+    case TEXTURE_FILTER_ANISOTROPIC_16X: return 16.0f;
+    default: return 1.0f;
+    }
+}
+
+const char* TextureFilterName(TextureFilter filter)
+{
+    switch (filter)
+    {
+    case TEXTURE_FILTER_LINEAR: return "linear";
+    case TEXTURE_FILTER_BILINEAR: return "bilinear";
+    case TEXTURE_FILTER_TRILINEAR: return "trilinear";
+    case TEXTURE_FILTER_ANISOTROPIC_2X: return "anisotropic 2x";
+    case TEXTURE_FILTER_ANISOTROPIC_4X: return "anisotropic 4x";
+    case TEXTURE_FILTER_ANISOTROPIC_8X: return "anisotropic 8x";
+    case TEXTURE_FILTER_ANISOTROPIC_16X: return "anisotropic 16x";
+    default: return "unknown";
+    }
+}
+
+TextureFilter SupportedTextureFilter(TextureFilter filter)
+{
+    // the anisotropic presets go down one step at a time until one fits, ending at trilinear
+    while (filter > TEXTURE_FILTER_TRILINEAR && AnisotropyOf(filter) > MaxTextureAnisotropy())
+        filter = (TextureFilter)(filter - 1);
+    return filter;
+}
+
+SamplerState TextureQuality::samplerState() const
+{
+    SamplerState state;
+    state.wrapS = wrap;
+    state.wrapT = wrap;
+    state.magFilter = GL_LINEAR;
+    TextureFilter supported = SupportedTextureFilter(filter);
+    switch (supported)
+    {
+    case TEXTURE_FILTER_LINEAR: state.minFilter = GL_LINEAR; break;
+    case TEXTURE_FILTER_BILINEAR: state.minFilter = GL_LINEAR_MIPMAP_NEAREST; break;
+    default: state.minFilter = GL_LINEAR_MIPMAP_LINEAR; break;
+    }
+    state.maxAnisotropy = AnisotropyOf(supported);
+    // without mipmaps there is no level to move
+    state.lodBias = supported == TEXTURE_FILTER_LINEAR ? 0.0f : lodBias;
+    return state;
+}
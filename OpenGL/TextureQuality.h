@@ -0,0 +1,35 @@
+#pragma once
+#include <glad/glad.h>
+
+#include "SamplerCache.h"
+
+// filter presets, from the cheapest to the most texture reads per lookup
+enum TextureFilter
+{
+    TEXTURE_FILTER_LINEAR,              // GL_LINEAR on the first level, aliases under minification
+    TEXTURE_FILTER_BILINEAR,            // GL_LINEAR within the nearest mip level
+    TEXTURE_FILTER_TRILINEAR,           // GL_LINEAR between the two nearest mip levels
+    TEXTURE_FILTER_ANISOTROPIC_2X,      // trilinear, up to n of them along the long axis of the footprint
+    TEXTURE_FILTER_ANISOTROPIC_4X,
+    TEXTURE_FILTER_ANISOTROPIC_8X,
+    TEXTURE_FILTER_ANISOTROPIC_16X,
+    TEXTURE_FILTER_COUNT
+};
+
+// "trilinear", "anisotropic 8x", ...
+const char* TextureFilterName(TextureFilter filter);
+
+// the preset itself, or the best one below it the context can do (MaxTextureAnisotropy)
+TextureFilter SupportedTextureFilter(TextureFilter filter);
+
+// how the textures of one material are sampled. the lod bias moves the mip level every lookup
+// picks: negative is sharper and aliases sooner, positive is blurrier and reads less memory.
+// materials with the same quality end up with the same sampler object.
+struct TextureQuality
+{
+    TextureFilter filter = TEXTURE_FILTER_TRILINEAR;
+    float lodBias = 0.0f;
+    GLenum wrap = GL_REPEAT;
+
+    SamplerState samplerState() const;
+};
@@ -0,0 +1,371 @@
+#include "TextureStreamer.h"
+#include "TextureLoad.h"
+#include "GLStateCache.h"
+#include "ImageArena.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+
+static int LevelSize(int size, int level)
+{
+    size >>= level;
+    return size > 0 ? size : 1;
+}
+
+// 2x2 box filter, the last row/column is repeated for odd sizes
+static std::vector<unsigned char> DownsampleRGBA(const std::vector<unsigned char>& source, int width, int height)
+{
+    int targetWidth = LevelSize(width, 1);
+    int targetHeight = LevelSize(height, 1);
+    std::vector<unsigned char> target((size_t)targetWidth * targetHeight * 4);
+    for (int y = 0; y < targetHeight; y++)
+    {
+        int y0 = std::min(2 * y, height - 1);
+        int y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < targetWidth; x++)
+        {
+            int x0 = std::min(2 * x, width - 1);
+            int x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; c++)
+            {
+                int sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c]
+                        + source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                target[((size_t)y * targetWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return target;
+}
+
+TextureStreamer::TextureStreamer(size_t residencyBudget)
+    : budget_(residencyBudget)
+{
+    glGenFramebuffers(1, &readFramebuffer_);
+    glGenFramebuffers(1, &drawFramebuffer_);
+    decoder_ = std::thread(&TextureStreamer::decodeLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeDecoder_.notify_all();
+    decoder_.join();
+
+    for (const std::unique_ptr<StreamedTexture>& texture : textures_)
+        GLState().deleteTextures(1, &texture->texture);
+    glDeleteFramebuffers(1, &readFramebuffer_);
+    glDeleteFramebuffers(1, &drawFramebuffer_);
+}
+
+int TextureStreamer::add(const std::string& path, const TextureInfo& info)
+{
+    std::unique_ptr<StreamedTexture> texture(new StreamedTexture());
+    texture->path = path;
+    texture->width = info.width;
+    texture->height = info.height;
+    texture->levels = info.levels;
+
+    texture->tailTop = 0;
+    while (std::max(LevelSize(info.width, texture->tailTop), LevelSize(info.height, texture->tailTop)) > STREAM_TAIL_SIZE)
+        texture->tailTop++;
+    texture->pixels.resize(info.levels);
+
+    // storage for the tail up front, with a grey placeholder in the 1x1 level until the image is decoded
+    texture->residentTop = texture->levels - 1;
+    reallocate(*texture, texture->tailTop);
+    static const std::vector<unsigned char> placeholder = { 128, 128, 128, 255 };
+    uploadLevel(*texture, texture->levels - 1, placeholder);
+
+    textures_.push_back(std::move(texture));
+    return (int)textures_.size() - 1;
+}
+
+void TextureStreamer::touch(int handle, float screenSize)
+{
+    StreamedTexture& texture = *textures_[handle];
+    if (texture.lastUsedFrame != frame_)
+    {
+        texture.lastUsedFrame = frame_;
+        texture.screenSize = 0.0f;
+    }
+    texture.screenSize = std::max(texture.screenSize, screenSize);
+}
+
+unsigned int TextureStreamer::texture(int handle) const
+{
+    return textures_[handle]->texture;
+}
+
+int TextureStreamer::residentLevel(int handle) const
+{
+    return textures_[handle]->residentTop;
+}
+
+// the finest level that still has more texels than pixels it covers on screen
+int TextureStreamer::desiredLevel(const StreamedTexture& texture) const
+{
+    if (texture.priority <= 1.0f)
+        return texture.levels - 1;
+    float largest = (float)std::max(texture.width, texture.height);
+    int level = (int)std::floor(std::log2(largest / texture.priority));
+    return std::min(std::max(level, 0), texture.levels - 1);
+}
+
+size_t TextureStreamer::levelBytes(const StreamedTexture& texture, int level) const
+{
+    return (size_t)LevelSize(texture.width, level) * LevelSize(texture.height, level) * 4;
+}
+
+size_t TextureStreamer::storageBytes(const StreamedTexture& texture, int top) const
+{
+    size_t bytes = 0;
+    for (int level = top; level < texture.levels; level++)
+        bytes += levelBytes(texture, level);
+    return bytes;
+}
+
+void TextureStreamer::update(size_t uploadBudget)
+{
+    frame_++;
+
+    // textures not touched in the last frame keep their old priority, so they stay in the queue but behind visible ones
+    std::vector<StreamedTexture*> order;
+    for (const std::unique_ptr<StreamedTexture>& texture : textures_)
+    {
+        texture->priority = texture->lastUsedFrame + 1 >= frame_ ? texture->screenSize : 0.0f;
+        order.push_back(texture.get());
+    }
+    std::stable_sort(order.begin(), order.end(), [](const StreamedTexture* a, const StreamedTexture* b) { return a->priority > b->priority; });
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool queuedDecode = false;
+    bool uploaded = false;
+    for (StreamedTexture* texture : order)
+    {
+        int desired = std::min(desiredLevel(*texture), texture->tailTop);
+        texture->wantedLevel = desired;
+
+        // the whole tail goes up at once, it is tiny
+        if (texture->residentTop > texture->tailTop && !texture->pixels[texture->tailTop].empty())
+        {
+            for (int level = texture->tailTop; level < texture->levels; level++)
+                uploadLevel(*texture, level, texture->pixels[level]);
+            texture->residentTop = texture->tailTop;
+            applyBaseLevel(*texture);
+        }
+
+        while (texture->residentTop > desired && texture->residentTop <= texture->tailTop)
+        {
+            int next = texture->residentTop - 1;
+            if (texture->pixels[next].empty())
+                break;
+            // a level larger than the whole per frame budget still goes up, but alone
+            size_t bytes = levelBytes(*texture, next);
+            if ((bytes > uploadBudget && uploaded) || !makeRoom(bytes, texture))
+                break;
+
+            reallocate(*texture, next);
+            uploadLevel(*texture, next, texture->pixels[next]);
+            texture->residentTop = next;
+            applyBaseLevel(*texture);
+            uploadBudget -= std::min(bytes, uploadBudget);
+            uploaded = true;
+        }
+
+        if (texture->residentTop <= desired)
+        {
+            // nothing left to refine, the decoded copies are no longer needed
+            for (std::vector<unsigned char>& level : texture->pixels)
+                std::vector<unsigned char>().swap(level);
+        }
+        else if (texture->pixels[texture->residentTop - 1].empty() && !texture->decodeQueued && !texture->decodeFailed)
+        {
+            texture->decodeQueued = true;
+            decodeQueue_.push_back(texture);
+            queuedDecode = true;
+        }
+    }
+
+    // the decode thread takes the highest priority request first
+    std::stable_sort(decodeQueue_.begin(), decodeQueue_.end(), [](const StreamedTexture* a, const StreamedTexture* b) { return a->priority > b->priority; });
+    lock.unlock();
+    if (queuedDecode)
+        wakeDecoder_.notify_one();
+
+    // the budget may have been lowered, then even visible textures lose their largest levels
+    makeRoom(0, nullptr);
+}
+
+// evicts levels of other textures until 'bytes' more fit into the budget.
+// textures that are used this frame with at least the requester's priority are never evicted for it.
+bool TextureStreamer::makeRoom(size_t bytes, const StreamedTexture* requester)
+{
+    if (residentBytes_ + bytes <= budget_)
+        return true;
+
+    // don't evict anything if it would not be enough in the end
+    size_t evictable = 0;
+    for (const std::unique_ptr<StreamedTexture>& candidate : textures_)
+        if (canEvictFor(*candidate, requester))
+            evictable += storageBytes(*candidate, candidate->storageTop) - storageBytes(*candidate, candidate->tailTop);
+    if (requester != nullptr && residentBytes_ + bytes > budget_ + evictable)
+        return false;
+
+    while (residentBytes_ + bytes > budget_)
+    {
+        StreamedTexture* victim = nullptr;
+        for (const std::unique_ptr<StreamedTexture>& candidate : textures_)
+        {
+            StreamedTexture* texture = candidate.get();
+            if (!canEvictFor(*texture, requester))
+                continue;
+            // least recently used first, and of those the one with the largest level
+            if (victim == nullptr || texture->lastUsedFrame < victim->lastUsedFrame
+                || (texture->lastUsedFrame == victim->lastUsedFrame && levelBytes(*texture, texture->storageTop) > levelBytes(*victim, victim->storageTop)))
+                victim = texture;
+        }
+        if (victim == nullptr || !evictLargestLevel(*victim))
+            return false;
+    }
+    return true;
+}
+
+bool TextureStreamer::canEvictFor(const StreamedTexture& texture, const StreamedTexture* requester) const
+{
+    if (&texture == requester || texture.storageTop >= texture.tailTop)
+        return false;
+    bool usedNow = texture.lastUsedFrame + 1 >= frame_;
+    return requester == nullptr || !usedNow || texture.priority < requester->priority;
+}
+
+bool TextureStreamer::evictLargestLevel(StreamedTexture& texture)
+{
+    if (texture.storageTop >= texture.tailTop)
+        return false;
+    reallocate(texture, texture.storageTop + 1);
+    texture.residentTop = std::max(texture.residentTop, texture.storageTop);
+    applyBaseLevel(texture);
+    return true;
+}
+
+// re-creates the storage of a texture for the levels [newTop, levels) and copies
+// the resident levels both storages have in common on the GPU
+void TextureStreamer::reallocate(StreamedTexture& texture, int newTop)
+{
+    TextureInfo info;
+    info.width = LevelSize(texture.width, newTop);
+    info.height = LevelSize(texture.height, newTop);
+    info.channels = 4;
+    info.is16Bit = false;
+    info.isHdr = false;
+    info.levels = texture.levels - newTop;
+
+    unsigned int oldTexture = texture.texture;
+    unsigned int newTexture = CreateTextureStorage(&info);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (oldTexture != 0)
+    {
+        // the caller's framebuffers are bound again afterwards
+        GLint previousRead, previousDraw;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer_);
+        for (int level = std::max(newTop, texture.residentTop); level < texture.levels; level++)
+        {
+            int width = LevelSize(texture.width, level);
+            int height = LevelSize(texture.height, level);
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, oldTexture, level - texture.storageTop);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, newTexture, level - newTop);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        // a deleted texture stays alive as long as an unbound framebuffer still references it
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousRead);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)previousDraw);
+        GLState().deleteTextures(1, &oldTexture);
+        residentBytes_ -= storageBytes(texture, texture.storageTop);
+    }
+
+    residentBytes_ += storageBytes(texture, newTop);
+    texture.texture = newTexture;
+    texture.storageTop = newTop;
+    applyBaseLevel(texture);
+}
+
+// sampling must not reach levels that have no pixels yet
+void TextureStreamer::applyBaseLevel(StreamedTexture& texture)
+{
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, std::max(texture.residentTop, texture.storageTop) - texture.storageTop);
+}
+
+void TextureStreamer::uploadLevel(StreamedTexture& texture, int level, const std::vector<unsigned char>& pixels)
+{
+    GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, level - texture.storageTop, 0, 0, LevelSize(texture.width, level), LevelSize(texture.height, level),
+        GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+void TextureStreamer::decodeLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wakeDecoder_.wait(lock, [this]() { return stopping_ || !decodeQueue_.empty(); });
+        if (stopping_)
+            return;
+
+        StreamedTexture* texture = decodeQueue_.front();
+        decodeQueue_.erase(decodeQueue_.begin());
+        int keepFrom = texture->wantedLevel;
+
+        lock.unlock();
+        decode(*texture, keepFrom);
+        lock.lock();
+    }
+}
+
+// decodes the image and builds its mip chain; only the levels from keepFrom on are kept.
+// runs on the decode thread, the pixels are handed over under the lock.
+void TextureStreamer::decode(StreamedTexture& texture, int keepFrom)
+{
+    std::vector<unsigned char> image((size_t)texture.width * texture.height * 4);
+    int width, height, channels;
+    bool decoded;
+    {
+        ImageArenaScope arenaScope;
+        decoded = stbi_load_into(texture.path.c_str(), image.data(), image.size(), 0, &width, &height, &channels, 4) != 0
+            && width == texture.width && height == texture.height;
+    }
+
+    std::vector<std::vector<unsigned char>> levels(texture.levels);
+    if (decoded)
+    {
+        for (int level = 0; level < texture.levels; level++)
+        {
+            std::vector<unsigned char> next;
+            if (level + 1 < texture.levels)
+                next = DownsampleRGBA(image, LevelSize(texture.width, level), LevelSize(texture.height, level));
+            if (level >= keepFrom)
+                levels[level] = std::move(image);
+            image = std::move(next);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    texture.decodeQueued = false;
+    texture.decodeFailed = !decoded;
+    for (int level = keepFrom; level < texture.levels; level++)
+        if (texture.pixels[level].empty())
+            texture.pixels[level] = std::move(levels[level]);
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureManifest.h"
+
+// progressive texture streaming.
+//
+// every texture starts with storage for its mip tail only (the levels of at most
+// STREAM_TAIL_SIZE texels) and a grey 1x1 placeholder, so rendering can start at once.
+// a background thread decodes the images, the render thread then uploads the tail and
+// refines towards the level the on-screen size asks for, one level at a time and the
+// highest priority textures first.
+//
+// the GPU storage always covers exactly the resident levels: refining or evicting a level
+// re-creates the (immutable where available) storage and copies the remaining levels over
+// on the GPU with glBlitFramebuffer, so the residency budget is real memory and not just a
+// sampling clamp. when the budget is exceeded the largest level of the least recently
+// used texture is evicted first.
+//
+// all textures are streamed as RGBA8 so every level is color renderable and 4 byte aligned.
+
+const int STREAM_TAIL_SIZE = 64;
+
+class TextureStreamer
+{
+public:
+    // residencyBudget is the number of bytes all textures together may use on the GPU
+    explicit TextureStreamer(size_t residencyBudget);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // registers a texture from its manifest entry and allocates its tail, returns the handle
+    int add(const std::string& path, const TextureInfo& info);
+
+    // tells the streamer a texture is used this frame and how large it is on screen (in pixels,
+    // the larger side). the largest size of all calls in one frame wins.
+    void touch(int handle, float screenSize);
+
+    // call once per frame on the GL thread before drawing: uploads decoded levels in priority order
+    // (at most uploadBudget bytes) and evicts levels to stay within the residency budget.
+    // this changes the GL_TEXTURE_2D binding of the active texture unit.
+    void update(size_t uploadBudget);
+
+    // GL texture to bind for a handle, it changes whenever the resident levels change
+    unsigned int texture(int handle) const;
+
+    int residentLevel(int handle) const;
+    size_t residentBytes() const { return residentBytes_; }
+    size_t budget() const { return budget_; }
+    void setBudget(size_t budget) { budget_ = budget; }
+
+private:
+    struct StreamedTexture
+    {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        int levels = 0;
+        int tailTop = 0;            // finest level of the mip tail
+        int storageTop = 0;         // finest level allocated in 'texture'
+        int residentTop = 0;        // finest level holding pixels
+        unsigned int texture = 0;
+        float screenSize = 0.0f;
+        float priority = 0.0f;      // screen size of the last frame the texture was touched in
+        unsigned long long lastUsedFrame = 0;
+
+        // shared with the decode thread, guarded by mutex_
+        int wantedLevel = 0;        // finest level the decode thread should keep
+        bool decodeQueued = false;
+        bool decodeFailed = false;
+        std::vector<std::vector<unsigned char>> pixels; // decoded levels, empty where not available
+    };
+
+    int desiredLevel(const StreamedTexture& texture) const;
+    size_t levelBytes(const StreamedTexture& texture, int level) const;
+    size_t storageBytes(const StreamedTexture& texture, int top) const;
+
+    void reallocate(StreamedTexture& texture, int newTop);
+    void applyBaseLevel(StreamedTexture& texture);
+    void uploadLevel(StreamedTexture& texture, int level, const std::vector<unsigned char>& pixels);
+    bool makeRoom(size_t bytes, const StreamedTexture* requester);
+    bool canEvictFor(const StreamedTexture& texture, const StreamedTexture* requester) const;
+    bool evictLargestLevel(StreamedTexture& texture);
+
+    void decodeLoop();
+    void decode(StreamedTexture& texture, int keepFrom);
+
+    std::vector<std::unique_ptr<StreamedTexture>> textures_;
+    size_t budget_;
+    size_t residentBytes_ = 0;
+    unsigned long long frame_ = 0;
+    unsigned int readFramebuffer_ = 0;
+    unsigned int drawFramebuffer_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable wakeDecoder_;
+    std::vector<StreamedTexture*> decodeQueue_;
+    bool stopping_ = false;
+    std::thread decoder_;
+};
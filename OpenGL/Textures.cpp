@@ -5,6 +5,7 @@
 #include "shaderLoad.h"
 #include "stb_image.h"
 #include "Utility.h"
+#include "GLStateCache.h"
 
 //tutorial here https://learnopengl.com/Getting-started/Textures
 
@@ -233,10 +234,8 @@ int main()
 
         //bind multiple textures 
         //we can bind to multiple textures at once as long as we activate the corresponding texture unit first
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture);
+        GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, texture2);
 
         /*
             OpenGL should have a at least a minimum of 16 
@@ -247,7 +246,7 @@ int main()
 
         // render container
         ourShader.use();
-        glBindVertexArray(VAO);
+        GLState().bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -10,6 +10,7 @@
 #include "shaderLoad.h"
 #include "stb_image.h"
 #include "Utility.h"
+#include "GLStateCache.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -185,10 +186,8 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT);
 
         // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        GLState().bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, texture1);
+        GLState().bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, texture2);
 
         // create transformations
         glm::mat4 transform = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
@@ -205,7 +204,7 @@ int main()
         glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(transform));
 
         // render container
-        glBindVertexArray(VAO);
+        GLState().bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -1,6 +1,7 @@
 #include <iostream>
 #include<glad/glad.h>
 #include<GLFW/glfw3.h>
+#include "GLStateCache.h"
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -217,14 +218,14 @@ int main()
         float timeValue = glfwGetTime();
         float greenValue = (sin(timeValue) / 2.0f) + 0.5f;
         int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-        glUseProgram(shaderProgram);
+        // the program stays current from the second frame on, the cache drops the call
+        GLState().useProgram(shaderProgram);
 
         //Uniforms are another way to pass data from our application on the CPU to the shaders on the GPU
         glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
 
 
-        glUseProgram(shaderProgram);
-        glBindVertexArray(VAO);
+        GLState().bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         //wireframe mode
@@ -6,3 +6,24 @@ std::string GetWorkingDir()
 	GetCurrentDirectoryA(256, buf);
 	return std::string(buf) + '\\';
 }
+
+std::vector<std::string> ListDirectoryFiles(const std::string& directory)
+{
+	std::vector<std::string> files;
+	std::string pattern = directory;
+	if (!pattern.empty() && pattern.back() != '\\' && pattern.back() != '/')
+		pattern += '\\';
+	pattern += '*';
+
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA(pattern.c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+		return files;
+	do
+	{
+		if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			files.push_back(findData.cFileName);
+	} while (FindNextFileA(find, &findData));
+	FindClose(find);
+	return files;
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include <Windows.h>
 #include <iostream>
+#include <string>
+#include <vector>
 
 std::string GetWorkingDir();
 
-
+// names of all regular files in a directory (not recursive)
+std::vector<std::string> ListDirectoryFiles(const std::string& directory);
@@ -1,6 +1,11 @@
 /*
 By defining STB_IMAGE_IMPLEMENTATION the preprocessor modifies the header file such that it only contains the relevant definition source code, effectively turning the header file into a .cpp file
 */
+// every allocation of stb_image goes through the per thread image arena, see ImageArena.h
+#include "ImageArena.h"
+#define STBI_MALLOC(sz)                     ImageArenaMalloc(sz)
+#define STBI_REALLOC_SIZED(p, oldsz, newsz) ImageArenaRealloc(p, oldsz, newsz)
+#define STBI_FREE(p)                        ImageArenaFree(p)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-
@@ -376,6 +376,21 @@ extern "C" {
     // for stbi_load_from_file, file pointer is left pointing immediately after image
 #endif
 
+    // decode into a caller-provided buffer (e.g. a mapped pixel buffer object) instead of
+    // returning a freshly malloc'ed image. rows are written 'out_stride' bytes apart
+    // (0 means tightly packed) with 'desired_channels' 8-bit channels per pixel (0 means
+    // the channel count of the file). stbi_set_flip_vertically_on_load is honoured while
+    // the rows are written, so no separate flip pass is needed.
+    // returns 1 on success, 0 on failure or if the image does not fit into 'out_size' bytes;
+    // x, y and channels_in_file are filled in either way once the header could be read.
+    STBIDEF int      stbi_load_into_from_memory(stbi_uc const* buffer, int len, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* channels_in_file, int desired_channels);
+    STBIDEF int      stbi_load_into_from_callbacks(stbi_io_callbacks const* clbk, void* user, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* channels_in_file, int desired_channels);
+
+#ifndef STBI_NO_STDIO
+    STBIDEF int      stbi_load_into(char const* filename, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* channels_in_file, int desired_channels);
+    STBIDEF int      stbi_load_into_from_file(FILE* f, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* channels_in_file, int desired_channels);
+#endif
+
 #ifndef STBI_NO_GIF
     STBIDEF stbi_uc* stbi_load_gif_from_memory(stbi_uc const* buffer, int len, int** delays, int* x, int* y, int* z, int* comp, int req_comp);
 #endif
@@ -1228,6 +1243,50 @@ static stbi__uint16* stbi__load_and_postprocess_16bit(stbi__context* s, int* x,
     return (stbi__uint16*)result;
 }
 
+// decodes like stbi__load_and_postprocess_8bit, but writes the rows straight into 'out'.
+// the 16->8 bit reduction and the vertical flip happen per row while copying, so neither
+// needs its own full-image buffer or pass.
+static int stbi__load_into(stbi__context* s, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* comp, int req_comp)
+{
+    stbi__result_info ri;
+    int row, channels, flip;
+    size_t i, row_len;
+    void* result = stbi__load_main(s, x, y, comp, req_comp, &ri, 8);
+
+    if (result == NULL)
+        return 0;
+
+    // it is the responsibility of the loaders to make sure we get either 8 or 16 bit.
+    STBI_ASSERT(ri.bits_per_channel == 8 || ri.bits_per_channel == 16);
+
+    channels = req_comp ? req_comp : *comp;
+    row_len = (size_t)*x * channels;
+    if (out_stride == 0)
+        out_stride = (int)row_len;
+
+    if (out == NULL || out_stride < 0 || (size_t)out_stride < row_len || (size_t)out_stride * (*y - 1) + row_len > out_size) {
+        STBI_FREE(result);
+        return stbi__err("buffer too small", "Output buffer too small for image");
+    }
+
+    flip = stbi__vertically_flip_on_load;
+    for (row = 0; row < *y; ++row) {
+        size_t src_row = (size_t)(flip ? *y - 1 - row : row);
+        stbi_uc* dest = out + (size_t)row * out_stride;
+        if (ri.bits_per_channel == 16) {
+            stbi__uint16* src = (stbi__uint16*)result + src_row * row_len;
+            for (i = 0; i < row_len; ++i)
+                dest[i] = (stbi_uc)((src[i] >> 8) & 0xFF); // same approximation as stbi__convert_16_to_8
+        }
+        else {
+            memcpy(dest, (stbi_uc*)result + src_row * row_len, row_len);
+        }
+    }
+
+    STBI_FREE(result);
+    return 1;
+}
+
 #if !defined(STBI_NO_HDR) && !defined(STBI_NO_LINEAR)
 static void stbi__float_postprocess(float* result, int* x, int* y, int* comp, int req_comp)
 {
@@ -1304,6 +1363,29 @@ STBIDEF stbi_uc* stbi_load_from_file(FILE* f, int* x, int* y, int* comp, int req
     return result;
 }
 
+STBIDEF int stbi_load_into(char const* filename, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* comp, int req_comp)
+{
+    FILE* f = stbi__fopen(filename, "rb");
+    int result;
+    if (!f) return stbi__err("can't fopen", "Unable to open file");
+    result = stbi_load_into_from_file(f, out, out_size, out_stride, x, y, comp, req_comp);
+    fclose(f);
+    return result;
+}
+
+STBIDEF int stbi_load_into_from_file(FILE* f, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* comp, int req_comp)
+{
+    int result;
+    stbi__context s;
+    stbi__start_file(&s, f);
+    result = stbi__load_into(&s, out, out_size, out_stride, x, y, comp, req_comp);
+    if (result) {
+        // need to 'unget' all the characters in the IO buffer
+        fseek(f, -(int)(s.img_buffer_end - s.img_buffer), SEEK_CUR);
+    }
+    return result;
+}
+
 STBIDEF stbi__uint16* stbi_load_from_file_16(FILE* f, int* x, int* y, int* comp, int req_comp)
 {
     stbi__uint16* result;
@@ -1358,6 +1440,20 @@ STBIDEF stbi_uc* stbi_load_from_callbacks(stbi_io_callbacks const* clbk, void* u
     return stbi__load_and_postprocess_8bit(&s, x, y, comp, req_comp);
 }
 
+STBIDEF int stbi_load_into_from_memory(stbi_uc const* buffer, int len, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* comp, int req_comp)
+{
+    stbi__context s;
+    stbi__start_mem(&s, buffer, len);
+    return stbi__load_into(&s, out, out_size, out_stride, x, y, comp, req_comp);
+}
+
+STBIDEF int stbi_load_into_from_callbacks(stbi_io_callbacks const* clbk, void* user, stbi_uc* out, size_t out_size, int out_stride, int* x, int* y, int* comp, int req_comp)
+{
+    stbi__context s;
+    stbi__start_callbacks(&s, (stbi_io_callbacks*)clbk, user);
+    return stbi__load_into(&s, out, out_size, out_stride, x, y, comp, req_comp);
+}
+
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc* stbi_load_gif_from_memory(stbi_uc const* buffer, int len, int** delays, int* x, int* y, int* z, int* comp, int req_comp)
 {